@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+/**
+ * Grappling leap math without any engine dependency, shared by the module and by the standalone
+ * benchmark in Tools/GrappleCoreBench. Functions working on locations are templated on the vector
+ * type: the module passes FVector, the benchmark FVec3. Anything with +, - and * by a float fits.
+ * Nothing here allocates, callers provide the output buffers.
+ */
+namespace GrappleCore
+{
+	/** Height the vertical curve value is scaled by */
+	constexpr float VerticalScale = 300.f;
+
+	/** Plain vector, for code built without the engine */
+	struct FVec3
+	{
+		float X = 0.f;
+		float Y = 0.f;
+		float Z = 0.f;
+
+		FVec3() = default;
+
+		FVec3(float InX, float InY, float InZ) : X(InX), Y(InY), Z(InZ) {}
+
+		FVec3 operator+(const FVec3& Other) const { return FVec3(X + Other.X, Y + Other.Y, Z + Other.Z); }
+
+		FVec3 operator-(const FVec3& Other) const { return FVec3(X - Other.X, Y - Other.Y, Z - Other.Z); }
+
+		FVec3 operator*(float Scale) const { return FVec3(X * Scale, Y * Scale, Z * Scale); }
+	};
+
+	template <typename T>
+	inline T Min(T A, T B) { return A < B ? A : B; }
+
+	template <typename T>
+	inline T Max(T A, T B) { return A < B ? B : A; }
+
+	template <typename T>
+	inline T Clamp(T Value, T Low, T High) { return Min(Max(Value, Low), High); }
+
+	template <typename T>
+	inline T Lerp(const T& A, const T& B, float Alpha) { return A + (B - A) * Alpha; }
+
+	/** Time a leap over Distance takes at Speed, 0 when the speed is not positive */
+	inline float LeapDuration(float Distance, float Speed)
+	{
+		return Speed > 0.f ? Distance / Speed : 0.f;
+	}
+
+	/**
+	 * Value at Alpha of a curve baked into a table over [0, 1], with linear interpolation.
+	 * Values holds Resolution + 2 entries, the last one a copy of the one before so that the
+	 * interpolation never reads past the end, even at Alpha = 1
+	 */
+	inline float EvaluateCurveTable(const float* Values, int32_t Resolution, float Alpha)
+	{
+		const float Position = Clamp(Alpha, 0.f, 1.f) * Resolution;
+		const int32_t Index = int32_t(Position);
+		return Lerp(Values[Index], Values[Index + 1], Position - Index);
+	}
+
+	/** EvaluateCurveTable for Count alphas */
+	inline void EvaluateCurveTableBatch(const float* Values, int32_t Resolution, const float* Alphas, float* OutValues, int32_t Count)
+	{
+		for(int32_t i = 0; i < Count; i++)
+		{
+			OutValues[i] = EvaluateCurveTable(Values, Resolution, Alphas[i]);
+		}
+	}
+
+	/** Location at fraction Alpha of a leap, CurveValue being the vertical curve at Alpha */
+	template <typename VectorType>
+	inline VectorType LeapLocation(const VectorType& Start, const VectorType& End, const VectorType& Up, float Alpha, float CurveValue)
+	{
+		return Lerp(Start, End, Alpha) + Up * (CurveValue * VerticalScale);
+	}
+
+	/** LeapLocation for Count fractions, with their curve values already evaluated */
+	template <typename VectorType>
+	inline void LeapLocations(const VectorType& Start, const VectorType& End, const VectorType& Up, const float* Alphas,
+	                          const float* CurveValues, VectorType* OutLocations, int32_t Count)
+	{
+		for(int32_t i = 0; i < Count; i++)
+		{
+			OutLocations[i] = LeapLocation(Start, End, Up, Alphas[i], CurveValues[i]);
+		}
+	}
+
+	/** Number of sub-steps a frame of DeltaTime is split into so that none is longer than MaxStepTime */
+	inline int32_t SubStepCount(float DeltaTime, float MaxStepTime, int32_t MaxSteps)
+	{
+		const float Steps = std::ceil(Min(DeltaTime / Max(MaxStepTime, 1e-8f), float(MaxSteps)));
+		return Clamp(int32_t(Steps), int32_t(1), MaxSteps);
+	}
+
+	/** Leap fractions reached at the end of each of StepCount even sub-steps from PreviousAlpha to Alpha */
+	inline void SubStepAlphas(float PreviousAlpha, float Alpha, int32_t StepCount, float* OutAlphas)
+	{
+		for(int32_t Step = 0; Step < StepCount; Step++)
+		{
+			OutAlphas[Step] = Lerp(PreviousAlpha, Alpha, float(Step + 1) / StepCount);
+		}
+	}
+
+	/** SampleCount + 1 evenly spaced fractions from 0 to 1 */
+	inline void UniformAlphas(int32_t SampleCount, float* OutAlphas)
+	{
+		for(int32_t i = 0; i <= SampleCount; i++)
+		{
+			OutAlphas[i] = float(i) / SampleCount;
+		}
+	}
+
+	/**
+	 * Largest distance between a leap and the straight segment joining two of its fractions.
+	 * The horizontal motion is linear in the leap fraction, so the chord only strays from the
+	 * leap vertically, by how much the curve bends between the two fractions. Probing the
+	 * quarters as well as the middle catches S-shaped spans whose middle lies on the chord.
+	 * Curve is called with a fraction and returns the vertical curve value there
+	 */
+	template <typename CurveType>
+	inline float ChordDeviation(const CurveType& Curve, float StartAlpha, float EndAlpha)
+	{
+		const float StartValue = Curve(StartAlpha);
+		const float EndValue = Curve(EndAlpha);
+
+		float Deviation = 0.f;
+		for(const float T : {0.25f, 0.5f, 0.75f})
+		{
+			const float CurveValue = Curve(Lerp(StartAlpha, EndAlpha, T));
+			const float ChordValue = Lerp(StartValue, EndValue, T);
+			Deviation = Max(Deviation, std::fabs(CurveValue - ChordValue));
+		}
+		return Deviation * VerticalScale;
+	}
+
+	/**
+	 * Splits a leap into segments that stray from it by less than Tolerance, splitting the worst
+	 * segment in two until they all do or MaxSegments is reached. Only the curve bends the leap, so
+	 * the count depends on its shape, not on the leap length.
+	 * OutAlphas receives the segment bounds in increasing order and needs room for MaxSegments + 1
+	 * fractions, Deviations is scratch space for MaxSegments floats. Returns the number of bounds
+	 */
+	template <typename CurveType>
+	inline int32_t SubdivideLeap(const CurveType& Curve, float Tolerance, int32_t MaxSegments, float* OutAlphas, float* Deviations)
+	{
+		MaxSegments = Max(MaxSegments, int32_t(1));
+		OutAlphas[0] = 0.f;
+		OutAlphas[1] = 1.f;
+		Deviations[0] = ChordDeviation(Curve, 0.f, 1.f);
+
+		int32_t SegmentCount = 1;
+		while(SegmentCount < MaxSegments)
+		{
+			int32_t Worst = 0;
+			for(int32_t i = 1; i < SegmentCount; i++)
+			{
+				if(Deviations[i] > Deviations[Worst]) Worst = i;
+			}
+			if(Deviations[Worst] <= Tolerance) break;
+
+			// Open a slot after the worst segment, in both arrays
+			const float Middle = (OutAlphas[Worst] + OutAlphas[Worst + 1]) * 0.5f;
+			std::memmove(OutAlphas + Worst + 2, OutAlphas + Worst + 1, (SegmentCount - Worst) * sizeof(float));
+			std::memmove(Deviations + Worst + 2, Deviations + Worst + 1, (SegmentCount - Worst - 1) * sizeof(float));
+			OutAlphas[Worst + 1] = Middle;
+			SegmentCount++;
+
+			Deviations[Worst] = ChordDeviation(Curve, OutAlphas[Worst], Middle);
+			Deviations[Worst + 1] = ChordDeviation(Curve, Middle, OutAlphas[Worst + 2]);
+		}
+		return SegmentCount + 1;
+	}
+}
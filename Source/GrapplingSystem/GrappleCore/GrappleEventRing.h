@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace GrappleCore
+{
+	/**
+	 * Fixed size, lock-free ring of events between one producer thread and one consumer thread.
+	 * Push never blocks nor allocates: when the ring is full the event is dropped and Push returns
+	 * false. Each side only writes its own index, and keeps a copy of the other one so that it only
+	 * reads the shared cache line when its copy says the ring is full, or empty.
+	 * Capacity must be a power of two. The elements live inside the ring, allocate large rings on the heap
+	 */
+	template <typename ElementType, uint32_t Capacity>
+	class TEventRing
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "TEventRing capacity must be a power of two");
+
+	public:
+
+		/** Adds an event. Producer thread only. Returns false, dropping the event, if the ring is full */
+		bool Push(const ElementType& Element)
+		{
+			const uint32_t Head = ProducerHead.load(std::memory_order_relaxed);
+			if(Head - CachedTail == Capacity)
+			{
+				CachedTail = ConsumerTail.load(std::memory_order_acquire);
+				if(Head - CachedTail == Capacity) return false;
+			}
+			Elements[Head & (Capacity - 1)] = Element;
+			ProducerHead.store(Head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Moves up to MaxCount events, oldest first, to OutElements. Consumer thread only. Returns the number moved */
+		uint32_t Pop(ElementType* OutElements, uint32_t MaxCount)
+		{
+			const uint32_t Tail = ConsumerTail.load(std::memory_order_relaxed);
+			if(CachedHead - Tail < MaxCount)
+			{
+				CachedHead = ProducerHead.load(std::memory_order_acquire);
+			}
+
+			const uint32_t Count = CachedHead - Tail < MaxCount ? CachedHead - Tail : MaxCount;
+			for(uint32_t i = 0; i < Count; i++)
+			{
+				OutElements[i] = Elements[(Tail + i) & (Capacity - 1)];
+			}
+			ConsumerTail.store(Tail + Count, std::memory_order_release);
+			return Count;
+		}
+
+		/** Events waiting, as seen from the calling thread */
+		uint32_t Num() const
+		{
+			return ProducerHead.load(std::memory_order_acquire) - ConsumerTail.load(std::memory_order_acquire);
+		}
+
+		static constexpr uint32_t GetCapacity() { return Capacity; }
+
+	private:
+
+		/** Keeps the indices written by each side on cache lines of their own */
+		static constexpr uint32_t CacheLineSize = 64;
+
+		/** Written by the producer. Indices grow forever and wrap around with the 32 bits */
+		std::atomic<uint32_t> ProducerHead{0};
+
+		/** Last consumer index the producer saw */
+		uint32_t CachedTail = 0;
+
+		uint8_t ProducerPadding[CacheLineSize - sizeof(std::atomic<uint32_t>) - sizeof(uint32_t)];
+
+		/** Written by the consumer */
+		std::atomic<uint32_t> ConsumerTail{0};
+
+		/** Last producer index the consumer saw */
+		uint32_t CachedHead = 0;
+
+		uint8_t ConsumerPadding[CacheLineSize - sizeof(std::atomic<uint32_t>) - sizeof(uint32_t)];
+
+		ElementType Elements[Capacity];
+	};
+}
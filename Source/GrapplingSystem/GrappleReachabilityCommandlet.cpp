@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleReachabilityCommandlet.h"
+
+#include "EngineUtils.h"
+#include "GrappleReachabilityGraph.h"
+#include "GrappleReachabilityGraphActor.h"
+#include "GrapplingSystem.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+UGrappleReachabilityCommandlet::UGrappleReachabilityCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UGrappleReachabilityCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString Maps;
+	if(!FParse::Value(*Params, TEXT("Maps="), Maps))
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Usage: -run=GrappleReachability -Maps=/Game/Maps/MapA,/Game/Maps/MapB [-OnlyChanged]"));
+		return 1;
+	}
+	const bool bOnlyChanged = FParse::Param(*Params, TEXT("OnlyChanged"));
+
+	TArray<FString> MapNames;
+	Maps.ParseIntoArray(MapNames, TEXT(","));
+
+	int32 Errors = 0;
+	for(const FString& MapName : MapNames)
+	{
+		UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+		UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+		if(!World)
+		{
+			UE_LOG(LogGrappling, Error, TEXT("Could not load map %s"), *MapName);
+			Errors++;
+			continue;
+		}
+
+		// The sweeps need the collision of the level registered in a physics scene
+		World->AddToRoot();
+		World->WorldType = EWorldType::Editor;
+		if(!World->bIsWorldInitialized)
+		{
+			World->InitWorld(UWorld::InitializationValues()
+				.AllowAudioPlayback(false)
+				.RequiresHitProxies(false)
+				.CreateNavigation(false)
+				.CreateAISystem(false)
+				.ShouldSimulatePhysics(false)
+				.CreatePhysicsScene(true)
+				.EnableTraceCollision(true));
+		}
+		World->UpdateWorldComponents(true, false);
+
+		bool bMapChanged = false;
+		for(TActorIterator<AGrappleReachabilityGraphActor> It(World); It; ++It)
+		{
+			AGrappleReachabilityGraphActor* GraphActor = *It;
+			if(!GraphActor->Graph)
+			{
+				if(!GraphActor->CreateGraphAsset())
+				{
+					Errors++;
+					continue;
+				}
+				bMapChanged = true;
+			}
+
+			GraphActor->BuildGraph(bOnlyChanged);
+
+			UPackage* GraphPackage = GraphActor->Graph->GetOutermost();
+			const FString Filename = FPackageName::LongPackageNameToFilename(GraphPackage->GetName(), FPackageName::GetAssetPackageExtension());
+			if(!UPackage::SavePackage(GraphPackage, GraphActor->Graph, RF_Public | RF_Standalone, *Filename))
+			{
+				UE_LOG(LogGrappling, Error, TEXT("Could not save %s"), *Filename);
+				Errors++;
+			}
+		}
+
+		// A new graph asset is referenced by the level, which has to be saved with it
+		if(bMapChanged)
+		{
+			const FString Filename = FPackageName::LongPackageNameToFilename(MapPackage->GetName(), FPackageName::GetMapPackageExtension());
+			if(!UPackage::SavePackage(MapPackage, World, RF_NoFlags, *Filename))
+			{
+				UE_LOG(LogGrappling, Error, TEXT("Could not save %s"), *Filename);
+				Errors++;
+			}
+		}
+
+		World->CleanupWorld();
+		World->RemoveFromRoot();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	return Errors > 0 ? 1 : 0;
+#else
+	UE_LOG(LogGrappling, Error, TEXT("Grapple reachability graphs can only be built in the editor"));
+	return 1;
+#endif
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GrappleReachabilityCommandlet.generated.h"
+
+/**
+ * Bakes the grapple reachability graphs of the given levels and saves them.
+ *
+ * Usage: UE4Editor-Cmd GrapplingSystem -run=GrappleReachability -Maps=/Game/Maps/MapA,/Game/Maps/MapB [-OnlyChanged]
+ *
+ * With -OnlyChanged, only the leaps around the geometry changed in the editor since the last build,
+ * as saved with each graph, are swept again.
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API UGrappleReachabilityCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrappleReachabilityCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
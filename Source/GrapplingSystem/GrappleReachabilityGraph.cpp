@@ -0,0 +1,277 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleReachabilityGraph.h"
+
+#include "GrapplingPoint.h"
+#include "Algo/Reverse.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+
+void UGrappleReachabilityGraph::PostLoad()
+{
+	Super::PostLoad();
+
+	BuildLookups();
+}
+
+int32 UGrappleReachabilityGraph::Build(UWorld* World, const TArray<AGrapplingPoint*>& Points, const FGrappleReachabilitySettings& Settings)
+{
+#if WITH_EDITORONLY_DATA
+	BlockerBounds.Reset();
+#endif
+	return BuildInternal(World, Points, Settings, nullptr);
+}
+
+int32 UGrappleReachabilityGraph::Rebuild(UWorld* World, const TArray<AGrapplingPoint*>& Points, const FGrappleReachabilitySettings& Settings)
+{
+#if WITH_EDITORONLY_DATA
+	return BuildInternal(World, Points, Settings, &DirtyBounds);
+#else
+	return BuildInternal(World, Points, Settings, nullptr);
+#endif
+}
+
+int32 UGrappleReachabilityGraph::FindPoint(const FGuid& PointId) const
+{
+	const int32* Index = PointIndices.Find(PointId);
+	return Index ? *Index : INDEX_NONE;
+}
+
+EGrappleReachability UGrappleReachabilityGraph::GetReachability(int32 From, int32 To) const
+{
+	if(From == INDEX_NONE || To == INDEX_NONE || From == To) return EGrappleReachability::Unknown;
+	if(Edges.Contains(MakeEdgeKey(From, To))) return EGrappleReachability::Reachable;
+
+	// Pairs out of range were never swept, the graph knows nothing about them
+	if(FVector::DistSquared(PointLocations[From], PointLocations[To]) > FMath::Square(BuildSettings.MaxRange))
+	{
+		return EGrappleReachability::Unknown;
+	}
+	return EGrappleReachability::Blocked;
+}
+
+EGrappleReachability UGrappleReachabilityGraph::GetReachability(const FGuid& From, const FGuid& To) const
+{
+	return GetReachability(FindPoint(From), FindPoint(To));
+}
+
+TArrayView<const int32> UGrappleReachabilityGraph::GetNeighbors(int32 Point) const
+{
+	if(!PointIds.IsValidIndex(Point)) return TArrayView<const int32>();
+	return TArrayView<const int32>(EdgeTargets.GetData() + EdgeOffsets[Point], EdgeOffsets[Point + 1] - EdgeOffsets[Point]);
+}
+
+TArrayView<const float> UGrappleReachabilityGraph::GetNeighborCosts(int32 Point) const
+{
+	if(!PointIds.IsValidIndex(Point)) return TArrayView<const float>();
+	return TArrayView<const float>(EdgeCosts.GetData() + EdgeOffsets[Point], EdgeOffsets[Point + 1] - EdgeOffsets[Point]);
+}
+
+bool UGrappleReachabilityGraph::FindPath(int32 From, int32 To, TArray<int32>& OutPath) const
+{
+	OutPath.Reset();
+	if(!PointIds.IsValidIndex(From) || !PointIds.IsValidIndex(To)) return false;
+
+	// Costs are leap durations, distance over speed, so the straight line duration never overestimates
+	const float InverseSpeed = BuildSettings.GrapplingSpeed > 0.f ? 1.f / BuildSettings.GrapplingSpeed : 0.f;
+	auto Heuristic = [this, To, InverseSpeed](int32 Point)
+	{
+		return FVector::Dist(PointLocations[Point], PointLocations[To]) * InverseSpeed;
+	};
+
+	struct FOpenNode
+	{
+		float EstimatedCost;
+		int32 Point;
+	};
+	auto ByEstimatedCost = [](const FOpenNode& A, const FOpenNode& B) { return A.EstimatedCost < B.EstimatedCost; };
+
+	TArray<float> Costs;
+	TArray<int32> Parents;
+	Costs.Init(BIG_NUMBER, PointIds.Num());
+	Parents.Init(INDEX_NONE, PointIds.Num());
+
+	TArray<FOpenNode> Open;
+	Costs[From] = 0.f;
+	Open.HeapPush({Heuristic(From), From}, ByEstimatedCost);
+	while(Open.Num() > 0)
+	{
+		FOpenNode Node;
+		Open.HeapPop(Node, ByEstimatedCost, false);
+		if(Node.Point == To) break;
+
+		// Stale entry of a point reached again through a cheaper path
+		if(Node.EstimatedCost > Costs[Node.Point] + Heuristic(Node.Point) + KINDA_SMALL_NUMBER) continue;
+
+		const TArrayView<const int32> Neighbors = GetNeighbors(Node.Point);
+		const TArrayView<const float> NeighborCosts = GetNeighborCosts(Node.Point);
+		for(int32 i = 0; i < Neighbors.Num(); i++)
+		{
+			const int32 Neighbor = Neighbors[i];
+			const float Cost = Costs[Node.Point] + NeighborCosts[i];
+			if(Cost < Costs[Neighbor])
+			{
+				Costs[Neighbor] = Cost;
+				Parents[Neighbor] = Node.Point;
+				Open.HeapPush({Cost + Heuristic(Neighbor), Neighbor}, ByEstimatedCost);
+			}
+		}
+	}
+
+	if(From != To && Parents[To] == INDEX_NONE) return false;
+
+	for(int32 Point = To; Point != INDEX_NONE; Point = Parents[Point])
+	{
+		OutPath.Add(Point);
+	}
+	Algo::Reverse(OutPath);
+	return true;
+}
+
+int32 UGrappleReachabilityGraph::BuildInternal(UWorld* World, const TArray<AGrapplingPoint*>& Points,
+                                               const FGrappleReachabilitySettings& Settings, const FBox* ChangedBounds)
+{
+	// Results of the previous build, reused for the leaps that cannot have changed
+	const TMap<FGuid, int32> PreviousIndices = MoveTemp(PointIndices);
+	const TSet<uint64> PreviousEdges = MoveTemp(Edges);
+	const TArray<FVector> PreviousLocations = MoveTemp(PointLocations);
+	// An empty box says nothing about what changed, and other settings change every leap
+	const bool bCanReuse = ChangedBounds && ChangedBounds->IsValid && BuildSettings == Settings;
+
+	PointIds.Reset();
+	PointLocations.Reset();
+	for(const AGrapplingPoint* Point : Points)
+	{
+		if(IsValid(Point) && Point->GetPointId().IsValid())
+		{
+			PointIds.Add(Point->GetPointId());
+			PointLocations.Add(Point->GetActorLocation());
+		}
+	}
+	BuildSettings = Settings;
+
+	// Sorting along X lets the pair loop stop as soon as points are out of range on that axis
+	const int32 PointCount = PointIds.Num();
+	TArray<int32> Order;
+	Order.Reserve(PointCount);
+	for(int32 i = 0; i < PointCount; i++)
+	{
+		Order.Add(i);
+	}
+	Order.Sort([this](int32 A, int32 B) { return PointLocations[A].X < PointLocations[B].X; });
+
+	// How far a leap path may stray from the line between its ends
+	float CurveMin = 0.f, CurveMax = 0.f;
+	if(Settings.VerticalCurve)
+	{
+		Settings.VerticalCurve->GetValueRange(CurveMin, CurveMax);
+	}
+	const float PathMargin = FMath::Max(FMath::Abs(CurveMin), FMath::Abs(CurveMax)) * FGrapplingTrajectory::VerticalScale
+		+ Settings.CapsuleRadius + Settings.CapsuleHalfHeight;
+
+	const FCollisionShape Capsule = FCollisionShape::MakeCapsule(Settings.CapsuleRadius, Settings.CapsuleHalfHeight);
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(GrappleReachability), false);
+	const FVector Up = FVector::UpVector * Settings.VerticalOffset;
+
+	int32 SweptLeaps = 0;
+	TArray<TArray<TPair<int32, float>>> Adjacency;
+	Adjacency.SetNum(PointCount);
+	TArray<FGrappleTrajectorySweep> Sweeps;
+
+	auto TestLeap = [&](int32 From, int32 To)
+	{
+		const FVector Start = PointLocations[From] + Up;
+		const FVector End = PointLocations[To] + Up;
+
+		bool bClear;
+		const int32* PreviousFrom = bCanReuse ? PreviousIndices.Find(PointIds[From]) : nullptr;
+		const int32* PreviousTo = bCanReuse ? PreviousIndices.Find(PointIds[To]) : nullptr;
+		const bool bUnchanged = PreviousFrom && PreviousTo
+			&& PreviousLocations[*PreviousFrom].Equals(PointLocations[From])
+			&& PreviousLocations[*PreviousTo].Equals(PointLocations[To])
+			&& !FBox(Start, End).ExpandBy(PathMargin).Intersect(*ChangedBounds);
+		if(bUnchanged)
+		{
+			bClear = PreviousEdges.Contains(MakeEdgeKey(*PreviousFrom, *PreviousTo));
+		}
+		else
+		{
+			const FGrapplingTrajectory Trajectory(Start, End, FVector::UpVector, Settings.VerticalCurve);
+			Trajectory.BuildValidationSweeps(Settings.ValidationMode, Settings.ValidationSampleCount, Settings.ValidationTolerance,
+			                                 Settings.MaxValidationSegments, Sweeps);
+
+			FGrappleTrajectoryHit Hit;
+			bClear = !FGrapplingTrajectory::SweepForObstacle(World, Sweeps, Capsule, Params, Hit);
+			SweptLeaps++;
+
+#if WITH_EDITORONLY_DATA
+			if(!bClear && Hit.Hit.GetActor())
+			{
+				BlockerBounds.Add(FSoftObjectPath(Hit.Hit.GetActor()), Hit.Hit.GetActor()->GetComponentsBoundingBox(true));
+			}
+#endif
+		}
+
+		if(bClear)
+		{
+			Adjacency[From].Add(TPair<int32, float>(To, FVector::Dist(Start, End) / Settings.GrapplingSpeed));
+		}
+	};
+
+	for(int32 a = 0; a < PointCount; a++)
+	{
+		const int32 i = Order[a];
+		for(int32 b = a + 1; b < PointCount; b++)
+		{
+			const int32 j = Order[b];
+			if(PointLocations[j].X - PointLocations[i].X > Settings.MaxRange) break;
+			if(FVector::DistSquared(PointLocations[i], PointLocations[j]) > FMath::Square(Settings.MaxRange)) continue;
+
+			// The curve lifts the path along the leap, so both directions are tested
+			TestLeap(i, j);
+			TestLeap(j, i);
+		}
+	}
+
+	EdgeOffsets.Reset(PointCount + 1);
+	EdgeTargets.Reset();
+	EdgeCosts.Reset();
+	for(int32 i = 0; i < PointCount; i++)
+	{
+		Adjacency[i].Sort([](const TPair<int32, float>& A, const TPair<int32, float>& B) { return A.Key < B.Key; });
+		EdgeOffsets.Add(EdgeTargets.Num());
+		for(const TPair<int32, float>& Edge : Adjacency[i])
+		{
+			EdgeTargets.Add(Edge.Key);
+			EdgeCosts.Add(Edge.Value);
+		}
+	}
+	EdgeOffsets.Add(EdgeTargets.Num());
+
+#if WITH_EDITORONLY_DATA
+	DirtyBounds = FBox(ForceInit);
+#endif
+
+	BuildLookups();
+	MarkPackageDirty();
+	return SweptLeaps;
+}
+
+void UGrappleReachabilityGraph::BuildLookups()
+{
+	PointIndices.Reset();
+	for(int32 i = 0; i < PointIds.Num(); i++)
+	{
+		PointIndices.Add(PointIds[i], i);
+	}
+
+	Edges.Reset();
+	for(int32 i = 0; i + 1 < EdgeOffsets.Num(); i++)
+	{
+		for(int32 Edge = EdgeOffsets[i]; Edge < EdgeOffsets[i + 1]; Edge++)
+		{
+			Edges.Add(MakeEdgeKey(i, EdgeTargets[Edge]));
+		}
+	}
+}
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingTrajectory.h"
+#include "Engine/DataAsset.h"
+#include "GrappleReachabilityGraph.generated.h"
+
+class AGrapplingPoint;
+class UCurveFloat;
+
+/** What the baked data knows about a leap between two points */
+UENUM(BlueprintType)
+enum class EGrappleReachability : uint8
+{
+	/** The pair was not baked, out of range or not in the same graph */
+	Unknown,
+
+	/** The leap path was clear when baked */
+	Reachable,
+
+	/** The leap path was blocked when baked */
+	Blocked
+};
+
+/** Leap parameters the reachability is baked with, taken from the character class */
+USTRUCT(BlueprintType)
+struct GRAPPLINGSYSTEM_API FGrappleReachabilitySettings
+{
+	GENERATED_BODY()
+
+	/** Longest leap tested */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	float MaxRange = 5000.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	float GrapplingSpeed = 1500.f;
+
+	/** Height above a point the character leaps from and lands at */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	float VerticalOffset = 100.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	float CapsuleRadius = 42.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	float CapsuleHalfHeight = 96.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	UCurveFloat* VerticalCurve = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	EGrappleValidationMode ValidationMode = EGrappleValidationMode::SweptSegments;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	int32 ValidationSampleCount = 10;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	float ValidationTolerance = 10.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	int32 MaxValidationSegments = 16;
+
+	bool operator==(const FGrappleReachabilitySettings& Other) const
+	{
+		return MaxRange == Other.MaxRange && GrapplingSpeed == Other.GrapplingSpeed && VerticalOffset == Other.VerticalOffset
+			&& CapsuleRadius == Other.CapsuleRadius && CapsuleHalfHeight == Other.CapsuleHalfHeight && VerticalCurve == Other.VerticalCurve
+			&& ValidationMode == Other.ValidationMode && ValidationSampleCount == Other.ValidationSampleCount
+			&& ValidationTolerance == Other.ValidationTolerance && MaxValidationSegments == Other.MaxValidationSegments;
+	}
+
+	bool operator!=(const FGrappleReachabilitySettings& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Which grappling points of a level can be leapt between, baked offline by sweeping every leap
+ * within range. Edges are stored in compressed rows with their leap duration as cost, plus a
+ * hashed pair set so runtime code can tell in constant time whether a leap is clear, and AI can
+ * plan routes with A*.
+ */
+UCLASS(BlueprintType)
+class GRAPPLINGSYSTEM_API UGrappleReachabilityGraph : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void PostLoad() override;
+
+	/** Sweeps every leap between the points and replaces the graph. Returns the number of leaps swept */
+	int32 Build(UWorld* World, const TArray<AGrapplingPoint*>& Points, const FGrappleReachabilitySettings& Settings);
+
+	/**
+	 * Updates the graph for a new set of points, only sweeping the leaps that pass through
+	 * DirtyBounds or involve points added or moved since the last build. Everything is swept again
+	 * when DirtyBounds is empty, as nothing tells whether it was tracked, or when the settings changed.
+	 * Returns the number of leaps swept
+	 */
+	int32 Rebuild(UWorld* World, const TArray<AGrapplingPoint*>& Points, const FGrappleReachabilitySettings& Settings);
+
+	/** Index of a point in the graph, INDEX_NONE if it is not in it */
+	int32 FindPoint(const FGuid& PointId) const;
+
+	/** Baked result of a leap between two points of the graph */
+	EGrappleReachability GetReachability(int32 From, int32 To) const;
+
+	/** Baked result of a leap between two points, by id */
+	EGrappleReachability GetReachability(const FGuid& From, const FGuid& To) const;
+
+	/** Points reachable from a point in a single leap */
+	TArrayView<const int32> GetNeighbors(int32 Point) const;
+
+	/** Leap durations to the points returned by GetNeighbors */
+	TArrayView<const float> GetNeighborCosts(int32 Point) const;
+
+	/** Shortest chain of leaps from a point to another, both included. Returns false if there is none */
+	bool FindPath(int32 From, int32 To, TArray<int32>& OutPath) const;
+
+	int32 NumPoints() const { return PointIds.Num(); }
+
+	int32 NumEdges() const { return EdgeTargets.Num(); }
+
+	const FGuid& GetPointId(int32 Point) const { return PointIds[Point]; }
+
+	const FVector& GetPointLocation(int32 Point) const { return PointLocations[Point]; }
+
+#if WITH_EDITORONLY_DATA
+	/** Bounds of the actors that blocked a leap in the last build. Moving one of them may clear those leaps */
+	UPROPERTY()
+	TMap<FSoftObjectPath, FBox> BlockerBounds;
+
+	/** Bounds of the geometry changed since the last build, saved with the graph so later sessions can rebuild around it */
+	UPROPERTY()
+	FBox DirtyBounds = FBox(ForceInit);
+#endif
+
+protected:
+
+	/** Settings of the last build */
+	UPROPERTY(VisibleAnywhere, Category = "Grappling")
+	FGrappleReachabilitySettings BuildSettings;
+
+	UPROPERTY()
+	TArray<FGuid> PointIds;
+
+	/** Point locations at build time, used to spot moved points and as the A* heuristic */
+	UPROPERTY()
+	TArray<FVector> PointLocations;
+
+	/** Edges leaving point i are EdgeTargets[EdgeOffsets[i]] to EdgeTargets[EdgeOffsets[i + 1] - 1] */
+	UPROPERTY()
+	TArray<int32> EdgeOffsets;
+
+	UPROPERTY()
+	TArray<int32> EdgeTargets;
+
+	/** Leap duration of every edge */
+	UPROPERTY()
+	TArray<float> EdgeCosts;
+
+	/** Graph index of every point, by id */
+	TMap<FGuid, int32> PointIndices;
+
+	/** Every edge, as From << 32 | To */
+	TSet<uint64> Edges;
+
+	/** Builds the graph, reusing the previous results for leaps that do not need sweeping when ChangedBounds is set */
+	int32 BuildInternal(UWorld* World, const TArray<AGrapplingPoint*>& Points, const FGrappleReachabilitySettings& Settings, const FBox* ChangedBounds);
+
+	/** Rebuilds the lookup tables from the serialized graph */
+	void BuildLookups();
+
+	static uint64 MakeEdgeKey(int32 From, int32 To) { return uint64(uint32(From)) << 32 | uint32(To); }
+};
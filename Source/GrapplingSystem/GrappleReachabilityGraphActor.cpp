@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleReachabilityGraphActor.h"
+
+#include "EngineUtils.h"
+#include "GrappleReachabilityGraph.h"
+#include "GrapplingPoint.h"
+#include "GrapplingPointSubsystem.h"
+#include "GrapplingSystem.h"
+#include "GrapplingSystemCharacter.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#if WITH_EDITOR
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#endif
+
+AGrappleReachabilityGraphActor::AGrappleReachabilityGraphActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	Graph = nullptr;
+	CharacterClass = AGrapplingSystemCharacter::StaticClass();
+	MaxRange = 5000.f;
+}
+
+int32 AGrappleReachabilityGraphActor::BuildGraph(bool bOnlyChanged)
+{
+	if(!Graph || !CharacterClass) return 0;
+
+	const FGrappleReachabilitySettings Settings = CharacterClass->GetDefaultObject<AGrapplingSystemCharacter>()->MakeReachabilitySettings(MaxRange);
+	TArray<AGrapplingPoint*> Points;
+	GatherPoints(Points);
+
+	const int32 SweptLeaps = bOnlyChanged ? Graph->Rebuild(GetWorld(), Points, Settings) : Graph->Build(GetWorld(), Points, Settings);
+
+	UE_LOG(LogGrappling, Display, TEXT("%s: %d points, %d leaps, %d swept"), *GetPathName(), Graph->NumPoints(), Graph->NumEdges(), SweptLeaps);
+	return SweptLeaps;
+}
+
+#if WITH_EDITOR
+void AGrappleReachabilityGraphActor::BuildAllLeaps()
+{
+	if(Graph || CreateGraphAsset())
+	{
+		BuildGraph(false);
+	}
+}
+
+void AGrappleReachabilityGraphActor::BuildChangedLeaps()
+{
+	if(Graph || CreateGraphAsset())
+	{
+		BuildGraph(true);
+	}
+}
+
+bool AGrappleReachabilityGraphActor::CreateGraphAsset()
+{
+	const FString LevelPackageName = GetOutermost()->GetName();
+	if(!FPackageName::IsValidLongPackageName(LevelPackageName) || LevelPackageName.StartsWith(TEXT("/Temp/")))
+	{
+		UE_LOG(LogGrappling, Warning, TEXT("Save the level before building its grapple reachability graph"));
+		return false;
+	}
+
+	const FString PackageName = LevelPackageName + TEXT("_GrappleReachability");
+	UPackage* Package = CreatePackage(*PackageName);
+	Graph = NewObject<UGrappleReachabilityGraph>(Package, *FPackageName::GetShortName(PackageName), RF_Public | RF_Standalone | RF_Transactional);
+	FAssetRegistryModule::AssetCreated(Graph);
+	Package->MarkPackageDirty();
+	MarkPackageDirty();
+	return true;
+}
+
+void AGrappleReachabilityGraphActor::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	// Only the level being edited needs to track changes
+	const UWorld* World = GetWorld();
+	if(GEngine && World && World->WorldType == EWorldType::Editor && !ActorMovedHandle.IsValid())
+	{
+		ActorMovedHandle = GEngine->OnActorMoved().AddUObject(this, &AGrappleReachabilityGraphActor::OnLevelActorChanged);
+		ActorAddedHandle = GEngine->OnLevelActorAdded().AddUObject(this, &AGrappleReachabilityGraphActor::OnLevelActorChanged);
+		ActorDeletedHandle = GEngine->OnLevelActorDeleted().AddUObject(this, &AGrappleReachabilityGraphActor::OnLevelActorChanged);
+	}
+}
+
+void AGrappleReachabilityGraphActor::PostUnregisterAllComponents()
+{
+	if(GEngine && ActorMovedHandle.IsValid())
+	{
+		GEngine->OnActorMoved().Remove(ActorMovedHandle);
+		GEngine->OnLevelActorAdded().Remove(ActorAddedHandle);
+		GEngine->OnLevelActorDeleted().Remove(ActorDeletedHandle);
+		ActorMovedHandle.Reset();
+		ActorAddedHandle.Reset();
+		ActorDeletedHandle.Reset();
+	}
+
+	Super::PostUnregisterAllComponents();
+}
+
+void AGrappleReachabilityGraphActor::OnLevelActorChanged(AActor* Actor)
+{
+	// Points are compared with the graph when building, only the geometry around them matters here
+	if(!Actor || Actor == this || Actor->GetWorld() != GetWorld() || Actor->IsA<AGrapplingPoint>()) return;
+
+	// Without a graph the next build sweeps everything anyway
+	if(!Graph) return;
+
+	FBox ChangedBounds(ForceInit);
+	if(Actor->GetActorEnableCollision())
+	{
+		ChangedBounds += Actor->GetComponentsBoundingBox(true);
+	}
+
+	// Where the actor was, it may have been blocking leaps that are now clear
+	if(const FBox* PreviousBounds = Graph->BlockerBounds.Find(FSoftObjectPath(Actor)))
+	{
+		ChangedBounds += *PreviousBounds;
+	}
+
+	if(ChangedBounds.IsValid)
+	{
+		// Saved with the graph, so a later session or the commandlet still knows what to sweep again
+		Graph->Modify();
+		Graph->DirtyBounds += ChangedBounds;
+	}
+}
+#endif
+
+void AGrappleReachabilityGraphActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if(UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		Registry->AddReachabilityGraph(Graph);
+	}
+}
+
+void AGrappleReachabilityGraphActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		Registry->RemoveReachabilityGraph(Graph);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGrappleReachabilityGraphActor::GatherPoints(TArray<AGrapplingPoint*>& OutPoints) const
+{
+	for(TActorIterator<AGrapplingPoint> It(GetWorld()); It; ++It)
+	{
+		if(It->GetLevel() == GetLevel())
+		{
+			OutPoints.Add(*It);
+		}
+	}
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GrappleReachabilityGraphActor.generated.h"
+
+class AGrapplingPoint;
+class AGrapplingSystemCharacter;
+class UGrappleReachabilityGraph;
+
+/**
+ * Bakes the reachability graph of the grappling points of its level, and makes it available
+ * to the grappling point registry at runtime. Place one per level.
+ * In the editor it records on the graph the geometry moved since the last build, so only the
+ * leaps around it are swept again, in this session or a later one.
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API AGrappleReachabilityGraphActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AGrappleReachabilityGraphActor();
+
+	/** Baked graph of the level */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grappling")
+	UGrappleReachabilityGraph* Graph;
+
+	/** Character the leaps are baked for */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grappling")
+	TSubclassOf<AGrapplingSystemCharacter> CharacterClass;
+
+	/** Longest leap baked */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grappling")
+	float MaxRange;
+
+	/** Sweeps every leap of the level. Returns the number of leaps swept */
+	int32 BuildGraph(bool bOnlyChanged);
+
+#if WITH_EDITOR
+	/** Sweeps every leap of the level */
+	UFUNCTION(CallInEditor, Category = "Grappling")
+	void BuildAllLeaps();
+
+	/** Sweeps the leaps near the geometry and points changed since the last build */
+	UFUNCTION(CallInEditor, Category = "Grappling")
+	void BuildChangedLeaps();
+
+	/** Creates the graph asset next to the level if there is none. Returns false if it could not */
+	bool CreateGraphAsset();
+
+	virtual void PostRegisterAllComponents() override;
+
+	virtual void PostUnregisterAllComponents() override;
+#endif
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Grappling points of the level of this actor */
+	void GatherPoints(TArray<AGrapplingPoint*>& OutPoints) const;
+
+#if WITH_EDITORONLY_DATA
+	FDelegateHandle ActorMovedHandle;
+
+	FDelegateHandle ActorAddedHandle;
+
+	FDelegateHandle ActorDeletedHandle;
+#endif
+
+#if WITH_EDITOR
+	/** Adds the old and new bounds of a changed actor to the dirty bounds of the graph */
+	void OnLevelActorChanged(AActor* Actor);
+#endif
+};
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingBenchmarkBotController.h"
+
+#include "GrapplingPointSetComponent.h"
+#include "GrapplingPointSubsystem.h"
+#include "GrapplingSystemCharacter.h"
+
+AGrapplingBenchmarkBotController::AGrapplingBenchmarkBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	GrappleRange = 3000.f;
+	CandidateCount = 8;
+	RetryDelay = 0.25f;
+	RetryCooldown = 0.f;
+	GrappleCount = 0;
+}
+
+void AGrapplingBenchmarkBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	AGrapplingSystemCharacter* Character = Cast<AGrapplingSystemCharacter>(GetPawn());
+	if(!Character || Character->IsGrappleInProgress()) return;
+
+	RetryCooldown -= DeltaSeconds;
+	if(RetryCooldown > 0.f) return;
+
+	const UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>();
+	if(!Registry) return;
+
+	// Pick any of the nearest points, skipping the one the character is standing on
+	TArray<int32> Candidates;
+	Registry->QueryNearest(Character->GetActorLocation(), CandidateCount + 1, GrappleRange, Candidates);
+	Candidates.RemoveAll([Registry, Character](int32 Index)
+	{
+		return FVector::DistSquared(Registry->GetEntry(Index).Location, Character->GetActorLocation()) < FMath::Square(300.f);
+	});
+	if(Candidates.Num() == 0) return;
+
+	const FGrapplingPointEntry& Target = Registry->GetEntry(Candidates[RandomStream.RandHelper(Candidates.Num())]);
+	if(Character->TryGrappleToTarget(FGrapplingPointTarget::FromEntry(Target)))
+	{
+		GrappleCount++;
+	}
+	else
+	{
+		RetryCooldown = RetryDelay;
+	}
+}
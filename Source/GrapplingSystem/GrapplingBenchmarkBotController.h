@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Controller.h"
+#include "GrapplingBenchmarkBotController.generated.h"
+
+/**
+ * Scripted controller used by the grappling benchmark: as soon as its character is idle it grapples
+ * towards one of the registered points near it, picked at random.
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API AGrapplingBenchmarkBotController : public AController
+{
+	GENERATED_BODY()
+
+public:
+
+	AGrapplingBenchmarkBotController();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Seeds the random target picks, so runs with the same seed grapple the same way */
+	void SetRandomSeed(int32 Seed) { RandomStream.Initialize(Seed); }
+
+	/** Grapples started by this bot */
+	int32 GetGrappleCount() const { return GrappleCount; }
+
+protected:
+
+	/** Farthest a target point can be */
+	UPROPERTY(EditAnywhere, Category = "Grappling")
+	float GrappleRange;
+
+	/** Number of nearest points the target is picked among */
+	UPROPERTY(EditAnywhere, Category = "Grappling")
+	int32 CandidateCount;
+
+	/** Time to wait before trying again when the picked point cannot be reached */
+	UPROPERTY(EditAnywhere, Category = "Grappling")
+	float RetryDelay;
+
+	float RetryCooldown;
+
+	FRandomStream RandomStream;
+
+	int32 GrappleCount;
+};
@@ -0,0 +1,320 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingBenchmarkCommandlet.h"
+
+#include "GrapplingBenchmarkBotController.h"
+#include "GrapplingPoint.h"
+#include "GrapplingRopeBatch.h"
+#include "GrapplingRopeComponent.h"
+#include "GrapplingRopeSolver.h"
+#include "GrapplingStats.h"
+#include "GrapplingSystem.h"
+#include "GrapplingSystemCharacter.h"
+#include "Algo/AllOf.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	/** Distance between neighbouring grappling points of the grid */
+	constexpr float PointSpacing = 1500.f;
+
+	/** Character of the project, the native class has no curve, montage nor rope guide set */
+	const TCHAR* DefaultCharacterClassPath = TEXT("/Game/ThirdPersonCPP/Blueprints/ThirdPersonCharacter.ThirdPersonCharacter_C");
+
+	TArray<int32> ParseCounts(const FString& Params, const TCHAR* Name, const TArray<int32>& Default)
+	{
+		FString Value;
+		if(!FParse::Value(*Params, Name, Value)) return Default;
+
+		TArray<FString> Items;
+		Value.ParseIntoArray(Items, TEXT(","));
+
+		TArray<int32> Counts;
+		for(const FString& Item : Items)
+		{
+			Counts.Add(FMath::Max(FCString::Atoi(*Item), 1));
+		}
+		return Counts;
+	}
+}
+
+UGrapplingBenchmarkCommandlet::UGrapplingBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = true;
+	LogToConsole = true;
+}
+
+int32 UGrapplingBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TArray<int32> PointCounts = ParseCounts(Params, TEXT("Points="), {10, 100, 1000, 10000});
+	const TArray<int32> CharacterCounts = ParseCounts(Params, TEXT("Characters="), {10, 100, 1000});
+	const TArray<int32> RopeCounts = ParseCounts(Params, TEXT("Ropes="), {10, 100, 1000});
+
+	FSettings Settings;
+	FParse::Value(*Params, TEXT("Frames="), Settings.Frames);
+	FParse::Value(*Params, TEXT("WarmupFrames="), Settings.WarmupFrames);
+	FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+
+	FString CharacterClassPath = DefaultCharacterClassPath;
+	FParse::Value(*Params, TEXT("CharacterClass="), CharacterClassPath);
+	Settings.CharacterClass = LoadClass<AGrapplingSystemCharacter>(nullptr, *CharacterClassPath);
+	if(!Settings.CharacterClass)
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Could not load character class %s"), *CharacterClassPath);
+		return 1;
+	}
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("Grappling.json");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	TArray<TSharedPtr<FJsonValue>> Runs;
+	for(const int32 PointCount : PointCounts)
+	{
+		for(const int32 CharacterCount : CharacterCounts)
+		{
+			Runs.Add(MakeShared<FJsonValueObject>(RunBenchmark(PointCount, CharacterCount, Settings)));
+		}
+	}
+
+	bool bRopeBatchValid = true;
+	TArray<TSharedPtr<FJsonValue>> RopeBatchRuns;
+	for(const int32 RopeCount : RopeCounts)
+	{
+		RopeBatchRuns.Add(MakeShared<FJsonValueObject>(RunRopeBatchBenchmark(RopeCount, Settings, bRopeBatchValid)));
+	}
+
+	const TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("frames"), Settings.Frames);
+	Report->SetNumberField(TEXT("deltaSeconds"), Settings.DeltaSeconds);
+	Report->SetStringField(TEXT("characterClass"), Settings.CharacterClass->GetPathName());
+	Report->SetArrayField(TEXT("runs"), Runs);
+	Report->SetArrayField(TEXT("ropeBatch"), RopeBatchRuns);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	if(!FFileHelper::SaveStringToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Could not write the benchmark report to %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogGrappling, Display, TEXT("Grappling benchmark report written to %s"), *OutputPath);
+	return bRopeBatchValid ? 0 : 1;
+}
+
+TSharedRef<FJsonObject> UGrapplingBenchmarkCommandlet::RunBenchmark(int32 PointCount, int32 CharacterCount, const FSettings& Settings)
+{
+	UE_LOG(LogGrappling, Display, TEXT("Running grappling benchmark with %d points and %d characters"), PointCount, CharacterCount);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("GrapplingBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	FRandomStream RandomStream(Settings.Seed);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// A floor under a square grid of points at random heights
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(float(PointCount)));
+	const float HalfExtent = GridSize * PointSpacing * 0.5f;
+	if(UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")))
+	{
+		AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(FVector(0.f, 0.f, -50.f), FRotator::ZeroRotator, SpawnParams);
+		Floor->GetStaticMeshComponent()->SetStaticMesh(Cube);
+		Floor->SetActorScale3D(FVector((HalfExtent + PointSpacing) / 50.f, (HalfExtent + PointSpacing) / 50.f, 1.f));
+	}
+
+	for(int32 i = 0; i < PointCount; i++)
+	{
+		const FVector Location(
+			(i % GridSize) * PointSpacing - HalfExtent,
+			(i / GridSize) * PointSpacing - HalfExtent,
+			RandomStream.FRandRange(200.f, 1200.f));
+		World->SpawnActor<AGrapplingPoint>(AGrapplingPoint::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams);
+	}
+
+	TArray<AGrapplingBenchmarkBotController*> Bots;
+	for(int32 i = 0; i < CharacterCount; i++)
+	{
+		const FVector Location(
+			RandomStream.FRandRange(-HalfExtent, HalfExtent),
+			RandomStream.FRandRange(-HalfExtent, HalfExtent),
+			100.f);
+		APawn* Character = World->SpawnActor<APawn>(Settings.CharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+		AGrapplingBenchmarkBotController* Bot = World->SpawnActor<AGrapplingBenchmarkBotController>(SpawnParams);
+		Bot->SetRandomSeed(Settings.Seed + i);
+		Bot->Possess(Character);
+		Bots.Add(Bot);
+	}
+
+	int32 SpawnedActors = 0;
+	const FDelegateHandle SpawnHandle = World->AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateLambda([&SpawnedActors](AActor*) { SpawnedActors++; }));
+
+	// Let everything settle before measuring
+	for(int32 Frame = 0; Frame < Settings.WarmupFrames; Frame++)
+	{
+		World->Tick(LEVELTICK_All, Settings.DeltaSeconds);
+		GFrameCounter++;
+	}
+	SpawnedActors = 0;
+
+	const uint64 StartSweeps = FGrapplingCounters::TotalSweeps;
+	TArray<double> FrameMilliseconds;
+	FrameMilliseconds.Reserve(Settings.Frames);
+	for(int32 Frame = 0; Frame < Settings.Frames; Frame++)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, Settings.DeltaSeconds);
+		FrameMilliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+		GFrameCounter++;
+	}
+	const uint64 Sweeps = FGrapplingCounters::TotalSweeps - StartSweeps;
+	World->RemoveOnActorSpawnedHandler(SpawnHandle);
+
+	int32 Grapples = 0;
+	for(const AGrapplingBenchmarkBotController* Bot : Bots)
+	{
+		Grapples += Bot->GetGrappleCount();
+	}
+
+	FrameMilliseconds.Sort();
+	double TotalMilliseconds = 0.0;
+	for(const double Milliseconds : FrameMilliseconds)
+	{
+		TotalMilliseconds += Milliseconds;
+	}
+	const int32 FrameCount = FMath::Max(FrameMilliseconds.Num(), 1);
+	const float SimulatedSeconds = FrameCount * Settings.DeltaSeconds;
+
+	const TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetNumberField(TEXT("points"), PointCount);
+	Result->SetNumberField(TEXT("characters"), CharacterCount);
+	Result->SetNumberField(TEXT("gameThreadMsAvg"), TotalMilliseconds / FrameCount);
+	Result->SetNumberField(TEXT("gameThreadMsP50"), FrameMilliseconds.Num() ? FrameMilliseconds[FrameCount / 2] : 0.0);
+	Result->SetNumberField(TEXT("gameThreadMsP95"), FrameMilliseconds.Num() ? FrameMilliseconds[FrameCount * 95 / 100] : 0.0);
+	Result->SetNumberField(TEXT("gameThreadMsMax"), FrameMilliseconds.Num() ? FrameMilliseconds.Last() : 0.0);
+	// Only the sweeps of the grappling code are counted, not the queries of the movement or anything else
+	Result->SetNumberField(TEXT("grappleSweeps"), double(Sweeps));
+	Result->SetNumberField(TEXT("grappleSweepsPerFrame"), double(Sweeps) / FrameCount);
+	Result->SetNumberField(TEXT("spawnedActorsPerSecond"), SpawnedActors / SimulatedSeconds);
+	Result->SetNumberField(TEXT("grapplesPerSecond"), Grapples / SimulatedSeconds);
+	// Peak of the whole process since it started, so it never goes down from one run to the next
+	Result->SetNumberField(TEXT("processPeakUsedPhysicalMB"), FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0));
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return Result;
+}
+
+TSharedRef<FJsonObject> UGrapplingBenchmarkCommandlet::RunRopeBatchBenchmark(int32 RopeCount, const FSettings& Settings, bool& bOutValid)
+{
+	UE_LOG(LogGrappling, Display, TEXT("Running rope batch benchmark with %d ropes"), RopeCount);
+
+	// Ropes as the pool creates them, hanging between random ends
+	const UGrapplingRopeComponent* RopeDefaults = GetDefault<UGrapplingRopeComponent>();
+	FGrapplingRopeBatchBuffer Buffer;
+	Buffer.Init(RopeDefaults->MaxSegments + 1, RopeDefaults->NumSides);
+
+	FRandomStream RandomStream(Settings.Seed);
+	TArray<TArray<FVector>> RopePoints;
+	RopePoints.SetNum(RopeCount);
+	for(int32 i = 0; i < RopeCount; i++)
+	{
+		Buffer.AddSlot();
+		const FVector Start = RandomStream.GetUnitVector() * 5000.f;
+		const FVector End = Start + RandomStream.GetUnitVector() * 1500.f;
+		FGrapplingRopeSolver::BuildSagApproximation(Start, End, 2000.f, FVector(0.f, 0.f, -1.f), RopeDefaults->MaxSegments, RopePoints[i]);
+	}
+
+	// Every rope moves, as when every rope is simulated
+	FGrapplingRopeBatchUpdate Update;
+	double FullMilliseconds = 0.0;
+	for(int32 Frame = 0; Frame < Settings.Frames; Frame++)
+	{
+		const FVector Offset(0.f, 0.f, Frame % 2 ? 1.f : -1.f);
+		for(int32 i = 0; i < RopeCount; i++)
+		{
+			RopePoints[i][1] += Offset;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		for(int32 i = 0; i < RopeCount; i++)
+		{
+			Buffer.SetPoints(i, RopePoints[i], RopeDefaults->RopeWidth, RopeDefaults->TileMaterial);
+		}
+		Buffer.BuildDirtySlots(Update);
+		FullMilliseconds += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+	const int32 FullSlots = Update.Slots.Num();
+	const int32 FullVertices = Update.Vertices.Num();
+
+	// A tenth of the ropes move, the others are handed the same points again
+	const int32 MovingRopeCount = FMath::Max(RopeCount / 10, 1);
+	double PartialMilliseconds = 0.0;
+	for(int32 Frame = 0; Frame < Settings.Frames; Frame++)
+	{
+		const FVector Offset(0.f, 0.f, Frame % 2 ? 1.f : -1.f);
+		for(int32 i = 0; i < MovingRopeCount; i++)
+		{
+			RopePoints[i][1] += Offset;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		for(int32 i = 0; i < RopeCount; i++)
+		{
+			Buffer.SetPoints(i, RopePoints[i], RopeDefaults->RopeWidth, RopeDefaults->TileMaterial);
+		}
+		Buffer.BuildDirtySlots(Update);
+		PartialMilliseconds += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+	const int32 PartialSlots = Update.Slots.Num();
+
+	TArray<uint32> Indices;
+	Buffer.BuildIndices(RopeCount, Indices);
+
+	// Every rope gets a full slot and only the moved ones are rebuilt
+	const int32 SlotVertexCount = Buffer.GetSlotVertexCount();
+	const bool bValid = FullSlots == RopeCount
+		&& FullVertices == RopeCount * SlotVertexCount
+		&& PartialSlots == FMath::Min(MovingRopeCount, RopeCount)
+		&& Update.DrawnSlotCount == RopeCount
+		&& Indices.Num() == RopeCount * Buffer.GetSlotIndexCount()
+		&& Algo::AllOf(Indices, [Max = uint32(RopeCount * SlotVertexCount)](uint32 Index) { return Index < Max; });
+	if(!bValid)
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Rope batch of %d ropes has the wrong size: %d slots and %d vertices rebuilt, %d drawn slots, %d indices"),
+		       RopeCount, FullSlots, FullVertices, Update.DrawnSlotCount, Indices.Num());
+		bOutValid = false;
+	}
+
+	const int32 FrameCount = FMath::Max(Settings.Frames, 1);
+	const TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetNumberField(TEXT("ropes"), RopeCount);
+	Result->SetBoolField(TEXT("valid"), bValid);
+	Result->SetNumberField(TEXT("vertices"), RopeCount * SlotVertexCount);
+	Result->SetNumberField(TEXT("indices"), Indices.Num());
+	Result->SetNumberField(TEXT("allChangedBuildMsAvg"), FullMilliseconds / FrameCount);
+	Result->SetNumberField(TEXT("tenthChangedBuildMsAvg"), PartialMilliseconds / FrameCount);
+	Result->SetNumberField(TEXT("tenthChangedUploadBytes"), double(PartialSlots) * SlotVertexCount * sizeof(FDynamicMeshVertex));
+	return Result;
+}
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GrapplingBenchmarkCommandlet.generated.h"
+
+class FJsonObject;
+
+/**
+ * Headless grappling stress benchmark. For every requested combination of point and character
+ * counts it builds a world with a grid of grappling points and scripted characters that grapple
+ * continuously between them, ticks it for a fixed number of frames and reports the results as JSON.
+ * The characters are the project third person character unless another class is given.
+ * grappleSweeps counts the sweeps of the grappling code only, processPeakUsedPhysicalMB is the
+ * peak of the whole process so far, not of the run.
+ *
+ * Usage: UE4Editor-Cmd GrapplingSystem -run=GrapplingBenchmark -nullrhi -unattended
+ *        [-Points=10,100,1000,10000] [-Characters=10,100,1000] [-Frames=600] [-WarmupFrames=60]
+ *        [-CharacterClass=/Game/ThirdPersonCPP/Blueprints/ThirdPersonCharacter.ThirdPersonCharacter_C]
+ *        [-Seed=1] [-Output=Saved/Benchmarks/Grappling.json]
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API UGrapplingBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	/** Settings shared by every run */
+	struct FSettings
+	{
+		int32 Frames = 600;
+		int32 WarmupFrames = 60;
+		int32 Seed = 1;
+		float DeltaSeconds = 1.f / 60.f;
+		UClass* CharacterClass = nullptr;
+	};
+
+	/** Runs the benchmark for one point and character count, returns its results */
+	TSharedRef<FJsonObject> RunBenchmark(int32 PointCount, int32 CharacterCount, const FSettings& Settings);
+
+	/** Times the merged rope mesh build for a number of ropes. Sets bOutValid to false if the mesh is the wrong size */
+	TSharedRef<FJsonObject> RunRopeBatchBenchmark(int32 RopeCount, const FSettings& Settings, bool& bOutValid);
+};
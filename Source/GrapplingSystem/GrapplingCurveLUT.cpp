@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingCurveLUT.h"
+
+#include "GrapplingSystem.h"
+#include "Curves/CurveFloat.h"
+#include "GrappleCore/GrappleCore.h"
+
+constexpr int32 FGrapplingCurveLUT::MaxResolution;
+
+namespace
+{
+	/** Points probed inside every interval of the table when measuring the deviation */
+	constexpr int32 DeviationProbesPerInterval = 8;
+}
+
+bool FGrapplingCurveLUT::Build(const UCurveFloat* Curve, int32 Resolution, float Tolerance)
+{
+	Values.Reset();
+	MaxDeviation = 0.f;
+	if(!Curve) return false;
+
+	Resolution = FMath::Clamp(Resolution, 1, MaxResolution);
+	while(true)
+	{
+		Sample(Curve, Resolution);
+		MaxDeviation = MeasureDeviation(Curve);
+		if(MaxDeviation <= Tolerance) return true;
+		if(Resolution >= MaxResolution) break;
+		Resolution = FMath::Min(Resolution * 2, MaxResolution);
+	}
+
+	UE_LOG(LogGrappling, Warning, TEXT("Baked %s deviates by %f from the curve at %d samples, more than the %f tolerance"),
+	       *Curve->GetName(), MaxDeviation, Resolution, Tolerance);
+	return false;
+}
+
+float FGrapplingCurveLUT::Evaluate(float Alpha) const
+{
+	return GrappleCore::EvaluateCurveTable(Values.GetData(), Values.Num() - 2, Alpha);
+}
+
+void FGrapplingCurveLUT::EvaluateBatch(const float* Alphas, float* OutValues, int32 Count) const
+{
+	const VectorRegister Scale = VectorSetFloat1(float(Values.Num() - 2));
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister One = VectorOne();
+
+	int32 i = 0;
+	for(; i + 4 <= Count; i += 4)
+	{
+		// Position in the table, its integer part picks the interval and the rest lerps inside it
+		const VectorRegister Position = VectorMultiply(VectorMin(VectorMax(VectorLoad(Alphas + i), Zero), One), Scale);
+		const VectorRegister Floor = VectorTruncate(Position);
+		const VectorRegister Fraction = VectorSubtract(Position, Floor);
+
+		float Indices[4];
+		VectorStore(Floor, Indices);
+
+		// The table lookups are scalar, there is no gather in the vector intrinsics
+		float Lower[4], Upper[4];
+		for(int32 Lane = 0; Lane < 4; Lane++)
+		{
+			const int32 Index = int32(Indices[Lane]);
+			Lower[Lane] = Values[Index];
+			Upper[Lane] = Values[Index + 1];
+		}
+
+		const VectorRegister LowerValues = VectorLoad(Lower);
+		const VectorRegister Result = VectorMultiplyAdd(Fraction, VectorSubtract(VectorLoad(Upper), LowerValues), LowerValues);
+		VectorStore(Result, OutValues + i);
+	}
+
+	GrappleCore::EvaluateCurveTableBatch(Values.GetData(), Values.Num() - 2, Alphas + i, OutValues + i, Count - i);
+}
+
+void FGrapplingCurveLUT::Sample(const UCurveFloat* Curve, int32 Resolution)
+{
+	Values.SetNumUninitialized(Resolution + 2);
+	for(int32 i = 0; i <= Resolution; i++)
+	{
+		Values[i] = Curve->GetFloatValue(float(i) / Resolution);
+	}
+	Values[Resolution + 1] = Values[Resolution];
+}
+
+float FGrapplingCurveLUT::MeasureDeviation(const UCurveFloat* Curve) const
+{
+	const int32 ProbeCount = GetResolution() * DeviationProbesPerInterval;
+
+	float Deviation = 0.f;
+	for(int32 i = 0; i <= ProbeCount; i++)
+	{
+		const float Alpha = float(i) / ProbeCount;
+		Deviation = FMath::Max(Deviation, FMath::Abs(Evaluate(Alpha) - Curve->GetFloatValue(Alpha)));
+	}
+	return Deviation;
+}
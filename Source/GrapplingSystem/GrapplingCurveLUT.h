@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCurveFloat;
+
+/**
+ * Grappling curve baked into a fixed-resolution table over [0, 1], evaluated with linear
+ * interpolation. Baking measures how far the table strays from the source curve and doubles
+ * the resolution until it stays under the requested tolerance.
+ */
+struct GRAPPLINGSYSTEM_API FGrapplingCurveLUT
+{
+	/** Highest resolution baking may reach while trying to meet the tolerance */
+	static constexpr int32 MaxResolution = 4096;
+
+	/** Samples a curve into the table. Returns false if the tolerance could not be met at MaxResolution */
+	bool Build(const UCurveFloat* Curve, int32 Resolution, float Tolerance);
+
+	/** Is there anything baked? */
+	bool IsValid() const { return Values.Num() > 2; }
+
+	/** Value of the curve at Alpha, clamped to [0, 1] */
+	float Evaluate(float Alpha) const;
+
+	/** Evaluates Count alphas at once, four at a time with vector instructions */
+	void EvaluateBatch(const float* Alphas, float* OutValues, int32 Count) const;
+
+	/** Largest difference with the source curve measured while baking */
+	float GetMaxDeviation() const { return MaxDeviation; }
+
+	/** Number of intervals of the table */
+	int32 GetResolution() const { return Values.Num() - 2; }
+
+private:
+
+	/** Curve values at evenly spaced alphas, plus one extra copy of the last value so the
+	 *  interpolation never reads past the end, even at Alpha = 1 */
+	TArray<float> Values;
+
+	float MaxDeviation = 0.f;
+
+	void Sample(const UCurveFloat* Curve, int32 Resolution);
+
+	float MeasureDeviation(const UCurveFloat* Curve) const;
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingIndicatorSubsystem.h"
+
+#include "CanvasItem.h"
+#include "GrapplingPointSetComponent.h"
+#include "GrapplingPointSubsystem.h"
+#include "GrapplingStats.h"
+#include "SceneView.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Canvas.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "GameFramework/HUD.h"
+
+UGrapplingIndicatorSubsystem::UGrapplingIndicatorSubsystem()
+{
+	IndicatorTexture = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/Grappling/HUD/Images/disc.disc")));
+	MaxIndicators = 32;
+	MaxIndicatorDistance = 5000.f;
+	IndicatorSize = 24.f;
+	FocusedIndicatorSize = 48.f;
+	IndicatorColor = FLinearColor(1.f, 1.f, 1.f, 0.6f);
+	FocusedIndicatorColor = FLinearColor::White;
+	LoadedIndicatorTexture = nullptr;
+}
+
+void UGrapplingIndicatorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Nothing is drawn without a game viewport, dedicated servers skip the texture too
+	const UWorld* World = GetWorld();
+	if(World && World->IsGameWorld() && World->GetNetMode() != NM_DedicatedServer)
+	{
+		// The map does not wait for the texture, indicators show up once it is in
+		IndicatorTextureHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(IndicatorTexture.ToSoftObjectPath(),
+			FStreamableDelegate::CreateUObject(this, &UGrapplingIndicatorSubsystem::OnIndicatorTextureLoaded));
+		PostRenderHandle = AHUD::OnHUDPostRender.AddUObject(this, &UGrapplingIndicatorSubsystem::DrawIndicators);
+	}
+}
+
+void UGrapplingIndicatorSubsystem::Deinitialize()
+{
+	AHUD::OnHUDPostRender.Remove(PostRenderHandle);
+	PostRenderHandle.Reset();
+	if(IndicatorTextureHandle.IsValid())
+	{
+		IndicatorTextureHandle->CancelHandle();
+		IndicatorTextureHandle.Reset();
+	}
+	LoadedIndicatorTexture = nullptr;
+	Super::Deinitialize();
+}
+
+void UGrapplingIndicatorSubsystem::OnIndicatorTextureLoaded()
+{
+	LoadedIndicatorTexture = IndicatorTexture.Get();
+}
+
+void UGrapplingIndicatorSubsystem::DrawIndicators(AHUD* HUD, UCanvas* Canvas)
+{
+	if(!HUD || HUD->GetWorld() != GetWorld() || !Canvas || !Canvas->SceneView || !LoadedIndicatorTexture) return;
+
+	const UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>();
+	if(!Registry) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_Indicators);
+	CSV_SCOPED_TIMING_STAT(Grappling, Indicators);
+
+	const FSceneView* View = Canvas->SceneView;
+	const FVector ViewLocation = View->ViewMatrices.GetViewOrigin();
+
+	TArray<int32> Visible;
+	Registry->QueryFrustum(View->ViewFrustum, ViewLocation, MaxIndicatorDistance, Visible);
+
+	// Focused points first, then by distance, so the cap never hides the point being aimed at
+	struct FCandidate
+	{
+		bool bFocused;
+		FVector Location;
+		float DistanceSquared;
+	};
+	TArray<FCandidate, TInlineAllocator<64>> Candidates;
+	const float MaxDistanceSquared = FMath::Square(MaxIndicatorDistance);
+	for(const int32 Index : Visible)
+	{
+		const FGrapplingPointEntry& Entry = Registry->GetEntry(Index);
+		const float DistanceSquared = FVector::DistSquared(Entry.Location, ViewLocation);
+		if(DistanceSquared > MaxDistanceSquared) continue;
+
+		Candidates.Add({FGrapplingPointTarget::FromEntry(Entry).IsFocused(), Entry.Location, DistanceSquared});
+	}
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B)
+	{
+		if(A.bFocused != B.bFocused) return A.bFocused;
+		return A.DistanceSquared < B.DistanceSquared;
+	});
+
+	// Every tile uses the same texture, so the canvas draws them in a single batch
+	FCanvasTileItem Tile(FVector2D::ZeroVector, LoadedIndicatorTexture->Resource, FVector2D::ZeroVector, IndicatorColor);
+	Tile.BlendMode = SE_BLEND_Translucent;
+	const int32 Count = FMath::Min(Candidates.Num(), MaxIndicators);
+	for(int32 i = 0; i < Count; i++)
+	{
+		const FVector ScreenLocation = Canvas->Project(Candidates[i].Location);
+		if(ScreenLocation.Z <= 0.f) continue;
+
+		const bool bFocused = Candidates[i].bFocused;
+		const float Size = bFocused ? FocusedIndicatorSize : IndicatorSize;
+		Tile.Position = FVector2D(ScreenLocation.X - Size * 0.5f, ScreenLocation.Y - Size * 0.5f);
+		Tile.Size = FVector2D(Size, Size);
+		Tile.SetColor(bFocused ? FocusedIndicatorColor : IndicatorColor);
+		Canvas->DrawItem(Tile);
+	}
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingIndicatorSubsystem.generated.h"
+
+class AHUD;
+class UCanvas;
+class UTexture2D;
+struct FStreamableHandle;
+
+/**
+ * Draws the on-screen indicators of the grappling points on the HUD canvas of every local
+ * player, all in one pass: the registered points inside the view are projected, the closest
+ * ones up to MaxIndicators are kept and drawn as batched tiles, the focused one larger.
+ * Replaces the widget component of every point, whose cost grew with the number of points.
+ */
+UCLASS(config=Game)
+class GRAPPLINGSYSTEM_API UGrapplingIndicatorSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingIndicatorSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Image drawn for every indicator */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	TSoftObjectPtr<UTexture2D> IndicatorTexture;
+
+	/** Most indicators drawn at once, the closest points win */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 MaxIndicators;
+
+	/** Farthest distance at which a point gets an indicator */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float MaxIndicatorDistance;
+
+	/** Size of an indicator on screen, in pixels */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float IndicatorSize;
+
+	/** Size of the indicator of the point the character is looking at, in pixels */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float FocusedIndicatorSize;
+
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	FLinearColor IndicatorColor;
+
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	FLinearColor FocusedIndicatorColor;
+
+	/** Loaded IndicatorTexture, null until it is */
+	UPROPERTY(Transient)
+	UTexture2D* LoadedIndicatorTexture;
+
+	TSharedPtr<FStreamableHandle> IndicatorTextureHandle;
+
+	void OnIndicatorTextureLoaded();
+
+	FDelegateHandle PostRenderHandle;
+
+	/** Draws the indicators on a HUD of this world */
+	void DrawIndicators(AHUD* HUD, UCanvas* Canvas);
+};
@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingMovementComponent.h"
+
+#include "GrapplingSimulationSubsystem.h"
+#include "GrapplingStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+
+void FSavedMove_Grappling::Clear()
+{
+	Super::Clear();
+
+	LeapSerial = 0;
+	LeapElapsedTime = 0.f;
+	LeapPreviousElapsedTime = 0.f;
+	LeapStepAccumulator = 0.f;
+}
+
+void FSavedMove_Grappling::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	const UGrapplingMovementComponent* GrapplingMovement = Cast<UGrapplingMovementComponent>(C->GetCharacterMovement());
+	if(GrapplingMovement && GrapplingMovement->IsGrappling())
+	{
+		LeapSerial = GrapplingMovement->LeapSerial;
+		LeapElapsedTime = GrapplingMovement->LeapElapsedTime;
+		LeapPreviousElapsedTime = GrapplingMovement->LeapPreviousElapsedTime;
+		LeapStepAccumulator = GrapplingMovement->LeapStepAccumulator;
+	}
+}
+
+void FSavedMove_Grappling::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// Moves of an earlier leap, or made before the current one started, leave it alone
+	UGrapplingMovementComponent* GrapplingMovement = Cast<UGrapplingMovementComponent>(C->GetCharacterMovement());
+	if(GrapplingMovement && LeapSerial != 0 && LeapSerial == GrapplingMovement->LeapSerial)
+	{
+		GrapplingMovement->LeapElapsedTime = LeapElapsedTime;
+		GrapplingMovement->LeapPreviousElapsedTime = LeapPreviousElapsedTime;
+		GrapplingMovement->LeapStepAccumulator = LeapStepAccumulator;
+		// Replayed moves start from the corrected location
+		GrapplingMovement->LeapSteppedLocation = C->GetActorLocation();
+	}
+}
+
+bool FSavedMove_Grappling::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	// A combined move would start from the leap time of the second move, leaps are short enough to send every move
+	const FSavedMove_Grappling* NewGrapplingMove = static_cast<const FSavedMove_Grappling*>(NewMove.Get());
+	if(LeapSerial != 0 || NewGrapplingMove->LeapSerial != 0) return false;
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+FNetworkPredictionData_Client_Grappling::FNetworkPredictionData_Client_Grappling(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Grappling::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Grappling());
+}
+
+UGrapplingMovementComponent::UGrapplingMovementComponent()
+{
+	LeapHandle = INDEX_NONE;
+	LeapElapsedTime = 0.f;
+	LeapDuration = 0.f;
+	LeapPreviousElapsedTime = 0.f;
+	LeapStepAccumulator = 0.f;
+	LeapSteppedLocation = FVector::ZeroVector;
+	LeapSerial = 0;
+}
+
+void UGrapplingMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The leap sub-steps have to be computed before the character moves through them
+	if(UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>())
+	{
+		PrimaryComponentTick.AddPrerequisite(Simulation, Simulation->GetTickFunction());
+	}
+}
+
+void UGrapplingMovementComponent::StartLeap(const FGrapplingTrajectory& Trajectory, float Duration, float ElapsedTime)
+{
+	UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>();
+	if(!Simulation) return;
+
+	RemoveLeap();
+	LeapSerial = LeapSerial == MAX_uint32 ? 1 : LeapSerial + 1;
+	LeapDuration = FMath::Max(Duration, 0.f);
+	LeapElapsedTime = FMath::Clamp(ElapsedTime, 0.f, LeapDuration);
+	LeapPreviousElapsedTime = LeapElapsedTime;
+	LeapStepAccumulator = 0.f;
+	LeapSteppedLocation = UpdatedComponent ? UpdatedComponent->GetComponentLocation() : FVector::ZeroVector;
+	LeapHandle = Simulation->AddLeap(Trajectory, Duration, MaxSimulationTimeStep, ElapsedTime);
+	SetMovementMode(MOVE_Custom, static_cast<uint8>(EGrapplingMovementMode::Grappling));
+}
+
+bool UGrapplingMovementComponent::IsGrappling() const
+{
+	return MovementMode == MOVE_Custom && CustomMovementMode == static_cast<uint8>(EGrapplingMovementMode::Grappling);
+}
+
+float UGrapplingMovementComponent::GetLeapAlpha() const
+{
+	const UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>();
+	return Simulation ? Simulation->GetLeapAlpha(LeapHandle) : 1.f;
+}
+
+FNetworkPredictionData_Client* UGrapplingMovementComponent::GetPredictionData_Client() const
+{
+	if(!ClientPredictionData)
+	{
+		UGrapplingMovementComponent* MutableThis = const_cast<UGrapplingMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Grappling(*this);
+	}
+	return ClientPredictionData;
+}
+
+void UGrapplingMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if(CustomMovementMode == static_cast<uint8>(EGrapplingMovementMode::Grappling))
+	{
+		PhysGrappling(deltaTime, Iterations);
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+void UGrapplingMovementComponent::SimulateMovement(float DeltaTime)
+{
+	// The server stops replicating the movement of leaping characters, proxies move along the leap
+	// they started from the replicated leap until it ends, then go back to the replicated movement.
+	// A movement mode received in between, as when the leap was cut short on the server, wins
+	if(IsGrappling() && LeapHandle != INDEX_NONE && !bNetworkMovementModeChanged
+	   && CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		PhysGrappling(DeltaTime, 0);
+		return;
+	}
+
+	Super::SimulateMovement(DeltaTime);
+}
+
+void UGrapplingMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	const bool bWasGrappling = PreviousMovementMode == MOVE_Custom && PreviousCustomMode == static_cast<uint8>(EGrapplingMovementMode::Grappling);
+	if(bWasGrappling && !IsGrappling())
+	{
+		RemoveLeap();
+		OnLeapFinished.ExecuteIfBound();
+	}
+}
+
+void UGrapplingMovementComponent::OnUnregister()
+{
+	RemoveLeap();
+	Super::OnUnregister();
+}
+
+void UGrapplingMovementComponent::RemoveLeap()
+{
+	if(LeapHandle == INDEX_NONE) return;
+
+	if(UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>())
+	{
+		Simulation->RemoveLeap(LeapHandle);
+	}
+	LeapHandle = INDEX_NONE;
+}
+
+void UGrapplingMovementComponent::PhysGrappling(float deltaTime, int32 Iterations)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_Grapple);
+	CSV_SCOPED_TIMING_STAT(Grappling, Grapple);
+
+	if(deltaTime < MIN_TICK_TIME) return;
+	UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>();
+	if(!Simulation || LeapHandle == INDEX_NONE)
+	{
+		SetMovementMode(MOVE_Falling);
+		return;
+	}
+
+	// Advance the leap by the time of this move rather than by the frame, and sweep through the locations
+	// it goes through, so fast leaps follow the curve instead of cutting through it
+	FVector Steps[UGrapplingSimulationSubsystem::MaxLeapSteps];
+	int32 StepCount;
+	float TimeTick;
+	FVector DrawnLocation;
+	const bool bFixedTimeStep = Simulation->IsFixedTimeStep();
+	if(bFixedTimeStep)
+	{
+		// Only whole fixed steps are taken, so the leap plays the same at any frame rate. They sweep
+		// on from where the last step left the character, not from where it was drawn. Long moves
+		// drop the time past the sub-step limit, as the simulation does
+		const float StepTime = Simulation->GetFixedStepTime();
+		LeapStepAccumulator = FMath::Min(LeapStepAccumulator + deltaTime, StepTime * (UGrapplingSimulationSubsystem::MaxLeapSteps + 1));
+		const int32 FixedStepCount = FMath::Min(FMath::FloorToInt(LeapStepAccumulator / StepTime), UGrapplingSimulationSubsystem::MaxLeapSteps);
+		LeapStepAccumulator = FMath::Max(LeapStepAccumulator - FixedStepCount * StepTime, 0.f);
+		MoveUpdatedComponent(LeapSteppedLocation - UpdatedComponent->GetComponentLocation(), UpdatedComponent->GetComponentQuat(), false);
+
+		StepCount = Simulation->StepLeap(LeapHandle, LeapElapsedTime, LeapPreviousElapsedTime, FixedStepCount,
+		                                 LeapStepAccumulator / StepTime, Steps, DrawnLocation);
+		TimeTick = StepTime;
+	}
+	else
+	{
+		const float FromTime = LeapElapsedTime;
+		LeapElapsedTime = FMath::Min(LeapElapsedTime + deltaTime, LeapDuration);
+		StepCount = Simulation->AdvanceLeap(LeapHandle, FromTime, LeapElapsedTime, Steps);
+		TimeTick = deltaTime / FMath::Max(StepCount, 1);
+	}
+
+	for(int32 StepIndex = 0; StepIndex < StepCount; StepIndex++)
+	{
+		const FVector& Step = Steps[StepIndex];
+		Iterations++;
+		const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+		const FVector Delta = Step - OldLocation;
+
+		FHitResult Hit(1.f);
+		SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+		if(Hit.IsValidBlockingHit())
+		{
+			HandleImpact(Hit, TimeTick, Delta);
+			SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+		}
+
+		if(!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+		{
+			Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / TimeTick;
+		}
+
+		// Something in a hit callback may have ended the leap
+		if(!IsGrappling()) return;
+	}
+
+	// On arrival, let the character fall from the end of the leap as it used to stop there
+	if(LeapElapsedTime >= LeapDuration)
+	{
+		Velocity = FVector::ZeroVector;
+		SetMovementMode(MOVE_Falling);
+		return;
+	}
+
+	// Drawn between the last two fixed steps. The next move puts the character back where the steps left it
+	if(bFixedTimeStep)
+	{
+		LeapSteppedLocation = UpdatedComponent->GetComponentLocation();
+		FHitResult Hit(1.f);
+		SafeMoveUpdatedComponent(DrawnLocation - LeapSteppedLocation, UpdatedComponent->GetComponentQuat(), true, Hit);
+	}
+}
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingTrajectory.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GrapplingMovementComponent.generated.h"
+
+/** Custom movement modes added by the grappling system */
+UENUM(BlueprintType)
+enum class EGrapplingMovementMode : uint8
+{
+	None UMETA(Hidden),
+
+	/** Leaping along a grappling trajectory */
+	Grappling
+};
+
+DECLARE_DELEGATE(FOnGrappleLeapFinished);
+
+/**
+ * Client move that also restores how far into its leap the character was, so moves replayed after
+ * a server correction follow the leap from the right time rather than from where it is now
+ */
+class GRAPPLINGSYSTEM_API FSavedMove_Grappling : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+
+	/** Leap the move was made in, 0 if none */
+	uint32 LeapSerial = 0;
+
+	/** Seconds of the leap moved through when the move started */
+	float LeapElapsedTime = 0.f;
+
+	/** Leap time one fixed step earlier, in fixed step mode */
+	float LeapPreviousElapsedTime = 0.f;
+
+	/** Move time not stepped yet, in fixed step mode */
+	float LeapStepAccumulator = 0.f;
+};
+
+/** Client prediction data allocating grappling saved moves */
+class GRAPPLINGSYSTEM_API FNetworkPredictionData_Client_Grappling : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Grappling(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+ * Character movement with a grappling mode, that moves the character along the leap trajectory
+ * with sub-stepped sweeps and hands it back to falling on arrival. The leap advances by the time
+ * of each move, like any other movement mode, so it plays the same when a server runs the moves of
+ * a client and when a client replays its moves. The grappling simulation subsystem, which ticks
+ * first, hands out the sub-step locations of the frame when the move covers it.
+ * When the simulation is in fixed step mode, the move time is spent in whole fixed steps instead,
+ * one sweep per step, and the character is drawn interpolated between the last two steps.
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API UGrapplingMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingMovementComponent();
+
+	virtual void BeginPlay() override;
+
+	/** Switches to the grappling mode and starts moving along the trajectory, reaching its end in Duration seconds.
+	 *  ElapsedTime skips the start of a leap that began earlier on the server */
+	void StartLeap(const FGrapplingTrajectory& Trajectory, float Duration, float ElapsedTime = 0.f);
+
+	/** Is the character leaping along a grappling trajectory? */
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	bool IsGrappling() const;
+
+	/** Fraction of the current leap already travelled */
+	float GetLeapAlpha() const;
+
+	/** Called when the leap ends, because the character arrived or because something else changed the movement mode */
+	FOnGrappleLeapFinished OnLeapFinished;
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+protected:
+
+	friend class FSavedMove_Grappling;
+
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+	/** Simulated proxies follow the leaps they were told about themselves, instead of the replicated movement */
+	virtual void SimulateMovement(float DeltaTime) override;
+
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
+	virtual void OnUnregister() override;
+
+	/** Moves the character along the leap trajectory */
+	void PhysGrappling(float deltaTime, int32 Iterations);
+
+	/** Stops simulating the current leap, if any */
+	void RemoveLeap();
+
+	/** Handle of the current leap in the grappling simulation. INDEX_NONE when not leaping */
+	int32 LeapHandle;
+
+	/** Seconds of the current leap already moved through */
+	float LeapElapsedTime;
+
+	/** Seconds the current leap takes */
+	float LeapDuration;
+
+	/** In fixed step mode, leap time one step before LeapElapsedTime, interpolated from for drawing */
+	float LeapPreviousElapsedTime;
+
+	/** In fixed step mode, move time not stepped yet, less than a step */
+	float LeapStepAccumulator;
+
+	/** In fixed step mode, where the last fixed step left the character. The next steps sweep from
+	 *  there, rather than from the interpolated location it is drawn at */
+	FVector LeapSteppedLocation;
+
+	/** Incremented by every leap, so saved moves only restore the time of the leap they were made in */
+	uint32 LeapSerial;
+};
@@ -3,6 +3,11 @@
 
 #include "GrapplingPoint.h"
 
+#include "GrapplingPointSubsystem.h"
+#include "GrapplingSignificanceSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
 // Sets default values
 AGrapplingPoint::AGrapplingPoint()
 {
@@ -21,12 +26,122 @@ AGrapplingPoint::AGrapplingPoint()
 
 	RopeOffsetTransform = CreateDefaultSubobject<USceneComponent>(TEXT("RopeOffsetTransform"));
 	RopeOffsetTransform->SetupAttachment(GetRootComponent());
+
+	bUseWidgetIndicator = false;
+	bPointIdUnsaved = false;
+	RegistryIndex = INDEX_NONE;
+	LOD = EGrapplingPointLOD::Active;
 }
 
 // Called when the game starts or when spawned
 void AGrapplingPoint::BeginPlay()
 {
+	// Empty the widget before it creates its widget tree when the components begin play. The component
+	// is kept, so Blueprints reading it still find it
+	if(!bUseWidgetIndicator && GrappleWidget)
+	{
+		GrappleWidget->SetWidgetClass(nullptr);
+		GrappleWidget->SetVisibility(false);
+		GrappleWidget->SetComponentTickEnabled(false);
+	}
+
 	Super::BeginPlay();
+
+	// The tick of the point only drives its widget indicator
+	if(!bUseWidgetIndicator)
+	{
+		SetActorTickEnabled(false);
+	}
+
+	// Register in the spatial hash so the point can be found without physics queries
+	if(UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		RegistryIndex = Registry->RegisterPoint(this, GetActorLocation(), CollisionSphere->GetScaledSphereRadius());
+		if(CollisionSphere->Mobility == EComponentMobility::Movable)
+		{
+			CollisionSphere->TransformUpdated.AddUObject(this, &AGrapplingPoint::OnPointMoved);
+		}
+	}
+
+	if(UGrapplingSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UGrapplingSignificanceSubsystem>())
+	{
+		Significance->RegisterPoint(this);
+	}
+}
+
+void AGrapplingPoint::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(UGrapplingSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UGrapplingSignificanceSubsystem>())
+	{
+		Significance->UnregisterPoint(this);
+	}
+
+	CollisionSphere->TransformUpdated.RemoveAll(this);
+	if(UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		Registry->UnregisterPoint(RegistryIndex);
+	}
+	RegistryIndex = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGrapplingPoint::PostActorCreated()
+{
+	Super::PostActorCreated();
+
+	if(!PointId.IsValid())
+	{
+		PointId = FGuid::NewGuid();
+	}
+}
+
+void AGrapplingPoint::PostLoad()
+{
+	Super::PostLoad();
+
+	// Points placed before they had ids. The package cannot be dirtied while it loads, construction does it
+	EnsurePointId();
+}
+
+void AGrapplingPoint::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	EnsurePointId();
+#if WITH_EDITOR
+	if(bPointIdUnsaved && !IsTemplate() && GetWorld() && !GetWorld()->IsGameWorld())
+	{
+		bPointIdUnsaved = false;
+		MarkPackageDirty();
+	}
+#endif
+}
+
+void AGrapplingPoint::EnsurePointId()
+{
+	if(!PointId.IsValid() && !IsTemplate())
+	{
+		PointId = FGuid::NewGuid();
+		bPointIdUnsaved = true;
+	}
+}
+
+#if WITH_EDITOR
+void AGrapplingPoint::PostEditImport()
+{
+	Super::PostEditImport();
+
+	PointId = FGuid::NewGuid();
+}
+#endif
+
+void AGrapplingPoint::OnPointMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if(UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		Registry->UpdatePointLocation(RegistryIndex, GetActorLocation());
+	}
 }
 
 // Called every frame
@@ -40,3 +155,36 @@ void AGrapplingPoint::EnableFocused()
 	bCharacterFocused = true;
 }
 
+void AGrapplingPoint::DisableFocused()
+{
+	bCharacterFocused = false;
+}
+
+EGrapplingPointFlags AGrapplingPoint::GetFlags() const
+{
+	return bUseWidgetIndicator ? EGrapplingPointFlags::WidgetIndicator : EGrapplingPointFlags::None;
+}
+
+void AGrapplingPoint::SetLOD(EGrapplingPointLOD NewLOD)
+{
+	if(NewLOD == LOD) return;
+	LOD = NewLOD;
+
+	const bool bActive = LOD == EGrapplingPointLOD::Active;
+	SetActorTickEnabled(bActive && bUseWidgetIndicator);
+
+	if(GrappleMesh)
+	{
+		const UStaticMesh* Mesh = GrappleMesh->GetStaticMesh();
+		GrappleMesh->SetForcedLodModel(bActive || !Mesh ? 0 : Mesh->GetNumLODs());
+		GrappleMesh->SetCastShadow(bActive);
+		GrappleMesh->SetVisibility(LOD != EGrapplingPointLOD::Dormant);
+	}
+
+	if(GrappleWidget && bUseWidgetIndicator)
+	{
+		GrappleWidget->SetVisibility(bActive);
+		GrappleWidget->SetComponentTickEnabled(bActive);
+	}
+}
+
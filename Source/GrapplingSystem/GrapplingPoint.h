@@ -6,6 +6,8 @@
 #include "Components/SphereComponent.h"
 #include "Components/WidgetComponent.h"
 #include "GameFramework/Actor.h"
+#include "GrapplingPointTable.h"
+#include "GrapplingSignificanceSubsystem.h"
 #include "GrapplingPoint.generated.h"
 
 UCLASS()
@@ -21,6 +23,23 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the actor is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called when the actor is spawned, gives it its own id
+	virtual void PostActorCreated() override;
+
+	// Called when the actor is loaded, gives an id to points saved without one
+	virtual void PostLoad() override;
+
+	// Called when the actor is constructed in the editor, so the level of a point that just got its id is saved with it
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+#if WITH_EDITOR
+	// Called when the actor is pasted or duplicated in the editor, the copy gets its own id
+	virtual void PostEditImport() override;
+#endif
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -39,19 +58,70 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interface", meta = (AllowPrivateAccess = "true"))
 	UWidgetComponent* GrappleWidget;
 
+	/** Keep the indicator widget of this point? The indicators are normally all drawn together on
+	 *  the HUD, so unless this is set the widget is emptied and hidden when the game starts, and the
+	 *  point does not tick since its Blueprint tick only drives the widget */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interface", meta = (AllowPrivateAccess = "true"))
+	bool bUseWidgetIndicator;
+
 	/** Popup widget for the grappling point indicator on screen */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interface", meta = (AllowPrivateAccess = "true"))
 	USceneComponent* RopeOffsetTransform; 
 
+	/** Id of the point, stable across sessions, used by the baked reachability data */
+	UPROPERTY(VisibleAnywhere, Category = "Grappling")
+	FGuid PointId;
+
+	/** Was the id given after the point was loaded, so its level has to be saved again to keep it? */
+	bool bPointIdUnsaved;
+
+	/** Index of this point in the grappling point registry, INDEX_NONE when not registered */
+	int32 RegistryIndex;
+
+	/** How much of the point is currently kept running */
+	EGrapplingPointLOD LOD;
+
+	/** Gives the point an id if it has none */
+	void EnsurePointId();
+
+	/** Keeps the registry entry of a movable point where the point is */
+	void OnPointMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
 public:
 
 	/** Is the player looking at this grappling point? */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Interface", meta = (AllowPrivateAccess = "true"))
 	bool bCharacterFocused;
 
+	/** Returns the hitbox of the grappling point, which the rope is thrown at */
+	FORCEINLINE USphereComponent* GetCollisionSphere() const { return CollisionSphere; }
+
+	/** Returns the id of the point */
+	FORCEINLINE const FGuid& GetPointId() const { return PointId; }
+
+	/** Returns the component the rope is attached at */
+	FORCEINLINE USceneComponent* GetRopeOffsetTransform() const { return RopeOffsetTransform; }
+
+	/** Returns the options of the point saved in the point table of its level */
+	EGrapplingPointFlags GetFlags() const;
+
+	/** Returns how much of the point is currently kept running */
+	FORCEINLINE EGrapplingPointLOD GetLOD() const { return LOD; }
+
+	/**
+	 * Switches the point to another LOD tier. Only active points tick and show their widget; visible
+	 * points draw their cheapest mesh LOD and dormant points are hidden. Every tier keeps its
+	 * collision, the grappling trace reaches past the tiers. Driven by the significance subsystem
+	 */
+	void SetLOD(EGrapplingPointLOD NewLOD);
+
 	/** Set the grappling point focused */
 	UFUNCTION(BlueprintCallable, Category = "Interface", meta = (AllowPrivateAccess = "true"))
 	void EnableFocused();
+
+	/** Set the grappling point not focused */
+	UFUNCTION(BlueprintCallable, Category = "Interface", meta = (AllowPrivateAccess = "true"))
+	void DisableFocused();
 	
 
 };
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingPointSetComponent.h"
+
+#include "GrapplingPoint.h"
+#include "GrapplingPointSubsystem.h"
+#include "Engine/World.h"
+
+FGrapplingPointTarget::FGrapplingPointTarget(AGrapplingPoint* InPoint)
+	: Point(InPoint)
+{
+}
+
+FGrapplingPointTarget::FGrapplingPointTarget(UGrapplingPointSetComponent* InPointSet, int32 InInstance)
+	: PointSet(InPointSet)
+	, Instance(InInstance)
+{
+}
+
+FGrapplingPointTarget FGrapplingPointTarget::FromEntry(const FGrapplingPointEntry& Entry)
+{
+	if(AGrapplingPoint* EntryPoint = Entry.Point.Get())
+	{
+		return FGrapplingPointTarget(EntryPoint);
+	}
+	if(UGrapplingPointSetComponent* EntryPointSet = Entry.PointSet.Get())
+	{
+		return FGrapplingPointTarget(EntryPointSet, Entry.Instance);
+	}
+	return FGrapplingPointTarget();
+}
+
+bool FGrapplingPointTarget::IsValid() const
+{
+	if(Point) return ::IsValid(Point);
+	return ::IsValid(PointSet) && PointSet->IsValidInstance(Instance);
+}
+
+FVector FGrapplingPointTarget::GetLocation() const
+{
+	if(Point) return Point->GetActorLocation();
+	return PointSet->GetPointLocation(Instance);
+}
+
+FGuid FGrapplingPointTarget::GetPointId() const
+{
+	if(Point) return Point->GetPointId();
+	return PointSet ? PointSet->GetPointId(Instance) : FGuid();
+}
+
+bool FGrapplingPointTarget::IsFocused() const
+{
+	if(Point) return Point->bCharacterFocused;
+	return PointSet && PointSet->IsInstanceFocused(Instance);
+}
+
+void FGrapplingPointTarget::SetFocused(bool bFocused) const
+{
+	if(Point)
+	{
+		bFocused ? Point->EnableFocused() : Point->DisableFocused();
+	}
+	else if(PointSet)
+	{
+		PointSet->SetInstanceFocused(Instance, bFocused);
+	}
+}
+
+UGrapplingPointSetComponent::UGrapplingPointSetComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	NumCustomDataFloats = 1;
+
+	// Only the grappling trace hits the points, they stay out of the way of everything else
+	SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	SetCollisionResponseToAllChannels(ECR_Ignore);
+	SetCollisionResponseToChannel(ECC_GameTraceChannel1, ECR_Block);
+	SetCanEverAffectNavigation(false);
+}
+
+void UGrapplingPointSetComponent::OnRegister()
+{
+	EnsureUniquePointIds(false);
+
+	// The instances are saved with the component, they only have to be built when the points were set from code
+	if(GetInstanceCount() != Points.Num())
+	{
+		RebuildInstances();
+	}
+
+	Super::OnRegister();
+}
+
+void UGrapplingPointSetComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FocusedInstances.Init(false, Points.Num());
+
+	// Every point goes in the registry, so target queries find them like point actors
+	UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>();
+	if(Registry)
+	{
+		Registry->RegisterPointSet(this, RegistryIndices);
+	}
+}
+
+void UGrapplingPointSetComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		Registry->UnregisterPointSet(RegistryIndices);
+	}
+	RegistryIndices.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if WITH_EDITOR
+void UGrapplingPointSetComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// Points added by duplicating another one in the details panel come with its id
+	if(PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UGrapplingPointSetComponent, Points)
+		|| PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UGrapplingPointSetComponent, Points))
+	{
+		EnsureUniquePointIds(false);
+		RebuildInstances();
+	}
+
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+
+void UGrapplingPointSetComponent::PostEditImport()
+{
+	Super::PostEditImport();
+
+	EnsureUniquePointIds(true);
+}
+#endif
+
+void UGrapplingPointSetComponent::RebuildInstances()
+{
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(Points.Num());
+	for(const FGrapplingPointInstance& Point : Points)
+	{
+		Transforms.Add(Point.Transform);
+	}
+
+	ClearInstances();
+	AddInstances(Transforms, false);
+	for(int32 Instance = 0; Instance < Points.Num(); Instance++)
+	{
+		SetCustomDataValue(Instance, 0, IsInstanceFocused(Instance) ? 1.f : 0.f);
+	}
+}
+
+FVector UGrapplingPointSetComponent::GetPointLocation(int32 Instance) const
+{
+	return GetComponentTransform().TransformPosition(Points[Instance].Transform.GetLocation());
+}
+
+FTransform UGrapplingPointSetComponent::GetRopeTransform(int32 Instance) const
+{
+	const FGrapplingPointInstance& Point = Points[Instance];
+	return Point.RopeOffset * Point.Transform * GetComponentTransform();
+}
+
+float UGrapplingPointSetComponent::GetPointRadius(int32 Instance) const
+{
+	const FGrapplingPointInstance& Point = Points[Instance];
+	return Point.Radius * (Point.Transform.GetScale3D() * GetComponentScale()).GetAbsMin();
+}
+
+int32 UGrapplingPointSetComponent::GetHitInstance(const FHitResult& Hit) const
+{
+	return Hit.GetComponent() == this && Points.IsValidIndex(Hit.Item) ? Hit.Item : INDEX_NONE;
+}
+
+bool UGrapplingPointSetComponent::IsInstanceFocused(int32 Instance) const
+{
+	return FocusedInstances.IsValidIndex(Instance) && FocusedInstances[Instance];
+}
+
+void UGrapplingPointSetComponent::SetInstanceFocused(int32 Instance, bool bFocused)
+{
+	if(!FocusedInstances.IsValidIndex(Instance) || FocusedInstances[Instance] == bFocused) return;
+
+	FocusedInstances[Instance] = bFocused;
+	SetCustomDataValue(Instance, 0, bFocused ? 1.f : 0.f, true);
+}
+
+void UGrapplingPointSetComponent::EnsureUniquePointIds(bool bRegenerateAll)
+{
+	TSet<FGuid> UsedIds;
+	UsedIds.Reserve(Points.Num());
+	for(FGrapplingPointInstance& Point : Points)
+	{
+		bool bAlreadyUsed = false;
+		if(Point.PointId.IsValid())
+		{
+			UsedIds.Add(Point.PointId, &bAlreadyUsed);
+		}
+		if(bRegenerateAll || !Point.PointId.IsValid() || bAlreadyUsed)
+		{
+			Point.PointId = FGuid::NewGuid();
+			UsedIds.Add(Point.PointId);
+		}
+	}
+}
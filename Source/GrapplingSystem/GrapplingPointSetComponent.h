@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingPointTable.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "GrapplingPointSetComponent.generated.h"
+
+class AGrapplingPoint;
+class UGrapplingPointSetComponent;
+struct FGrapplingPointEntry;
+
+/** A grappling point of a point set, kept as plain data */
+USTRUCT(BlueprintType)
+struct FGrapplingPointInstance
+{
+	GENERATED_BODY()
+
+	/** Transform of the point, relative to the set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling", meta = (MakeEditWidget = true))
+	FTransform Transform;
+
+	/** Transform the rope is attached at, relative to the point */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling")
+	FTransform RopeOffset;
+
+	/** Radius of the point hitbox */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling", meta = (ClampMin = "0.0"))
+	float Radius = 32.f;
+
+	/** Options of the point, as EGrapplingPointFlags */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling", meta = (Bitmask, BitmaskEnum = "EGrapplingPointFlags"))
+	uint8 Flags = 0;
+
+	/** Id of the point, stable across sessions, used by the baked reachability data */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grappling")
+	FGuid PointId;
+};
+
+/** A grappling point a character can aim at: a point actor, or an instance of a point set */
+USTRUCT()
+struct GRAPPLINGSYSTEM_API FGrapplingPointTarget
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	AGrapplingPoint* Point = nullptr;
+
+	UPROPERTY()
+	UGrapplingPointSetComponent* PointSet = nullptr;
+
+	/** Instance of the point in PointSet */
+	UPROPERTY()
+	int32 Instance = INDEX_NONE;
+
+	FGrapplingPointTarget() = default;
+
+	explicit FGrapplingPointTarget(AGrapplingPoint* InPoint);
+
+	FGrapplingPointTarget(UGrapplingPointSetComponent* InPointSet, int32 InInstance);
+
+	/** Target of a registry entry, invalid if the entry has neither an actor nor a point set */
+	static FGrapplingPointTarget FromEntry(const FGrapplingPointEntry& Entry);
+
+	/** Does the target still exist? */
+	bool IsValid() const;
+
+	/** World location of the point */
+	FVector GetLocation() const;
+
+	/** Id of the point, invalid if it has none */
+	FGuid GetPointId() const;
+
+	/** Is a character looking at the point? */
+	bool IsFocused() const;
+
+	void SetFocused(bool bFocused) const;
+
+	bool operator==(const FGrapplingPointTarget& Other) const
+	{
+		return Point == Other.Point && PointSet == Other.PointSet && Instance == Other.Instance;
+	}
+
+	bool operator!=(const FGrapplingPointTarget& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Many grappling points as plain data in a single component, drawn as the instances of one
+ * hierarchical instanced static mesh. A dense grappling field costs one actor and one draw
+ * batch rather than an actor, its components and its tick per point. The points are registered
+ * in the grappling point registry when the component begins play and are addressed by instance
+ * index. The set is expected not to move once in play.
+ * The instance custom data 0 is 1 for the points a character looks at, for materials to highlight them.
+ */
+UCLASS(ClassGroup = "Grappling", meta = (BlueprintSpawnableComponent))
+class GRAPPLINGSYSTEM_API UGrapplingPointSetComponent : public UHierarchicalInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingPointSetComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void OnRegister() override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	/** Called when the set is pasted or duplicated in the editor, the copies get their own ids */
+	virtual void PostEditImport() override;
+#endif
+
+	/** Points of the set */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grappling")
+	TArray<FGrapplingPointInstance> Points;
+
+	/** Recreates the mesh instances from the points, once the points were edited */
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Grappling")
+	void RebuildInstances();
+
+	int32 GetPointCount() const { return Points.Num(); }
+
+	bool IsValidInstance(int32 Instance) const { return Points.IsValidIndex(Instance); }
+
+	/** World location of a point */
+	FVector GetPointLocation(int32 Instance) const;
+
+	/** World transform the rope is attached at for a point */
+	FTransform GetRopeTransform(int32 Instance) const;
+
+	/** Radius of the hitbox of a point, in world space */
+	float GetPointRadius(int32 Instance) const;
+
+	const FGuid& GetPointId(int32 Instance) const { return Points[Instance].PointId; }
+
+	EGrapplingPointFlags GetPointFlags(int32 Instance) const { return EGrapplingPointFlags(Points[Instance].Flags); }
+
+	/** Returns the point a hit on the set was on, INDEX_NONE if there is none */
+	int32 GetHitInstance(const FHitResult& Hit) const;
+
+	/** Is a character looking at a point? */
+	bool IsInstanceFocused(int32 Instance) const;
+
+	/** Marks a point as looked at or not, and highlights it through the instance custom data */
+	void SetInstanceFocused(int32 Instance, bool bFocused);
+
+private:
+
+	/** Registry entry of every point, while in play */
+	TArray<int32> RegistryIndices;
+
+	/** Points a character looks at */
+	TBitArray<> FocusedInstances;
+
+	/** Gives an id to every point without one, and a new one to every point sharing its id */
+	void EnsureUniquePointIds(bool bRegenerateAll);
+};
@@ -0,0 +1,575 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingPointSubsystem.h"
+
+#include "ConvexVolume.h"
+#include "GrapplingPoint.h"
+#include "GrapplingPointSetComponent.h"
+
+namespace
+{
+	/** Sphere/cone intersection, conservative so that no touching sphere is ever rejected */
+	bool SphereTouchesCone(const FVector& Center, float Radius, const FVector& Origin, const FVector& Direction,
+	                       float SinHalfAngle, float CosHalfAngle, float MaxDistance)
+	{
+		const FVector ToCenter = Center - Origin;
+		const float Along = FVector::DotProduct(ToCenter, Direction);
+		if(Along < -Radius || Along > MaxDistance + Radius) return false;
+
+		const float Across = FMath::Sqrt(FMath::Max(ToCenter.SizeSquared() - Along * Along, 0.f));
+		return Across * CosHalfAngle - Along * SinHalfAngle <= Radius;
+	}
+
+	/** Box holding every sphere of radius up to Margin that SphereTouchesCone accepts */
+	FBox GetConeBounds(const FVector& Origin, const FVector& Direction, float SinHalfAngle, float CosHalfAngle,
+	                   float MaxDistance, float Margin)
+	{
+		// The cone is the hull of its apex and of its end cap, pushed out by the margin. Very wide
+		// cones get a huge cap, and are walked through the occupied cells anyway
+		const float CapDistance = MaxDistance + Margin;
+		const float CapRadius = FMath::Min(CapDistance * SinHalfAngle / FMath::Max(CosHalfAngle, 0.01f) + Margin / FMath::Max(CosHalfAngle, 0.01f), 1e7f);
+		const FVector CapCenter = Origin + Direction * CapDistance;
+		const FVector CapExtent(
+			CapRadius * FMath::Sqrt(FMath::Max(1.f - Direction.X * Direction.X, 0.f)),
+			CapRadius * FMath::Sqrt(FMath::Max(1.f - Direction.Y * Direction.Y, 0.f)),
+			CapRadius * FMath::Sqrt(FMath::Max(1.f - Direction.Z * Direction.Z, 0.f)));
+
+		FBox Bounds(Origin, Origin);
+		Bounds += CapCenter - CapExtent;
+		Bounds += CapCenter + CapExtent;
+		return Bounds.ExpandBy(Margin);
+	}
+}
+
+UGrapplingPointSubsystem::UGrapplingPointSubsystem()
+{
+	CellSize = 2000.f;
+}
+
+void UGrapplingPointSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	Cells.Empty();
+	PointX.Empty();
+	PointY.Empty();
+	PointZ.Empty();
+	DenseEntries.Empty();
+	PointIndices.Empty();
+	LevelTables.Empty();
+	ReachabilityGraphs.Empty();
+	MaxPointRadius = 0.f;
+	Super::Deinitialize();
+}
+
+int32 UGrapplingPointSubsystem::RegisterPoint(AGrapplingPoint* Point, const FVector& Location, float Radius)
+{
+	const FGuid& PointId = Point->GetPointId();
+	const int32 TableIndex = FindPoint(PointId);
+	if(TableIndex != INDEX_NONE && !Entries[TableIndex].Point.IsValid())
+	{
+		// Already known from the table of its level, the actor only has to claim it
+		FGrapplingPointEntry& Entry = Entries[TableIndex];
+		Entry.Point = Point;
+		Entry.Radius = Radius;
+		MaxPointRadius = FMath::Max(MaxPointRadius, Radius);
+		UpdatePointLocation(TableIndex, Location);
+		return TableIndex;
+	}
+
+	FGrapplingPointEntry Entry;
+	Entry.Point = Point;
+	Entry.Location = Location;
+	Entry.Radius = Radius;
+	Entry.RopeOffset = Point->GetRopeOffsetTransform()->GetComponentTransform();
+	Entry.Flags = Point->GetFlags();
+
+	// Copies sharing an id cannot be told apart by it, only the first one is found by id
+	if(TableIndex == INDEX_NONE)
+	{
+		Entry.PointId = PointId;
+	}
+	return AddEntry(Entry);
+}
+
+void UGrapplingPointSubsystem::UnregisterPoint(int32 Index)
+{
+	if(!Entries.IsValidIndex(Index)) return;
+
+	// Points of a visible level stay queryable without their actor, until the table goes away
+	if(Entries[Index].bFromTable)
+	{
+		Entries[Index].Point = nullptr;
+		Version++;
+		return;
+	}
+	RemoveEntry(Index);
+}
+
+void UGrapplingPointSubsystem::RegisterPointSet(UGrapplingPointSetComponent* PointSet, TArray<int32>& OutIndices)
+{
+	const int32 PointCount = PointSet->GetPointCount();
+	OutIndices.Reset(PointCount);
+	Entries.Reserve(Entries.Num() + PointCount);
+	PointIndices.Reserve(PointIndices.Num() + PointCount);
+
+	for(int32 Instance = 0; Instance < PointCount; Instance++)
+	{
+		FGrapplingPointEntry Entry;
+		Entry.PointSet = PointSet;
+		Entry.Instance = Instance;
+		Entry.Location = PointSet->GetPointLocation(Instance);
+		Entry.Radius = PointSet->GetPointRadius(Instance);
+		Entry.RopeOffset = PointSet->GetRopeTransform(Instance);
+		Entry.Flags = PointSet->GetPointFlags(Instance);
+
+		// Same rule as the actors: a copy sharing an id is only found through the first one
+		const FGuid& PointId = PointSet->GetPointId(Instance);
+		if(FindPoint(PointId) == INDEX_NONE)
+		{
+			Entry.PointId = PointId;
+		}
+		OutIndices.Add(AddEntry(Entry));
+	}
+}
+
+void UGrapplingPointSubsystem::UnregisterPointSet(const TArray<int32>& Indices)
+{
+	for(const int32 Index : Indices)
+	{
+		if(Entries.IsValidIndex(Index))
+		{
+			RemoveEntry(Index);
+		}
+	}
+}
+
+void UGrapplingPointSubsystem::AddPointTable(const ULevel* Level, const TArray<FGrapplingPointRecord>& Records)
+{
+	RemovePointTable(Level);
+
+	TArray<int32>& TableEntries = LevelTables.Add(Level);
+	TableEntries.Reserve(Records.Num());
+	Entries.Reserve(Entries.Num() + Records.Num());
+	PointIndices.Reserve(PointIndices.Num() + Records.Num());
+
+	for(const FGrapplingPointRecord& Record : Records)
+	{
+		// Tables saved before every point had an id may hold records their actor cannot be matched
+		// with, the actor registers that point itself
+		if(!Record.PointId.IsValid()) continue;
+
+		// The actor may have begun play first, keep its entry and let it outlive the actor
+		int32 Index = FindPoint(Record.PointId);
+		if(Index == INDEX_NONE)
+		{
+			FGrapplingPointEntry Entry;
+			Entry.PointId = Record.PointId;
+			Entry.Location = Record.Location;
+			Entry.Radius = Record.Radius;
+			Entry.RopeOffset = Record.RopeOffset;
+			Entry.Flags = EGrapplingPointFlags(Record.Flags);
+			Index = AddEntry(Entry);
+		}
+		else if(Entries[Index].bFromTable)
+		{
+			// Copies sharing an id are found through the first one only, which is already in a table
+			continue;
+		}
+		Entries[Index].bFromTable = true;
+		TableEntries.Add(Index);
+	}
+}
+
+void UGrapplingPointSubsystem::RemovePointTable(const ULevel* Level)
+{
+	TArray<int32> TableEntries;
+	if(!LevelTables.RemoveAndCopyValue(Level, TableEntries)) return;
+
+	for(const int32 Index : TableEntries)
+	{
+		// Actors still in play remove their entry themselves when they end play
+		FGrapplingPointEntry& Entry = Entries[Index];
+		Entry.bFromTable = false;
+		if(!Entry.Point.IsValid())
+		{
+			RemoveEntry(Index);
+		}
+	}
+}
+
+int32 UGrapplingPointSubsystem::FindPoint(const FGuid& PointId) const
+{
+	const int32* Index = PointId.IsValid() ? PointIndices.Find(PointId) : nullptr;
+	return Index ? *Index : INDEX_NONE;
+}
+
+void UGrapplingPointSubsystem::UpdatePointLocation(int32 Index, const FVector& NewLocation)
+{
+	if(!Entries.IsValidIndex(Index)) return;
+
+	FGrapplingPointEntry& Entry = Entries[Index];
+	Entry.Location = NewLocation;
+	SetDenseLocation(Entry.DenseIndex, NewLocation);
+	Version++;
+
+	const FIntVector NewCell = GetCell(NewLocation);
+	if(NewCell != Entry.Cell)
+	{
+		RemoveFromCell(Index, Entry.Cell);
+		AddToCell(Index, NewCell);
+		Entry.Cell = NewCell;
+	}
+}
+
+void UGrapplingPointSubsystem::QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+	ForEachEntryNearSphere(Origin, Radius, [&](int32 Index, const FGrapplingPointEntry& Entry)
+	{
+		if(FVector::DistSquared(Entry.Location, Origin) <= Radius * Radius)
+		{
+			OutIndices.Add(Index);
+		}
+		return true;
+	});
+}
+
+void UGrapplingPointSubsystem::QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngleRadians,
+                                         float MaxDistance, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	float SinHalfAngle, CosHalfAngle;
+	FMath::SinCos(&SinHalfAngle, &CosHalfAngle, HalfAngleRadians);
+	// A point stored in a cell may reach out of it by its radius
+	const float CellRadius = CellSize * HALF_SQRT_3 + MaxPointRadius;
+
+	ForEachEntryInBounds(GetConeBounds(Origin, Direction, SinHalfAngle, CosHalfAngle, MaxDistance, MaxPointRadius),
+		[&](const FIntVector& Cell)
+		{
+			const FVector CellCenter = (FVector(Cell) + 0.5f) * CellSize;
+			return SphereTouchesCone(CellCenter, CellRadius, Origin, Direction, SinHalfAngle, CosHalfAngle, MaxDistance);
+		},
+		[&](int32 Index, const FGrapplingPointEntry& Entry)
+		{
+			if(SphereTouchesCone(Entry.Location, Entry.Radius, Origin, Direction, SinHalfAngle, CosHalfAngle, MaxDistance))
+			{
+				OutIndices.Add(Index);
+			}
+			return true;
+		});
+}
+
+bool UGrapplingPointSubsystem::HasPointInCone(const FVector& Origin, const FVector& Direction, float HalfAngleRadians,
+                                              float MaxDistance) const
+{
+	float SinHalfAngle, CosHalfAngle;
+	FMath::SinCos(&SinHalfAngle, &CosHalfAngle, HalfAngleRadians);
+	// A point stored in a cell may reach out of it by its radius
+	const float CellRadius = CellSize * HALF_SQRT_3 + MaxPointRadius;
+
+	bool bFound = false;
+	ForEachEntryInBounds(GetConeBounds(Origin, Direction, SinHalfAngle, CosHalfAngle, MaxDistance, MaxPointRadius),
+		[&](const FIntVector& Cell)
+		{
+			const FVector CellCenter = (FVector(Cell) + 0.5f) * CellSize;
+			return SphereTouchesCone(CellCenter, CellRadius, Origin, Direction, SinHalfAngle, CosHalfAngle, MaxDistance);
+		},
+		[&](int32 Index, const FGrapplingPointEntry& Entry)
+		{
+			bFound = SphereTouchesCone(Entry.Location, Entry.Radius, Origin, Direction, SinHalfAngle, CosHalfAngle, MaxDistance);
+			return !bFound;
+		});
+	return bFound;
+}
+
+void UGrapplingPointSubsystem::QueryFrustum(const FConvexVolume& Frustum, const FVector& ViewOrigin, float MaxDistance,
+                                            TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	// View frustums usually have no far plane, the distance bounds the cells to walk instead
+	const FVector CellExtent(CellSize * 0.5f + MaxPointRadius);
+	ForEachEntryInBounds(FBox::BuildAABB(ViewOrigin, FVector(MaxDistance + MaxPointRadius)),
+		[&](const FIntVector& Cell)
+		{
+			return Frustum.IntersectBox((FVector(Cell) + 0.5f) * CellSize, CellExtent);
+		},
+		[&](int32 Index, const FGrapplingPointEntry& Entry)
+		{
+			if(Frustum.IntersectSphere(Entry.Location, Entry.Radius))
+			{
+				OutIndices.Add(Index);
+			}
+			return true;
+		});
+}
+
+void UGrapplingPointSubsystem::QueryNearest(const FVector& Origin, int32 K, float MaxDistance, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+	if(K <= 0 || Entries.Num() == 0) return;
+
+	// Grow the search radius until it holds at least K points: the K nearest are then all inside it
+	float Radius = FMath::Min(CellSize, MaxDistance);
+	while(true)
+	{
+		QueryRadius(Origin, Radius, OutIndices);
+		if(OutIndices.Num() >= K || Radius >= MaxDistance) break;
+		Radius = FMath::Min(Radius * 2.f, MaxDistance);
+	}
+
+	OutIndices.Sort([this, &Origin](int32 A, int32 B)
+	{
+		return FVector::DistSquared(Entries[A].Location, Origin) < FVector::DistSquared(Entries[B].Location, Origin);
+	});
+	if(OutIndices.Num() > K)
+	{
+		OutIndices.SetNum(K, false);
+	}
+}
+
+int32 UGrapplingPointSubsystem::FindBestInCone(const FVector& Origin, const FVector& Direction, float HalfAngleRadians,
+                                               float MaxDistance, float AngleWeight, float DistanceWeight) const
+{
+	const float CosHalfAngle = FMath::Cos(HalfAngleRadians);
+
+	const VectorRegister OriginX = VectorSetFloat1(Origin.X);
+	const VectorRegister OriginY = VectorSetFloat1(Origin.Y);
+	const VectorRegister OriginZ = VectorSetFloat1(Origin.Z);
+	const VectorRegister DirectionX = VectorSetFloat1(Direction.X);
+	const VectorRegister DirectionY = VectorSetFloat1(Direction.Y);
+	const VectorRegister DirectionZ = VectorSetFloat1(Direction.Z);
+	const VectorRegister CosHalf = VectorSetFloat1(CosHalfAngle);
+	const VectorRegister MaxDist = VectorSetFloat1(MaxDistance);
+	const VectorRegister One = VectorSetFloat1(1.f);
+	const VectorRegister Rejected = VectorSetFloat1(-1.f);
+
+	// Both terms are mapped to [0, 1]: 1 on the cone axis and at Origin, 0 on the cone edge and at MaxDistance
+	const VectorRegister AngleScale = VectorSetFloat1(AngleWeight / FMath::Max(1.f - CosHalfAngle, KINDA_SMALL_NUMBER));
+	const VectorRegister DistanceScale = VectorSetFloat1(DistanceWeight / FMath::Max(MaxDistance, KINDA_SMALL_NUMBER));
+	const VectorRegister DistanceBias = VectorSetFloat1(DistanceWeight);
+
+	float BestScore = -1.f;
+	int32 BestIndex = INDEX_NONE;
+	const int32 Count = DenseEntries.Num();
+	for(int32 i = 0; i < Count; i += 4)
+	{
+		const VectorRegister ToX = VectorSubtract(VectorLoad(&PointX[i]), OriginX);
+		const VectorRegister ToY = VectorSubtract(VectorLoad(&PointY[i]), OriginY);
+		const VectorRegister ToZ = VectorSubtract(VectorLoad(&PointZ[i]), OriginZ);
+
+		const VectorRegister Along = VectorMultiplyAdd(ToZ, DirectionZ, VectorMultiplyAdd(ToY, DirectionY, VectorMultiply(ToX, DirectionX)));
+		const VectorRegister DistSquared = VectorMax(VectorMultiplyAdd(ToZ, ToZ, VectorMultiplyAdd(ToY, ToY, VectorMultiply(ToX, ToX))), One);
+		const VectorRegister InvDist = VectorReciprocalSqrtAccurate(DistSquared);
+		const VectorRegister Cos = VectorMultiply(Along, InvDist);
+		const VectorRegister Dist = VectorMultiply(DistSquared, InvDist);
+
+		const VectorRegister AngleScore = VectorMultiply(VectorSubtract(Cos, CosHalf), AngleScale);
+		const VectorRegister DistanceScore = VectorSubtract(DistanceBias, VectorMultiply(Dist, DistanceScale));
+		const VectorRegister Inside = VectorBitwiseAnd(VectorCompareGE(Cos, CosHalf), VectorCompareLE(Dist, MaxDist));
+		const VectorRegister Score = VectorSelect(Inside, VectorAdd(AngleScore, DistanceScore), Rejected);
+
+		float Scores[4];
+		VectorStore(Score, Scores);
+		const int32 LaneCount = FMath::Min(Count - i, 4);
+		for(int32 Lane = 0; Lane < LaneCount; Lane++)
+		{
+			// Only candidates that beat the best so far are looked up, so the entries are rarely touched
+			if(Scores[Lane] > BestScore && Entries[DenseEntries[i + Lane]].IsInPlay())
+			{
+				BestScore = Scores[Lane];
+				BestIndex = DenseEntries[i + Lane];
+			}
+		}
+	}
+	return BestIndex;
+}
+
+AGrapplingPoint* UGrapplingPointSubsystem::GetPoint(int32 Index) const
+{
+	return Entries.IsValidIndex(Index) ? Entries[Index].Point.Get() : nullptr;
+}
+
+void UGrapplingPointSubsystem::AddReachabilityGraph(UGrappleReachabilityGraph* Graph)
+{
+	if(Graph) ReachabilityGraphs.AddUnique(Graph);
+}
+
+void UGrapplingPointSubsystem::RemoveReachabilityGraph(UGrappleReachabilityGraph* Graph)
+{
+	ReachabilityGraphs.RemoveSingleSwap(Graph, false);
+}
+
+EGrappleReachability UGrapplingPointSubsystem::GetReachability(const FGuid& From, const FGuid& To) const
+{
+	for(const UGrappleReachabilityGraph* Graph : ReachabilityGraphs)
+	{
+		const EGrappleReachability Reachability = Graph->GetReachability(From, To);
+		if(Reachability != EGrappleReachability::Unknown) return Reachability;
+	}
+	return EGrappleReachability::Unknown;
+}
+
+TArray<AGrapplingPoint*> UGrapplingPointSubsystem::GetPointsInRadius(FVector Origin, float Radius) const
+{
+	TArray<int32> Indices;
+	QueryRadius(Origin, Radius, Indices);
+
+	TArray<AGrapplingPoint*> Points;
+	for(const int32 Index : Indices)
+	{
+		if(AGrapplingPoint* Point = GetPoint(Index)) Points.Add(Point);
+	}
+	return Points;
+}
+
+TArray<AGrapplingPoint*> UGrapplingPointSubsystem::GetNearestPoints(FVector Origin, int32 K, float MaxDistance) const
+{
+	TArray<int32> Indices;
+	QueryNearest(Origin, K, MaxDistance, Indices);
+
+	TArray<AGrapplingPoint*> Points;
+	for(const int32 Index : Indices)
+	{
+		if(AGrapplingPoint* Point = GetPoint(Index)) Points.Add(Point);
+	}
+	return Points;
+}
+
+FIntVector UGrapplingPointSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
+
+int32 UGrapplingPointSubsystem::AddEntry(const FGrapplingPointEntry& Entry)
+{
+	const int32 Index = Entries.Add(Entry);
+	MaxPointRadius = FMath::Max(MaxPointRadius, Entry.Radius);
+	Entries[Index].Cell = GetCell(Entry.Location);
+	AddToCell(Index, Entries[Index].Cell);
+
+	const int32 DenseIndex = DenseEntries.Add(Index);
+	ResizeDenseArrays(DenseEntries.Num());
+	SetDenseLocation(DenseIndex, Entry.Location);
+	Entries[Index].DenseIndex = DenseIndex;
+	Version++;
+	if(Entry.PointId.IsValid())
+	{
+		PointIndices.Add(Entry.PointId, Index);
+	}
+	return Index;
+}
+
+void UGrapplingPointSubsystem::RemoveEntry(int32 Index)
+{
+	const FGrapplingPointEntry& Entry = Entries[Index];
+	RemoveFromCell(Index, Entry.Cell);
+	if(Entry.PointId.IsValid())
+	{
+		PointIndices.Remove(Entry.PointId);
+	}
+
+	// Keep the dense arrays packed by moving the last point into the freed slot
+	const int32 LastDenseIndex = DenseEntries.Num() - 1;
+	if(Entry.DenseIndex != LastDenseIndex)
+	{
+		const int32 MovedIndex = DenseEntries[LastDenseIndex];
+		DenseEntries[Entry.DenseIndex] = MovedIndex;
+		Entries[MovedIndex].DenseIndex = Entry.DenseIndex;
+		SetDenseLocation(Entry.DenseIndex, Entries[MovedIndex].Location);
+	}
+	SetDenseLocation(LastDenseIndex, FVector::ZeroVector);
+	DenseEntries.RemoveAt(LastDenseIndex, 1, false);
+	ResizeDenseArrays(DenseEntries.Num());
+
+	Entries.RemoveAt(Index);
+	Version++;
+}
+
+void UGrapplingPointSubsystem::ResizeDenseArrays(int32 Count)
+{
+	// The padding slots are zeroed and never selected, they only keep the vector loops in bounds
+	const int32 PaddedCount = Align(Count, 4);
+	for(TArray<float>* Array : {&PointX, &PointY, &PointZ})
+	{
+		Array->SetNumZeroed(PaddedCount, false);
+	}
+}
+
+void UGrapplingPointSubsystem::SetDenseLocation(int32 DenseIndex, const FVector& Location)
+{
+	PointX[DenseIndex] = Location.X;
+	PointY[DenseIndex] = Location.Y;
+	PointZ[DenseIndex] = Location.Z;
+}
+
+void UGrapplingPointSubsystem::AddToCell(int32 Index, const FIntVector& Cell)
+{
+	Cells.FindOrAdd(Cell).Add(Index);
+}
+
+void UGrapplingPointSubsystem::RemoveFromCell(int32 Index, const FIntVector& Cell)
+{
+	if(TArray<int32>* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveSingleSwap(Index, false);
+		if(CellEntries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+template <typename FunctorType>
+void UGrapplingPointSubsystem::ForEachEntryNearSphere(const FVector& Center, float Radius, FunctorType&& Functor) const
+{
+	ForEachEntryInBounds(FBox::BuildAABB(Center, FVector(Radius)), [](const FIntVector&) { return true; }, Functor);
+}
+
+template <typename CellFilterType, typename FunctorType>
+void UGrapplingPointSubsystem::ForEachEntryInBounds(const FBox& Bounds, CellFilterType&& CellFilter, FunctorType&& Functor) const
+{
+	const FIntVector Min = GetCell(Bounds.Min);
+	const FIntVector Max = GetCell(Bounds.Max);
+	const int64 CellSpan = int64(Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1);
+
+	// Large ranges cover more cells than are occupied, walk the occupied ones instead
+	if(CellSpan > Cells.Num())
+	{
+		for(const TPair<FIntVector, TArray<int32>>& Cell : Cells)
+		{
+			const FIntVector& Key = Cell.Key;
+			if(Key.X < Min.X || Key.X > Max.X || Key.Y < Min.Y || Key.Y > Max.Y || Key.Z < Min.Z || Key.Z > Max.Z) continue;
+			if(!CellFilter(Key)) continue;
+
+			for(const int32 Index : Cell.Value)
+			{
+				if(!Functor(Index, Entries[Index])) return;
+			}
+		}
+		return;
+	}
+
+	for(int32 X = Min.X; X <= Max.X; X++)
+	{
+		for(int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			for(int32 Z = Min.Z; Z <= Max.Z; Z++)
+			{
+				const FIntVector Cell(X, Y, Z);
+				const TArray<int32>* CellEntries = Cells.Find(Cell);
+				if(!CellEntries || !CellFilter(Cell)) continue;
+
+				for(const int32 Index : *CellEntries)
+				{
+					if(!Functor(Index, Entries[Index])) return;
+				}
+			}
+		}
+	}
+}
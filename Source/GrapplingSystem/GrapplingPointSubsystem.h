@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrappleReachabilityGraph.h"
+#include "GrapplingPointTable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingPointSubsystem.generated.h"
+
+class AGrapplingPoint;
+class UGrapplingPointSetComponent;
+class ULevel;
+struct FConvexVolume;
+
+/** A grappling point as seen by the registry */
+struct FGrapplingPointEntry
+{
+	/** Actor of the point, null while a point from a level table has no actor yet */
+	TWeakObjectPtr<AGrapplingPoint> Point;
+
+	/** Point set holding the point when it is an instance rather than an actor */
+	TWeakObjectPtr<UGrapplingPointSetComponent> PointSet;
+
+	/** Instance of the point in PointSet */
+	int32 Instance = INDEX_NONE;
+
+	/** Id of the point, invalid for points registered without one */
+	FGuid PointId;
+
+	/** World location of the point */
+	FVector Location;
+
+	/** Radius of the point hitbox, used to make cone queries as forgiving as the old sweep */
+	float Radius;
+
+	/** World transform the rope is attached at */
+	FTransform RopeOffset;
+
+	EGrapplingPointFlags Flags = EGrapplingPointFlags::None;
+
+	/** Spatial hash cell the point is stored in */
+	FIntVector Cell;
+
+	/** Slot of the point in the dense location arrays */
+	int32 DenseIndex = INDEX_NONE;
+
+	/** Does the entry come from a level point table? It then outlives its actor */
+	bool bFromTable = false;
+
+	/** Does the point have an actor or a point set in play, so it can be grappled? */
+	bool IsInPlay() const { return Point.IsValid() || PointSet.IsValid(); }
+};
+
+/**
+ * Keeps every grappling point of the world in a uniform spatial hash, so characters, AI and
+ * server code can find candidates without querying the physics scene.
+ * Entry indices are stable for as long as the point stays registered.
+ */
+UCLASS(config=Game)
+class GRAPPLINGSYSTEM_API UGrapplingPointSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingPointSubsystem();
+
+	virtual void Deinitialize() override;
+
+	/** Adds a point to the registry and returns its entry index. A point already merged from
+	 *  the table of its level is bound to its existing entry instead */
+	int32 RegisterPoint(AGrapplingPoint* Point, const FVector& Location, float Radius);
+
+	/** Removes a point previously returned by RegisterPoint, or unbinds it from its table entry */
+	void UnregisterPoint(int32 Index);
+
+	/** Adds every point of a point set to the registry, OutIndices receives their entry index by instance */
+	void RegisterPointSet(UGrapplingPointSetComponent* PointSet, TArray<int32>& OutIndices);
+
+	/** Removes the points previously added by RegisterPointSet */
+	void UnregisterPointSet(const TArray<int32>& Indices);
+
+	/** Merges the point table of a level, replacing the one previously merged for it */
+	void AddPointTable(const ULevel* Level, const TArray<FGrapplingPointRecord>& Records);
+
+	/** Removes the points merged from the table of a level */
+	void RemovePointTable(const ULevel* Level);
+
+	/** Returns the entry index of a point, INDEX_NONE if it is not registered */
+	int32 FindPoint(const FGuid& PointId) const;
+
+	/** Moves a registered point, rehashing it if it changed cell */
+	void UpdatePointLocation(int32 Index, const FVector& NewLocation);
+
+	/** Finds every point within Radius of Origin */
+	void QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIndices) const;
+
+	/** Finds every point whose hitbox touches the cone. A half angle of 0 makes it a ray query */
+	void QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngleRadians, float MaxDistance, TArray<int32>& OutIndices) const;
+
+	/** Returns true as soon as any point touches the cone */
+	bool HasPointInCone(const FVector& Origin, const FVector& Direction, float HalfAngleRadians, float MaxDistance) const;
+
+	/** Finds every point whose hitbox is inside the frustum, up to MaxDistance from ViewOrigin */
+	void QueryFrustum(const FConvexVolume& Frustum, const FVector& ViewOrigin, float MaxDistance, TArray<int32>& OutIndices) const;
+
+	/** Finds the K points closest to Origin, sorted by distance */
+	void QueryNearest(const FVector& Origin, int32 K, float MaxDistance, TArray<int32>& OutIndices) const;
+
+	/**
+	 * Scores every point inside the cone by how close it is to the cone axis and to Origin, and
+	 * returns the entry index of the best one in play, INDEX_NONE if there is none.
+	 * Runs over the dense location arrays four points at a time, without touching the spatial hash.
+	 */
+	int32 FindBestInCone(const FVector& Origin, const FVector& Direction, float HalfAngleRadians, float MaxDistance,
+	                     float AngleWeight, float DistanceWeight) const;
+
+	/** Returns the registry entry at Index */
+	const FGrapplingPointEntry& GetEntry(int32 Index) const { return Entries[Index]; }
+
+	/** Returns the actor of a registry entry, null if it is gone */
+	AGrapplingPoint* GetPoint(int32 Index) const;
+
+	/** Number of registered points */
+	int32 Num() const { return Entries.Num(); }
+
+	/** Incremented every time a point is added, removed, moved or loses its actor */
+	uint32 GetVersion() const { return Version; }
+
+	/** Makes the baked reachability of a level available to GetReachability */
+	void AddReachabilityGraph(UGrappleReachabilityGraph* Graph);
+
+	void RemoveReachabilityGraph(UGrappleReachabilityGraph* Graph);
+
+	/** Baked result of a leap between two points, from the graph of the level that holds both */
+	EGrappleReachability GetReachability(const FGuid& From, const FGuid& To) const;
+
+	/** Baked reachability graphs of the loaded levels */
+	const TArray<UGrappleReachabilityGraph*>& GetReachabilityGraphs() const { return ReachabilityGraphs; }
+
+	/** Finds the grappling points within Radius of Origin */
+	UFUNCTION(BlueprintCallable, Category = "Grappling")
+	TArray<AGrapplingPoint*> GetPointsInRadius(FVector Origin, float Radius) const;
+
+	/** Finds the K grappling points closest to Origin */
+	UFUNCTION(BlueprintCallable, Category = "Grappling")
+	TArray<AGrapplingPoint*> GetNearestPoints(FVector Origin, int32 K, float MaxDistance = 50000.f) const;
+
+protected:
+
+	/** Size of a spatial hash cell, in unreal units */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float CellSize;
+
+	/** Registered points, a sparse array keeps the indices stable on removal */
+	TSparseArray<FGrapplingPointEntry> Entries;
+
+	/** Spatial hash, maps each occupied cell to the entries it contains */
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	/** Point locations as structure of arrays, padded to a multiple of four for the vector loops */
+	TArray<float> PointX;
+	TArray<float> PointY;
+	TArray<float> PointZ;
+
+	/** Entry index of every slot of the dense location arrays */
+	TArray<int32> DenseEntries;
+
+	uint32 Version = 0;
+
+	/** Largest hitbox radius registered, the margin cell ranges are grown by so no touching point is missed */
+	float MaxPointRadius = 0.f;
+
+	/** Entry index of every point with an id */
+	TMap<FGuid, int32> PointIndices;
+
+	/** Entries merged from the table of each level */
+	TMap<TObjectKey<ULevel>, TArray<int32>> LevelTables;
+
+	UPROPERTY()
+	TArray<UGrappleReachabilityGraph*> ReachabilityGraphs;
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	int32 AddEntry(const FGrapplingPointEntry& Entry);
+
+	void RemoveEntry(int32 Index);
+
+	/** Resizes the dense location arrays to hold Count points, keeping the padding */
+	void ResizeDenseArrays(int32 Count);
+
+	void SetDenseLocation(int32 DenseIndex, const FVector& Location);
+
+	void AddToCell(int32 Index, const FIntVector& Cell);
+
+	void RemoveFromCell(int32 Index, const FIntVector& Cell);
+
+	/** Visits every entry whose cell may touch the given sphere */
+	template <typename FunctorType>
+	void ForEachEntryNearSphere(const FVector& Center, float Radius, FunctorType&& Functor) const;
+
+	/**
+	 * Visits every entry of the cells overlapping Bounds that the cell filter accepts. Walks the cells
+	 * of the range, or the occupied cells when the range spans more cells than are occupied
+	 */
+	template <typename CellFilterType, typename FunctorType>
+	void ForEachEntryInBounds(const FBox& Bounds, CellFilterType&& CellFilter, FunctorType&& Functor) const;
+};
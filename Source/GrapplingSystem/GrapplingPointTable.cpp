@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingPointTable.h"
+
+#include "GrapplingPoint.h"
+#include "GrapplingPointSubsystem.h"
+#include "GrapplingSystem.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+
+AGrapplingPointTable::AGrapplingPointTable()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	bMerged = false;
+}
+
+void AGrapplingPointTable::BuildTable()
+{
+	Points.Reset();
+
+	// Walk the level itself rather than the world, which is not initialized when cooking
+	for(const AActor* Actor : GetLevel()->Actors)
+	{
+		// Points without an id could not be matched with their actor, which would be registered a second time
+		const AGrapplingPoint* Point = Cast<AGrapplingPoint>(Actor);
+		if(!Point || Point->IsPendingKill() || !Point->GetPointId().IsValid()) continue;
+
+		FGrapplingPointRecord& Record = Points.AddDefaulted_GetRef();
+		Record.PointId = Point->GetPointId();
+		Record.Location = Point->GetActorLocation();
+		Record.Radius = Point->GetCollisionSphere()->GetScaledSphereRadius();
+		Record.RopeOffset = Point->GetRopeOffsetTransform()->GetComponentTransform();
+		Record.Flags = uint8(Point->GetFlags());
+	}
+
+	// Keep the saved order stable so rebuilding an unchanged level does not dirty it
+	Points.Sort([](const FGrapplingPointRecord& A, const FGrapplingPointRecord& B)
+	{
+		return A.PointId < B.PointId;
+	});
+}
+
+void AGrapplingPointTable::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	// Levels register their components over several frames while streaming in, before any of
+	// their actors begins play: merging here makes the points queryable from the start
+	UWorld* World = GetWorld();
+	if(bMerged || !World || !World->IsGameWorld()) return;
+
+	if(UGrapplingPointSubsystem* Registry = World->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		Registry->AddPointTable(GetLevel(), Points);
+		bMerged = true;
+	}
+}
+
+void AGrapplingPointTable::PostUnregisterAllComponents()
+{
+	if(bMerged)
+	{
+		if(UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+		{
+			Registry->RemovePointTable(GetLevel());
+		}
+		bMerged = false;
+	}
+
+	Super::PostUnregisterAllComponents();
+}
+
+#if WITH_EDITOR
+void AGrapplingPointTable::RebuildTable()
+{
+	Modify();
+	BuildTable();
+	UE_LOG(LogGrappling, Display, TEXT("%s: %d points"), *GetPathName(), Points.Num());
+}
+
+void AGrapplingPointTable::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	// Saving and cooking always go through here, so the table cannot fall behind the level
+	if(GetLevel() && !(GetWorld() && GetWorld()->IsGameWorld()))
+	{
+		BuildTable();
+	}
+}
+#endif
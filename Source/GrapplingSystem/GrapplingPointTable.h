@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GrapplingPointTable.generated.h"
+
+class AGrapplingPoint;
+
+/** Options of a grappling point that matter before its actor is loaded */
+UENUM(meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EGrapplingPointFlags : uint8
+{
+	None = 0 UMETA(Hidden),
+
+	/** The point keeps its own indicator widget instead of the HUD indicator */
+	WidgetIndicator = 1 << 0
+};
+ENUM_CLASS_FLAGS(EGrapplingPointFlags);
+
+/** A grappling point as saved in the point table of its level */
+USTRUCT()
+struct FGrapplingPointRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Grappling")
+	FGuid PointId;
+
+	/** World location of the point */
+	UPROPERTY(VisibleAnywhere, Category = "Grappling")
+	FVector Location = FVector::ZeroVector;
+
+	/** Radius of the point hitbox */
+	UPROPERTY(VisibleAnywhere, Category = "Grappling")
+	float Radius = 0.f;
+
+	/** World transform the rope is attached at */
+	UPROPERTY(VisibleAnywhere, Category = "Grappling")
+	FTransform RopeOffset;
+
+	UPROPERTY(VisibleAnywhere, Category = "Grappling", meta = (Bitmask, BitmaskEnum = "EGrapplingPointFlags"))
+	uint8 Flags = 0;
+};
+
+/**
+ * Table of the grappling points of its level, saved and cooked with the level. Place one per level.
+ * The table is merged into the grappling point registry as soon as the level starts registering
+ * its components, so its points can be queried before their actors are ready, and taken out when
+ * the level is hidden. Point actors then only bind to their existing registry entry, matched by
+ * id: points without one are left out of the table and register on their own.
+ * The actors are still loaded and register their components like any other actor, the table only
+ * saves them adding their entries one by one and makes their points available earlier.
+ * The table is rebuilt whenever the level is saved or cooked.
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API AGrapplingPointTable : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AGrapplingPointTable();
+
+	/** Points of the level */
+	UPROPERTY(VisibleAnywhere, Category = "Grappling")
+	TArray<FGrapplingPointRecord> Points;
+
+	/** Fills the table from the grappling points of the level */
+	void BuildTable();
+
+	virtual void PostRegisterAllComponents() override;
+
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	/** Fills the table from the grappling points of the level */
+	UFUNCTION(CallInEditor, Category = "Grappling")
+	void RebuildTable();
+
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
+
+protected:
+
+	/** Is the table merged into the registry? */
+	bool bMerged;
+};
@@ -0,0 +1,198 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingReplay.h"
+
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 ReplayMagic = 0x4C505247; // "GRPL"
+	constexpr uint32 ReplayVersion = 2;
+
+	/** Maps signed to unsigned so small negative differences stay small */
+	uint32 ZigZag(int32 Value)
+	{
+		return (uint32(Value) << 1) ^ uint32(Value >> 31);
+	}
+
+	int32 UnZigZag(uint32 Value)
+	{
+		return int32(Value >> 1) ^ -int32(Value & 1);
+	}
+
+	FIntVector Quantize(const FVector& Location)
+	{
+		return FIntVector(FMath::RoundToInt(Location.X), FMath::RoundToInt(Location.Y), FMath::RoundToInt(Location.Z));
+	}
+}
+
+FGrapplingReplayWriter::FGrapplingReplayWriter(const FGrapplingReplayHeader& Header)
+{
+	FMemoryWriter Writer(Data);
+	uint32 Magic = ReplayMagic;
+	uint32 Version = ReplayVersion;
+	FString MapName = Header.MapName;
+	bool bFixedTimeStep = Header.bFixedTimeStep;
+	float FixedStepRate = Header.FixedStepRate;
+	Writer << Magic << Version << MapName << bFixedTimeStep << FixedStepRate;
+}
+
+void FGrapplingReplayWriter::Write(const FGrapplingReplayEvent& Event)
+{
+	Data.Add(uint8(Event.Type));
+	WritePacked(Event.Step - LastStep);
+	WritePacked(Event.CharacterId);
+	LastStep = Event.Step;
+
+	switch(Event.Type)
+	{
+	case EGrapplingReplayEventType::Input:
+	case EGrapplingReplayEventType::LeapStart:
+		{
+			// 0 for no point, the index plus one for a known point, the next index plus one
+			// followed by the id for a new one
+			if(!Event.PointId.IsValid())
+			{
+				WritePacked(0);
+			}
+			else if(const uint32* Index = PointIndices.Find(Event.PointId))
+			{
+				WritePacked(*Index + 1);
+			}
+			else
+			{
+				const uint32 NewIndex = PointIndices.Num();
+				PointIndices.Add(Event.PointId, NewIndex);
+				WritePacked(NewIndex + 1);
+				FMemoryWriter Writer(Data, false, true);
+				FGuid PointId = Event.PointId;
+				Writer << PointId;
+			}
+
+			WriteLocation(Event.CharacterId, Event.Start);
+			WriteLocation(Event.CharacterId, Event.End);
+			break;
+		}
+	case EGrapplingReplayEventType::LeapEnd:
+		WriteLocation(Event.CharacterId, Event.Start);
+		break;
+	}
+	EventCount++;
+}
+
+void FGrapplingReplayWriter::WritePacked(uint32 Value)
+{
+	// 7 bits per byte, high bit set while more bytes follow
+	while(Value >= 0x80)
+	{
+		Data.Add(uint8(Value | 0x80));
+		Value >>= 7;
+	}
+	Data.Add(uint8(Value));
+}
+
+void FGrapplingReplayWriter::WriteLocation(uint32 CharacterId, const FVector& Location)
+{
+	const FIntVector Quantized = Quantize(Location);
+	FIntVector& Last = LastLocations.FindOrAdd(CharacterId, FIntVector::ZeroValue);
+	WritePacked(ZigZag(Quantized.X - Last.X));
+	WritePacked(ZigZag(Quantized.Y - Last.Y));
+	WritePacked(ZigZag(Quantized.Z - Last.Z));
+	Last = Quantized;
+}
+
+FGrapplingReplayReader::FGrapplingReplayReader(const TArray<uint8>& InData)
+	: Data(InData)
+{
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic << Version;
+	if(Reader.IsError() || Magic != ReplayMagic || Version != ReplayVersion) return;
+
+	Reader << Header.MapName << Header.bFixedTimeStep << Header.FixedStepRate;
+	if(Reader.IsError()) return;
+
+	Offset = Reader.Tell();
+	bValid = true;
+}
+
+bool FGrapplingReplayReader::Read(FGrapplingReplayEvent& OutEvent)
+{
+	if(!bValid || Offset >= Data.Num()) return false;
+
+	const uint8 Type = Data[Offset++];
+	if(Type > uint8(EGrapplingReplayEventType::LeapEnd))
+	{
+		bValid = false;
+		return false;
+	}
+	OutEvent = FGrapplingReplayEvent();
+	OutEvent.Type = EGrapplingReplayEventType(Type);
+
+	uint32 StepDelta;
+	if(!ReadPacked(StepDelta) || !ReadPacked(OutEvent.CharacterId)) return false;
+	LastStep += StepDelta;
+	OutEvent.Step = LastStep;
+
+	if(OutEvent.Type == EGrapplingReplayEventType::LeapEnd)
+	{
+		return ReadLocation(OutEvent.CharacterId, OutEvent.Start);
+	}
+
+	uint32 PointIndex;
+	if(!ReadPacked(PointIndex)) return false;
+	if(PointIndex == uint32(PointIds.Num()) + 1)
+	{
+		if(Offset + int32(sizeof(FGuid)) > Data.Num())
+		{
+			bValid = false;
+			return false;
+		}
+		FMemoryReader Reader(Data);
+		Reader.Seek(Offset);
+		FGuid PointId;
+		Reader << PointId;
+		Offset = Reader.Tell();
+		PointIds.Add(PointId);
+	}
+	else if(PointIndex > uint32(PointIds.Num()))
+	{
+		bValid = false;
+		return false;
+	}
+	if(PointIndex > 0)
+	{
+		OutEvent.PointId = PointIds[PointIndex - 1];
+	}
+
+	return ReadLocation(OutEvent.CharacterId, OutEvent.Start) && ReadLocation(OutEvent.CharacterId, OutEvent.End);
+}
+
+bool FGrapplingReplayReader::ReadPacked(uint32& OutValue)
+{
+	OutValue = 0;
+	for(int32 Shift = 0; Shift < 35; Shift += 7)
+	{
+		if(Offset >= Data.Num()) break;
+
+		const uint8 Byte = Data[Offset++];
+		OutValue |= uint32(Byte & 0x7F) << Shift;
+		if(!(Byte & 0x80)) return true;
+	}
+	bValid = false;
+	return false;
+}
+
+bool FGrapplingReplayReader::ReadLocation(uint32 CharacterId, FVector& OutLocation)
+{
+	uint32 X, Y, Z;
+	if(!ReadPacked(X) || !ReadPacked(Y) || !ReadPacked(Z)) return false;
+
+	FIntVector& Last = LastLocations.FindOrAdd(CharacterId, FIntVector::ZeroValue);
+	Last += FIntVector(UnZigZag(X), UnZigZag(Y), UnZigZag(Z));
+	OutLocation = FVector(Last);
+	return true;
+}
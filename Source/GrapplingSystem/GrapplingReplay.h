@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Kinds of events saved in a grappling replay */
+enum class EGrapplingReplayEventType : uint8
+{
+	/** The grapple button was pressed, with the point focused and where the character stood at the time */
+	Input,
+
+	/** A leap started towards a point */
+	LeapStart,
+
+	/** A leap ended, with where the character landed */
+	LeapEnd
+};
+
+/** One event of a grappling replay */
+struct FGrapplingReplayEvent
+{
+	EGrapplingReplayEventType Type = EGrapplingReplayEventType::Input;
+
+	/** Simulation step the event happened at */
+	uint32 Step = 0;
+
+	/** Character the event is about, numbered in order of first appearance */
+	uint32 CharacterId = 0;
+
+	/** Point focused or leapt to, invalid if none */
+	FGuid PointId;
+
+	/** Character location at an input or a leap start, or landing location of a leap end */
+	FVector Start = FVector::ZeroVector;
+
+	/** Where the input aimed or the leap ends */
+	FVector End = FVector::ZeroVector;
+};
+
+/** What a grappling replay was recorded with */
+struct FGrapplingReplayHeader
+{
+	/** Map the replay was recorded in */
+	FString MapName;
+
+	/** Were the leaps simulated by fixed steps? Steps are frames otherwise */
+	bool bFixedTimeStep = false;
+
+	/** Fixed steps per second */
+	float FixedStepRate = 0.f;
+};
+
+/**
+ * Compact binary encoding of grappling replays. Steps are stored as the difference with the
+ * previous event, locations are rounded to the centimetre and stored as the difference with the
+ * last location of the same character, point ids are stored once and referenced by index, all
+ * as variable length integers. A typical event takes a handful of bytes.
+ */
+class GRAPPLINGSYSTEM_API FGrapplingReplayWriter
+{
+public:
+
+	explicit FGrapplingReplayWriter(const FGrapplingReplayHeader& Header);
+
+	void Write(const FGrapplingReplayEvent& Event);
+
+	/** Encoded replay, header included */
+	const TArray<uint8>& GetData() const { return Data; }
+
+	int32 NumEvents() const { return EventCount; }
+
+private:
+
+	TArray<uint8> Data;
+
+	int32 EventCount = 0;
+
+	uint32 LastStep = 0;
+
+	/** Last location written for each character, in centimetres */
+	TMap<uint32, FIntVector> LastLocations;
+
+	/** Index of every point id written so far */
+	TMap<FGuid, uint32> PointIndices;
+
+	void WritePacked(uint32 Value);
+
+	void WriteLocation(uint32 CharacterId, const FVector& Location);
+};
+
+/** Decodes replays written by FGrapplingReplayWriter */
+class GRAPPLINGSYSTEM_API FGrapplingReplayReader
+{
+public:
+
+	/** Reads the header. Fails if the data is not a replay of a known version */
+	explicit FGrapplingReplayReader(const TArray<uint8>& InData);
+
+	bool IsValid() const { return bValid; }
+
+	const FGrapplingReplayHeader& GetHeader() const { return Header; }
+
+	/** Reads the next event. Returns false at the end of the data or if it is corrupt */
+	bool Read(FGrapplingReplayEvent& OutEvent);
+
+private:
+
+	const TArray<uint8>& Data;
+
+	int32 Offset = 0;
+
+	bool bValid = false;
+
+	FGrapplingReplayHeader Header;
+
+	uint32 LastStep = 0;
+
+	TMap<uint32, FIntVector> LastLocations;
+
+	TArray<FGuid> PointIds;
+
+	bool ReadPacked(uint32& OutValue);
+
+	bool ReadLocation(uint32 CharacterId, FVector& OutLocation);
+};
@@ -0,0 +1,290 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingReplayCommandlet.h"
+
+#include "GrapplingPointSubsystem.h"
+#include "GrapplingReplay.h"
+#include "GrapplingSimulationSubsystem.h"
+#include "GrapplingSystem.h"
+#include "GrapplingSystemCharacter.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+
+namespace
+{
+	/** Seconds simulated after the last event, for the last leaps to land */
+	constexpr float TailSeconds = 10.f;
+
+	/** Landing of a leap, recorded or replayed */
+	struct FLanding
+	{
+		uint32 Step;
+		FVector Location;
+	};
+}
+
+UGrapplingReplayCommandlet::UGrapplingReplayCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = true;
+	LogToConsole = true;
+}
+
+int32 UGrapplingReplayCommandlet::Main(const FString& Params)
+{
+	FString ReplayPath;
+	if(!FParse::Value(*Params, TEXT("Replay="), ReplayPath))
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Usage: -run=GrapplingReplay -Replay=Saved/Grappling.grpl [-Map=/Game/Maps/MapA] [-FixedStepRate=120] [-Tolerance=5]"));
+		return 1;
+	}
+
+	TArray<uint8> Data;
+	if(!FFileHelper::LoadFileToArray(Data, *ReplayPath))
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Could not read grappling replay %s"), *ReplayPath);
+		return 1;
+	}
+
+	FGrapplingReplayReader Reader(Data);
+	if(!Reader.IsValid())
+	{
+		UE_LOG(LogGrappling, Error, TEXT("%s is not a grappling replay"), *ReplayPath);
+		return 1;
+	}
+
+	TArray<FGrapplingReplayEvent> Events;
+	TMap<uint32, TArray<FLanding>> RecordedLandings;
+	FGrapplingReplayEvent Event;
+	while(Reader.Read(Event))
+	{
+		if(Event.Type == EGrapplingReplayEventType::LeapEnd)
+		{
+			RecordedLandings.FindOrAdd(Event.CharacterId).Add({Event.Step, Event.Start});
+		}
+		Events.Add(Event);
+	}
+	if(!Reader.IsValid())
+	{
+		UE_LOG(LogGrappling, Warning, TEXT("%s is truncated, replaying the first %d events"), *ReplayPath, Events.Num());
+	}
+
+	const FGrapplingReplayHeader& Header = Reader.GetHeader();
+	FString MapName = Header.MapName;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	float FixedStepRate = Header.bFixedTimeStep ? Header.FixedStepRate : 120.f;
+	FParse::Value(*Params, TEXT("FixedStepRate="), FixedStepRate);
+	float Tolerance = 5.f;
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+	UClass* CharacterClass = AGrapplingSystemCharacter::StaticClass();
+	FString CharacterClassPath;
+	if(FParse::Value(*Params, TEXT("CharacterClass="), CharacterClassPath))
+	{
+		CharacterClass = LoadClass<AGrapplingSystemCharacter>(nullptr, *CharacterClassPath);
+		if(!CharacterClass)
+		{
+			UE_LOG(LogGrappling, Error, TEXT("Could not load character class %s"), *CharacterClassPath);
+			return 1;
+		}
+	}
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("GrapplingReplay.json");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if(!World)
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Game;
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	if(!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues().AllowAudioPlayback(false).CreateNavigation(false));
+	}
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+	UGrapplingSimulationSubsystem* Simulation = World->GetSubsystem<UGrapplingSimulationSubsystem>();
+	const UGrapplingPointSubsystem* Registry = World->GetSubsystem<UGrapplingPointSubsystem>();
+	check(Simulation && Registry);
+
+	// One frame per fixed step, so the steps of the recording line up with the frames
+	Simulation->SetFixedTimeStep(true, FixedStepRate);
+	const float StepTime = Simulation->GetFixedStepTime();
+	const uint32 FirstStep = Events.Num() > 0 ? Events[0].Step : 0;
+	const uint32 LastStep = (Events.Num() > 0 ? Events.Last().Step : 0) + FMath::CeilToInt(TailSeconds / StepTime);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	TMap<uint32, AGrapplingSystemCharacter*> Characters;
+	TMap<uint32, TArray<FLanding>> ReplayedLandings;
+	TSet<uint32> Grappling;
+	int32 Inputs = 0;
+	int32 InputsAccepted = 0;
+	int32 LeapsStarted = 0;
+	int32 LeapsForced = 0;
+	int32 LeapsRejected = 0;
+
+	// The character of an event, placed where it stood when recorded unless it is busy grappling
+	const auto PlaceCharacter = [&](const FGrapplingReplayEvent& Current)
+	{
+		AGrapplingSystemCharacter*& Character = Characters.FindOrAdd(Current.CharacterId);
+		if(!Character)
+		{
+			Character = World->SpawnActor<AGrapplingSystemCharacter>(CharacterClass, Current.Start, FRotator::ZeroRotator, SpawnParams);
+			Character->SpawnDefaultController();
+		}
+		else if(!Character->IsGrappleInProgress())
+		{
+			Character->SetActorLocation(Current.Start, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+		return Character;
+	};
+
+	// Points missing from the map, or recorded without an id, are stood in for by where the leap was headed
+	const auto TryGrapple = [Registry](AGrapplingSystemCharacter* Character, const FGrapplingReplayEvent& Current)
+	{
+		const int32 PointIndex = Current.PointId.IsValid() ? Registry->FindPoint(Current.PointId) : INDEX_NONE;
+		const FGrapplingPointTarget Target = PointIndex != INDEX_NONE
+			? FGrapplingPointTarget::FromEntry(Registry->GetEntry(PointIndex)) : FGrapplingPointTarget();
+		return Target.IsValid() ? Character->TryGrappleToTarget(Target) : Character->TryGrappleToLocation(Current.End);
+	};
+
+	int32 NextEvent = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	for(uint32 Step = FirstStep; Step <= LastStep; Step++)
+	{
+		for(; NextEvent < Events.Num() && Events[NextEvent].Step <= Step; NextEvent++)
+		{
+			const FGrapplingReplayEvent& Current = Events[NextEvent];
+			if(Current.Type == EGrapplingReplayEventType::Input)
+			{
+				// Presses go through the same checks and throw as in game. Those made while a grapple
+				// was under way were ignored when recorded and are again
+				Inputs++;
+				AGrapplingSystemCharacter* Character = PlaceCharacter(Current);
+				if(!Character->IsGrappleInProgress() && TryGrapple(Character, Current))
+				{
+					InputsAccepted++;
+					Grappling.Add(Current.CharacterId);
+				}
+			}
+			else if(Current.Type == EGrapplingReplayEventType::LeapStart)
+			{
+				// The leap follows from a replayed press when one started a grapple, and is forced otherwise
+				AGrapplingSystemCharacter* Character = PlaceCharacter(Current);
+				if(Character->IsGrappleInProgress())
+				{
+					LeapsStarted++;
+				}
+				else if(TryGrapple(Character, Current))
+				{
+					LeapsStarted++;
+					LeapsForced++;
+					Grappling.Add(Current.CharacterId);
+				}
+				else
+				{
+					LeapsRejected++;
+				}
+			}
+		}
+
+		World->Tick(LEVELTICK_All, StepTime);
+		GFrameCounter++;
+
+		for(auto It = Grappling.CreateIterator(); It; ++It)
+		{
+			const AGrapplingSystemCharacter* Character = Characters.FindRef(*It);
+			if(!Character->IsGrappleInProgress())
+			{
+				ReplayedLandings.FindOrAdd(*It).Add({Step, Character->GetActorLocation()});
+				It.RemoveCurrent();
+			}
+		}
+	}
+	const double WallSeconds = FMath::Max(FPlatformTime::Seconds() - StartTime, SMALL_NUMBER);
+	const double SimulatedSeconds = (LastStep - FirstStep + 1) * StepTime;
+
+	// Landings are compared in order, character by character
+	int32 LeapsCompared = 0;
+	int32 LeapsDiverged = 0;
+	float MaxLandingError = 0.f;
+	double TotalLandingError = 0.0;
+	int32 MaxStepError = 0;
+	for(const TPair<uint32, TArray<FLanding>>& Recorded : RecordedLandings)
+	{
+		const TArray<FLanding>* Replayed = ReplayedLandings.Find(Recorded.Key);
+		const int32 Count = Replayed ? FMath::Min(Recorded.Value.Num(), Replayed->Num()) : 0;
+		LeapsDiverged += Recorded.Value.Num() - Count;
+		for(int32 i = 0; i < Count; i++)
+		{
+			const float LandingError = FVector::Dist(Recorded.Value[i].Location, (*Replayed)[i].Location);
+			const int32 StepError = FMath::Abs(int32(Recorded.Value[i].Step) - int32((*Replayed)[i].Step));
+			if(LandingError > Tolerance)
+			{
+				UE_LOG(LogGrappling, Warning, TEXT("Character %u leap %d landed %.1f away from its recorded landing"), Recorded.Key, i, LandingError);
+				LeapsDiverged++;
+			}
+			MaxLandingError = FMath::Max(MaxLandingError, LandingError);
+			TotalLandingError += LandingError;
+			MaxStepError = FMath::Max(MaxStepError, StepError);
+			LeapsCompared++;
+		}
+	}
+
+	const TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("replay"), ReplayPath);
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("fixedStepRate"), FixedStepRate);
+	Report->SetNumberField(TEXT("events"), Events.Num());
+	Report->SetNumberField(TEXT("inputs"), Inputs);
+	Report->SetNumberField(TEXT("inputsAccepted"), InputsAccepted);
+	Report->SetNumberField(TEXT("leapsStarted"), LeapsStarted);
+	Report->SetNumberField(TEXT("leapsForced"), LeapsForced);
+	Report->SetNumberField(TEXT("leapsRejected"), LeapsRejected);
+	Report->SetNumberField(TEXT("leapsCompared"), LeapsCompared);
+	Report->SetNumberField(TEXT("leapsDiverged"), LeapsDiverged);
+	Report->SetNumberField(TEXT("maxLandingError"), MaxLandingError);
+	Report->SetNumberField(TEXT("avgLandingError"), LeapsCompared ? TotalLandingError / LeapsCompared : 0.0);
+	Report->SetNumberField(TEXT("maxStepError"), MaxStepError);
+	Report->SetNumberField(TEXT("simulatedSeconds"), SimulatedSeconds);
+	Report->SetNumberField(TEXT("wallSeconds"), WallSeconds);
+	Report->SetNumberField(TEXT("realTimeFactor"), SimulatedSeconds / WallSeconds);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	if(!FFileHelper::SaveStringToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Could not write the replay report to %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogGrappling, Display, TEXT("Replayed %d leaps %.1fx faster than real time, %d diverged. Report written to %s"),
+	       LeapsStarted, SimulatedSeconds / WallSeconds, LeapsDiverged, *OutputPath);
+	return LeapsDiverged > 0 ? 1 : 0;
+}
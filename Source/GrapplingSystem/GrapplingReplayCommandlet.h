@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GrapplingReplayCommandlet.generated.h"
+
+/**
+ * Plays back a grappling replay headless, as fast as the simulation runs, and reports as JSON how
+ * far the leaps landed from where they landed when recorded and how long the playback took.
+ * Grapple presses are replayed with the character teleported to where it stood and aiming at the
+ * recorded point, rather than replaying the camera aim that led to them. A recorded leap that no
+ * replayed press started is forced from its recorded start. Points missing from the map are
+ * replaced by the recorded end of the leap.
+ * Exits with an error when a leap lands further than the tolerance from its recorded landing.
+ *
+ * Usage: UE4Editor-Cmd GrapplingSystem -run=GrapplingReplay -Replay=Saved/Grappling.grpl -nullrhi -unattended
+ *        [-Map=/Game/Maps/MapA] [-FixedStepRate=120] [-Tolerance=5]
+ *        [-CharacterClass=/Game/ThirdPersonCPP/Blueprints/ThirdPersonCharacter.ThirdPersonCharacter_C]
+ *        [-Output=Saved/Benchmarks/GrapplingReplay.json]
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API UGrapplingReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingReplaySubsystem.h"
+
+#include "GrapplingPointSetComponent.h"
+#include "GrapplingSimulationSubsystem.h"
+#include "GrapplingSystem.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+
+void UGrapplingReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString Filename;
+	if(InWorld.IsGameWorld() && FParse::Value(FCommandLine::Get(), TEXT("GrappleRecord="), Filename))
+	{
+		StartRecording(Filename);
+	}
+}
+
+void UGrapplingReplaySubsystem::Deinitialize()
+{
+	StopRecording();
+	Super::Deinitialize();
+}
+
+void UGrapplingReplaySubsystem::StartRecording(const FString& Filename)
+{
+	StopRecording();
+
+	const UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>();
+
+	FGrapplingReplayHeader Header;
+	Header.MapName = GetWorld()->GetOutermost()->GetName();
+	Header.bFixedTimeStep = Simulation && Simulation->IsFixedTimeStep();
+	Header.FixedStepRate = Header.bFixedTimeStep ? 1.f / Simulation->GetFixedStepTime() : 0.f;
+	if(!Header.bFixedTimeStep)
+	{
+		UE_LOG(LogGrappling, Warning, TEXT("Recording grappling replay without fixed step simulation, leaps will not replay exactly"));
+	}
+
+	Writer = MakeUnique<FGrapplingReplayWriter>(Header);
+	RecordingFilename = Filename;
+	CharacterIds.Reset();
+}
+
+bool UGrapplingReplaySubsystem::StopRecording()
+{
+	if(!Writer) return false;
+
+	const bool bSaved = FFileHelper::SaveArrayToFile(Writer->GetData(), *RecordingFilename);
+	if(bSaved)
+	{
+		UE_LOG(LogGrappling, Display, TEXT("Grappling replay saved to %s: %d events, %d bytes"), *RecordingFilename, Writer->NumEvents(), Writer->GetData().Num());
+	}
+	else
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Could not save grappling replay to %s"), *RecordingFilename);
+	}
+
+	Writer.Reset();
+	CharacterIds.Reset();
+	return bSaved;
+}
+
+void UGrapplingReplaySubsystem::RecordInput(const AActor* Character, const FGrapplingPointTarget& Target, const FVector& Start, const FVector& End)
+{
+	if(!Writer) return;
+
+	FGrapplingReplayEvent Event = MakeEvent(EGrapplingReplayEventType::Input, Character);
+	Event.PointId = Target.GetPointId();
+	Event.Start = Start;
+	Event.End = End;
+	Writer->Write(Event);
+}
+
+void UGrapplingReplaySubsystem::RecordLeapStart(const AActor* Character, const FGrapplingPointTarget& Target, const FVector& Start, const FVector& End)
+{
+	if(!Writer) return;
+
+	FGrapplingReplayEvent Event = MakeEvent(EGrapplingReplayEventType::LeapStart, Character);
+	Event.PointId = Target.GetPointId();
+	Event.Start = Start;
+	Event.End = End;
+	Writer->Write(Event);
+}
+
+void UGrapplingReplaySubsystem::RecordLeapEnd(const AActor* Character, const FVector& Location)
+{
+	if(!Writer) return;
+
+	FGrapplingReplayEvent Event = MakeEvent(EGrapplingReplayEventType::LeapEnd, Character);
+	Event.Start = Location;
+	Writer->Write(Event);
+}
+
+FGrapplingReplayEvent UGrapplingReplaySubsystem::MakeEvent(EGrapplingReplayEventType Type, const AActor* Character)
+{
+	const UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>();
+
+	FGrapplingReplayEvent Event;
+	Event.Type = Type;
+	Event.Step = Simulation ? Simulation->GetSimulationStep() : 0;
+	Event.CharacterId = CharacterIds.FindOrAdd(Character, CharacterIds.Num());
+	return Event;
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingReplay.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingReplaySubsystem.generated.h"
+
+struct FGrapplingPointTarget;
+
+/**
+ * Records the grapple inputs and leaps of every character of the world in a compact replay file,
+ * which the GrapplingReplay commandlet plays back headless to compare behavior and timings
+ * between builds. Recording starts with the world when -GrappleRecord=<File> is on the command line.
+ * Leaps are only reproduced exactly when they were simulated in fixed step mode.
+ */
+UCLASS()
+class GRAPPLINGSYSTEM_API UGrapplingReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+	/** Starts recording, to be saved to Filename when stopped */
+	UFUNCTION(BlueprintCallable, Category = "Grappling")
+	void StartRecording(const FString& Filename);
+
+	/** Saves the replay recorded so far. Returns false if nothing was recorded or it could not be saved */
+	UFUNCTION(BlueprintCallable, Category = "Grappling")
+	bool StopRecording();
+
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	bool IsRecording() const { return Writer.IsValid(); }
+
+	/** The grapple button was pressed at Start while Target was focused, aiming for a leap ending at End */
+	void RecordInput(const AActor* Character, const FGrapplingPointTarget& Target, const FVector& Start, const FVector& End);
+
+	/** A leap started from Start towards Target, ending at End */
+	void RecordLeapStart(const AActor* Character, const FGrapplingPointTarget& Target, const FVector& Start, const FVector& End);
+
+	/** A leap ended with the character at Location */
+	void RecordLeapEnd(const AActor* Character, const FVector& Location);
+
+private:
+
+	TUniquePtr<FGrapplingReplayWriter> Writer;
+
+	FString RecordingFilename;
+
+	/** Replay id of every character recorded */
+	TMap<TObjectKey<AActor>, uint32> CharacterIds;
+
+	/** Fills the fields shared by every event */
+	FGrapplingReplayEvent MakeEvent(EGrapplingReplayEventType Type, const AActor* Character);
+};
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingRopeBatch.h"
+
+void FGrapplingRopeMesh::BuildTubeVertices(TArrayView<const FVector> Points, float Width, int32 NumSides, float TileMaterial,
+                                           int32 RingCount, FDynamicMeshVertex* OutVertices)
+{
+	const int32 RingSize = NumSides + 1;
+	const int32 PointCount = FMath::Min(Points.Num(), RingCount);
+	if(PointCount == 0)
+	{
+		for(int32 i = 0; i < RingCount * RingSize; i++)
+		{
+			OutVertices[i] = FDynamicMeshVertex(FVector::ZeroVector);
+		}
+		return;
+	}
+
+	// The first side is repeated at the end of the ring so the texture wraps around
+	TArray<FVector2D, TInlineAllocator<17>> SideDirections;
+	for(int32 Side = 0; Side <= NumSides; Side++)
+	{
+		const float Angle = 2.f * PI * Side / NumSides;
+		SideDirections.Add(FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)));
+	}
+
+	float Distance = 0.f;
+	for(int32 i = 0; i < PointCount; i++)
+	{
+		const FVector Previous = Points[FMath::Max(i - 1, 0)];
+		const FVector Next = Points[FMath::Min(i + 1, PointCount - 1)];
+		const FVector Forward = (Next - Previous).GetSafeNormal();
+		FVector Right = FVector::CrossProduct(Forward, FVector::UpVector).GetSafeNormal();
+		if(Right.IsNearlyZero())
+		{
+			Right = FVector::CrossProduct(Forward, FVector::ForwardVector).GetSafeNormal();
+		}
+		const FVector Up = FVector::CrossProduct(Right, Forward);
+
+		if(i > 0)
+		{
+			Distance += FVector::Dist(Points[i - 1], Points[i]);
+		}
+		const float V = Distance * TileMaterial / 100.f;
+
+		FDynamicMeshVertex* Ring = OutVertices + i * RingSize;
+		for(int32 Side = 0; Side <= NumSides; Side++)
+		{
+			const FVector Normal = Right * SideDirections[Side].X + Up * SideDirections[Side].Y;
+			Ring[Side] = FDynamicMeshVertex(Points[i] + Normal * Width * 0.5f, Forward, Normal,
+			                                FVector2D(float(Side) / NumSides, V), FColor::White);
+		}
+	}
+
+	// Unused rings collapse onto the last point, their triangles have no area
+	const FDynamicMeshVertex Collapsed(Points[PointCount - 1]);
+	for(int32 i = PointCount * RingSize; i < RingCount * RingSize; i++)
+	{
+		OutVertices[i] = Collapsed;
+	}
+}
+
+void FGrapplingRopeMesh::BuildTubeIndices(int32 RingCount, int32 NumSides, uint32 BaseVertex, TArray<uint32>& OutIndices)
+{
+	const int32 RingSize = NumSides + 1;
+	OutIndices.Reserve(OutIndices.Num() + FMath::Max(RingCount - 1, 0) * NumSides * 6);
+	for(int32 i = 1; i < RingCount; i++)
+	{
+		const uint32 PreviousRing = BaseVertex + (i - 1) * RingSize;
+		const uint32 Ring = BaseVertex + i * RingSize;
+		for(int32 Side = 0; Side < NumSides; Side++)
+		{
+			OutIndices.Append({PreviousRing + Side, Ring + Side, PreviousRing + Side + 1});
+			OutIndices.Append({PreviousRing + Side + 1, Ring + Side, Ring + Side + 1});
+		}
+	}
+}
+
+void FGrapplingRopeBatchBuffer::Init(int32 InRingsPerSlot, int32 InNumSides)
+{
+	RingsPerSlot = FMath::Max(InRingsPerSlot, 2);
+	NumSides = FMath::Clamp(InNumSides, 3, 16);
+	Slots.Reset();
+	FreeSlots.Reset();
+	DirtySlotCount = 0;
+}
+
+int32 FGrapplingRopeBatchBuffer::AddSlot()
+{
+	int32 SlotIndex;
+	if(FreeSlots.Num() > 0)
+	{
+		FreeSlots.HeapPop(SlotIndex, false);
+	}
+	else
+	{
+		SlotIndex = Slots.AddDefaulted();
+	}
+
+	FSlot& Slot = Slots[SlotIndex];
+	Slot.bUsed = true;
+	MarkDirty(Slot);
+	return SlotIndex;
+}
+
+void FGrapplingRopeBatchBuffer::RemoveSlot(int32 SlotIndex)
+{
+	if(!Slots.IsValidIndex(SlotIndex) || !Slots[SlotIndex].bUsed) return;
+
+	FSlot& Slot = Slots[SlotIndex];
+	Slot.bUsed = false;
+	Slot.Points.Reset();
+	Slot.Bounds = FBox(ForceInit);
+	MarkDirty(Slot);
+	FreeSlots.HeapPush(SlotIndex);
+}
+
+bool FGrapplingRopeBatchBuffer::SetPoints(int32 SlotIndex, TArrayView<const FVector> Points, float Width, float TileMaterial)
+{
+	if(!Slots.IsValidIndex(SlotIndex) || !Slots[SlotIndex].bUsed) return false;
+
+	FSlot& Slot = Slots[SlotIndex];
+	if(Slot.Width == Width && Slot.TileMaterial == TileMaterial && Slot.Points.Num() == Points.Num()
+		&& FMemory::Memcmp(Slot.Points.GetData(), Points.GetData(), Points.Num() * sizeof(FVector)) == 0)
+	{
+		return false;
+	}
+
+	Slot.Points.Reset(Points.Num());
+	Slot.Points.Append(Points.GetData(), Points.Num());
+	Slot.Width = Width;
+	Slot.TileMaterial = TileMaterial;
+	Slot.Bounds = Points.Num() > 0 ? FBox(Points.GetData(), Points.Num()).ExpandBy(Width) : FBox(ForceInit);
+	MarkDirty(Slot);
+	return true;
+}
+
+void FGrapplingRopeBatchBuffer::MarkAllDirty()
+{
+	for(FSlot& Slot : Slots)
+	{
+		MarkDirty(Slot);
+	}
+}
+
+void FGrapplingRopeBatchBuffer::BuildDirtySlots(FGrapplingRopeBatchUpdate& OutUpdate)
+{
+	OutUpdate.Slots.Reset();
+	OutUpdate.Vertices.Reset();
+
+	const int32 SlotVertexCount = GetSlotVertexCount();
+	if(DirtySlotCount > 0)
+	{
+		OutUpdate.Slots.Reserve(DirtySlotCount);
+		OutUpdate.Vertices.Reserve(DirtySlotCount * SlotVertexCount);
+		for(int32 SlotIndex = 0; SlotIndex < Slots.Num(); SlotIndex++)
+		{
+			FSlot& Slot = Slots[SlotIndex];
+			if(!Slot.bDirty) continue;
+
+			const int32 FirstVertex = OutUpdate.Vertices.AddUninitialized(SlotVertexCount);
+			FGrapplingRopeMesh::BuildTubeVertices(Slot.Points, Slot.Width, NumSides, Slot.TileMaterial, RingsPerSlot,
+			                                      OutUpdate.Vertices.GetData() + FirstVertex);
+			OutUpdate.Slots.Add(SlotIndex);
+			Slot.bDirty = false;
+		}
+		DirtySlotCount = 0;
+	}
+
+	OutUpdate.DrawnSlotCount = Slots.Num();
+	while(OutUpdate.DrawnSlotCount > 0 && !Slots[OutUpdate.DrawnSlotCount - 1].bUsed)
+	{
+		OutUpdate.DrawnSlotCount--;
+	}
+}
+
+void FGrapplingRopeBatchBuffer::BuildIndices(int32 SlotCount, TArray<uint32>& OutIndices) const
+{
+	OutIndices.Reset(SlotCount * GetSlotIndexCount());
+	for(int32 SlotIndex = 0; SlotIndex < SlotCount; SlotIndex++)
+	{
+		FGrapplingRopeMesh::BuildTubeIndices(RingsPerSlot, NumSides, SlotIndex * GetSlotVertexCount(), OutIndices);
+	}
+}
+
+FBox FGrapplingRopeBatchBuffer::GetBounds() const
+{
+	FBox Bounds(ForceInit);
+	for(const FSlot& Slot : Slots)
+	{
+		if(Slot.bUsed)
+		{
+			Bounds += Slot.Bounds;
+		}
+	}
+	return Bounds;
+}
+
+void FGrapplingRopeBatchBuffer::MarkDirty(FSlot& Slot)
+{
+	if(!Slot.bDirty)
+	{
+		Slot.bDirty = true;
+		DirtySlotCount++;
+	}
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMeshBuilder.h"
+
+/** Tube geometry of the grappling ropes, shared by the single rope and the merged rope meshes */
+struct GRAPPLINGSYSTEM_API FGrapplingRopeMesh
+{
+	/**
+	 * Writes RingCount rings of NumSides + 1 vertices along Points to OutVertices. Rings past the
+	 * last point collapse onto it, so a rope with fewer points fills a fixed range with triangles that draw nothing
+	 */
+	static void BuildTubeVertices(TArrayView<const FVector> Points, float Width, int32 NumSides, float TileMaterial,
+	                              int32 RingCount, FDynamicMeshVertex* OutVertices);
+
+	/** Appends the triangles of a tube of RingCount rings whose first vertex is BaseVertex */
+	static void BuildTubeIndices(int32 RingCount, int32 NumSides, uint32 BaseVertex, TArray<uint32>& OutIndices);
+};
+
+/** Vertices of the ropes of a batch that changed, to be copied into the merged vertex buffer */
+struct FGrapplingRopeBatchUpdate
+{
+	/** Slots that changed, in increasing order */
+	TArray<int32> Slots;
+
+	/** Vertices of the changed slots, one full slot after the other */
+	TArray<FDynamicMeshVertex> Vertices;
+
+	/** Slots up to the last one in use, the only ones drawn */
+	int32 DrawnSlotCount = 0;
+};
+
+/**
+ * CPU side of the merged rope mesh. Every rope owns a slot, a fixed range of vertices sized for
+ * its most points, so a rope is rebuilt in place without touching the others and the index
+ * buffer never changes. Only the slots whose points changed are rebuilt.
+ */
+class GRAPPLINGSYSTEM_API FGrapplingRopeBatchBuffer
+{
+public:
+
+	/** Empties the buffer and sets the layout of its slots */
+	void Init(int32 InRingsPerSlot, int32 InNumSides);
+
+	/** Takes a free slot, the lowest one so the drawn range stays short */
+	int32 AddSlot();
+
+	/** Frees a slot, its vertices collapse on the next build */
+	void RemoveSlot(int32 Slot);
+
+	/** Sets the points of a slot. Returns false, leaving the slot clean, if nothing changed */
+	bool SetPoints(int32 Slot, TArrayView<const FVector> Points, float Width, float TileMaterial);
+
+	/** Flags every slot as changed, for when the render side lost its copy */
+	void MarkAllDirty();
+
+	bool HasDirtySlots() const { return DirtySlotCount > 0; }
+
+	/** Builds the vertices of the changed slots and flags them clean */
+	void BuildDirtySlots(FGrapplingRopeBatchUpdate& OutUpdate);
+
+	/** Indices of SlotCount slots, built once since they do not depend on the points */
+	void BuildIndices(int32 SlotCount, TArray<uint32>& OutIndices) const;
+
+	/** Bounds of the points of every slot in use, widened by the rope widths */
+	FBox GetBounds() const;
+
+	int32 GetRingsPerSlot() const { return RingsPerSlot; }
+
+	int32 GetNumSides() const { return NumSides; }
+
+	int32 GetSlotVertexCount() const { return RingsPerSlot * (NumSides + 1); }
+
+	int32 GetSlotIndexCount() const { return (RingsPerSlot - 1) * NumSides * 6; }
+
+	/** Number of slots, used or free */
+	int32 GetSlotCount() const { return Slots.Num(); }
+
+	/** Number of slots in use */
+	int32 GetUsedSlotCount() const { return Slots.Num() - FreeSlots.Num(); }
+
+private:
+
+	struct FSlot
+	{
+		/** Rope points in world space */
+		TArray<FVector> Points;
+
+		float Width = 0.f;
+
+		float TileMaterial = 0.f;
+
+		FBox Bounds = FBox(ForceInit);
+
+		bool bUsed = false;
+
+		bool bDirty = false;
+	};
+
+	TArray<FSlot> Slots;
+
+	/** Free slots, as a heap so the lowest one is taken first */
+	TArray<int32> FreeSlots;
+
+	int32 DirtySlotCount = 0;
+
+	int32 RingsPerSlot = 2;
+
+	int32 NumSides = 4;
+
+	void MarkDirty(FSlot& Slot);
+};
@@ -0,0 +1,320 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingRopeBatchComponent.h"
+
+#include "GrapplingRopeComponent.h"
+#include "GrapplingStats.h"
+#include "LocalVertexFactory.h"
+#include "PrimitiveSceneProxy.h"
+#include "RawIndexBuffer.h"
+#include "SceneManagement.h"
+#include "StaticMeshResources.h"
+#include "Materials/Material.h"
+
+namespace
+{
+	/** Copies a range of vertices from the CPU copy of a vertex buffer to the GPU */
+	void UploadVertexRange(FRHIVertexBuffer* VertexBuffer, const void* Data, uint32 Stride, uint32 FirstVertex, uint32 VertexCount)
+	{
+		void* BufferData = RHILockVertexBuffer(VertexBuffer, FirstVertex * Stride, VertexCount * Stride, RLM_WriteOnly);
+		FMemory::Memcpy(BufferData, static_cast<const uint8*>(Data) + FirstVertex * Stride, VertexCount * Stride);
+		RHIUnlockVertexBuffer(VertexBuffer);
+	}
+
+	/** Draws the slots of the batch in a single mesh batch. Its buffers are only written where ropes changed */
+	class FGrapplingRopeBatchSceneProxy final : public FPrimitiveSceneProxy
+	{
+	public:
+
+		FGrapplingRopeBatchSceneProxy(UGrapplingRopeBatchComponent* Component, const FGrapplingRopeBatchBuffer& Buffer, int32 InSlotCapacity)
+			: FPrimitiveSceneProxy(Component)
+			, Material(Component->GetMaterial(0))
+			, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+			, VertexFactory(GetScene().GetFeatureLevel(), "FGrapplingRopeBatchSceneProxy")
+			, SlotVertexCount(Buffer.GetSlotVertexCount())
+			, SlotIndexCount(Buffer.GetSlotIndexCount())
+			, SlotCapacity(InSlotCapacity)
+			, DrawnSlotCount(0)
+		{
+			if(!Material)
+			{
+				Material = UMaterial::GetDefaultMaterial(MD_Surface);
+			}
+
+			// The dummy vertices are all at the origin, unused slots draw nothing until they are written
+			VertexBuffers.InitWithDummyData(&VertexFactory, SlotCapacity * SlotVertexCount);
+
+			TArray<uint32> Indices;
+			Buffer.BuildIndices(SlotCapacity, Indices);
+			IndexBuffer.SetIndices(Indices, EIndexBufferStride::Force32Bit);
+			BeginInitResource(&IndexBuffer);
+		}
+
+		virtual ~FGrapplingRopeBatchSceneProxy() override
+		{
+			VertexBuffers.PositionVertexBuffer.ReleaseResource();
+			VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+			VertexBuffers.ColorVertexBuffer.ReleaseResource();
+			IndexBuffer.ReleaseResource();
+			VertexFactory.ReleaseResource();
+		}
+
+		virtual SIZE_T GetTypeHash() const override
+		{
+			static size_t UniquePointer;
+			return reinterpret_cast<size_t>(&UniquePointer);
+		}
+
+		void SetUpdate_RenderThread(FGrapplingRopeBatchUpdate&& Update)
+		{
+			check(IsInRenderingThread());
+			SCOPE_CYCLE_COUNTER(STAT_Grappling_RopeBatchUpload);
+
+			DrawnSlotCount = FMath::Min(Update.DrawnSlotCount, SlotCapacity);
+
+			int32 FirstSlot = MAX_int32;
+			int32 LastSlot = INDEX_NONE;
+			for(int32 i = 0; i < Update.Slots.Num(); i++)
+			{
+				const int32 Slot = Update.Slots[i];
+				if(Slot >= SlotCapacity) continue;
+
+				FirstSlot = FMath::Min(FirstSlot, Slot);
+				LastSlot = FMath::Max(LastSlot, Slot);
+				const FDynamicMeshVertex* SlotVertices = Update.Vertices.GetData() + i * SlotVertexCount;
+				for(int32 v = 0; v < SlotVertexCount; v++)
+				{
+					const FDynamicMeshVertex& Vertex = SlotVertices[v];
+					const uint32 Index = Slot * SlotVertexCount + v;
+					VertexBuffers.PositionVertexBuffer.VertexPosition(Index) = Vertex.Position;
+					VertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(Index, Vertex.TangentX.ToFVector(), Vertex.GetTangentY(), Vertex.TangentZ.ToFVector());
+					VertexBuffers.StaticMeshVertexBuffer.SetVertexUV(Index, 0, Vertex.TextureCoordinate[0]);
+					VertexBuffers.ColorVertexBuffer.VertexColor(Index) = Vertex.Color;
+				}
+			}
+			if(LastSlot == INDEX_NONE) return;
+
+			// A single lock per buffer covers every changed rope, the slots outside of it are left alone
+			const uint32 FirstVertex = FirstSlot * SlotVertexCount;
+			const uint32 VertexCount = (LastSlot - FirstSlot + 1) * SlotVertexCount;
+			const uint32 TotalVertexCount = VertexBuffers.PositionVertexBuffer.GetNumVertices();
+
+			FPositionVertexBuffer& Positions = VertexBuffers.PositionVertexBuffer;
+			UploadVertexRange(Positions.VertexBufferRHI, Positions.GetVertexData(), Positions.GetStride(), FirstVertex, VertexCount);
+
+			FStaticMeshVertexBuffer& StaticMeshVertices = VertexBuffers.StaticMeshVertexBuffer;
+			UploadVertexRange(StaticMeshVertices.TangentsVertexBuffer.VertexBufferRHI, StaticMeshVertices.GetTangentData(),
+			                  StaticMeshVertices.GetTangentSize() / TotalVertexCount, FirstVertex, VertexCount);
+			UploadVertexRange(StaticMeshVertices.TexCoordVertexBuffer.VertexBufferRHI, StaticMeshVertices.GetTexCoordData(),
+			                  StaticMeshVertices.GetTexCoordSize() / TotalVertexCount, FirstVertex, VertexCount);
+
+			FColorVertexBuffer& Colors = VertexBuffers.ColorVertexBuffer;
+			UploadVertexRange(Colors.VertexBufferRHI, Colors.GetVertexData(), Colors.GetStride(), FirstVertex, VertexCount);
+		}
+
+		virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily,
+		                                    uint32 VisibilityMap, FMeshElementCollector& Collector) const override
+		{
+			if(DrawnSlotCount == 0) return;
+
+			const FMaterialRenderProxy* MaterialProxy = Material->GetRenderProxy();
+			for(int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+			{
+				if(!(VisibilityMap & (1 << ViewIndex))) continue;
+
+				FMeshBatch& Mesh = Collector.AllocateMesh();
+				Mesh.VertexFactory = &VertexFactory;
+				Mesh.MaterialRenderProxy = MaterialProxy;
+				Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+				Mesh.Type = PT_TriangleList;
+				Mesh.DepthPriorityGroup = SDPG_World;
+				Mesh.bCanApplyViewModeOverrides = false;
+
+				bool bHasPrecomputedVolumetricLightmap;
+				FMatrix PreviousLocalToWorld;
+				int32 SingleCaptureIndex;
+				bool bOutputVelocity;
+				GetScene().GetPrimitiveUniformShaderParameters_RenderThread(GetPrimitiveSceneInfo(), bHasPrecomputedVolumetricLightmap,
+				                                                            PreviousLocalToWorld, SingleCaptureIndex, bOutputVelocity);
+
+				FDynamicPrimitiveUniformBuffer& DynamicPrimitiveUniformBuffer = Collector.AllocateOneFrameResource<FDynamicPrimitiveUniformBuffer>();
+				DynamicPrimitiveUniformBuffer.Set(GetLocalToWorld(), PreviousLocalToWorld, GetBounds(), GetLocalBounds(), true,
+				                                  bHasPrecomputedVolumetricLightmap, DrawsVelocity(), bOutputVelocity);
+
+				// Slots past the last rope in use are not drawn, freed slots below it are collapsed
+				FMeshBatchElement& BatchElement = Mesh.Elements[0];
+				BatchElement.IndexBuffer = &IndexBuffer;
+				BatchElement.PrimitiveUniformBufferResource = &DynamicPrimitiveUniformBuffer.UniformBuffer;
+				BatchElement.FirstIndex = 0;
+				BatchElement.NumPrimitives = DrawnSlotCount * SlotIndexCount / 3;
+				BatchElement.MinVertexIndex = 0;
+				BatchElement.MaxVertexIndex = DrawnSlotCount * SlotVertexCount - 1;
+				Collector.AddMesh(ViewIndex, Mesh);
+			}
+		}
+
+		virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+		{
+			FPrimitiveViewRelevance Result;
+			Result.bDrawRelevance = IsShown(View);
+			Result.bShadowRelevance = IsShadowCast(View);
+			Result.bDynamicRelevance = true;
+			MaterialRelevance.SetPrimitiveViewRelevance(Result);
+			return Result;
+		}
+
+		virtual uint32 GetMemoryFootprint() const override
+		{
+			return sizeof(*this) + GetAllocatedSize();
+		}
+
+		uint32 GetAllocatedSize() const
+		{
+			return FPrimitiveSceneProxy::GetAllocatedSize();
+		}
+
+	private:
+
+		UMaterialInterface* Material;
+
+		FMaterialRelevance MaterialRelevance;
+
+		FStaticMeshVertexBuffers VertexBuffers;
+
+		FRawStaticIndexBuffer IndexBuffer;
+
+		FLocalVertexFactory VertexFactory;
+
+		int32 SlotVertexCount;
+
+		int32 SlotIndexCount;
+
+		int32 SlotCapacity;
+
+		/** Slots up to the last one in use */
+		int32 DrawnSlotCount;
+	};
+}
+
+UGrapplingRopeBatchComponent::UGrapplingRopeBatchComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// After the ropes, which tick post physics
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	// Sized for the ropes as the pool creates them
+	const UGrapplingRopeComponent* RopeDefaults = GetDefault<UGrapplingRopeComponent>();
+	NumSides = RopeDefaults->NumSides;
+	MaxPointsPerRope = RopeDefaults->MaxSegments + 1;
+	RopeMaterial = nullptr;
+	ProxySlotCapacity = 0;
+
+	SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+}
+
+void UGrapplingRopeBatchComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	if(Buffer.GetSlotCount() == 0)
+	{
+		Buffer.Init(MaxPointsPerRope, NumSides);
+	}
+}
+
+void UGrapplingRopeBatchComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if(!Buffer.HasDirtySlots()) return;
+
+	// Past the capacity of the render side, it is recreated bigger with every slot in it
+	if(Buffer.GetSlotCount() > ProxySlotCapacity)
+	{
+		MarkRenderStateDirty();
+	}
+	else
+	{
+		MarkRenderDynamicDataDirty();
+	}
+	// The bounds changed with the ropes, the batch itself does not move
+	UpdateBounds();
+	MarkRenderTransformDirty();
+}
+
+void UGrapplingRopeBatchComponent::SendRenderDynamicData_Concurrent()
+{
+	Super::SendRenderDynamicData_Concurrent();
+
+	if(SceneProxy)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Grappling_RopeBatch);
+		CSV_SCOPED_TIMING_STAT(Grappling, RopeBatch);
+
+		FGrapplingRopeBatchUpdate Update;
+		Buffer.BuildDirtySlots(Update);
+
+		FGrapplingRopeBatchSceneProxy* BatchSceneProxy = static_cast<FGrapplingRopeBatchSceneProxy*>(SceneProxy);
+		ENQUEUE_RENDER_COMMAND(FSendGrapplingRopeBatch)(
+			[BatchSceneProxy, Update = MoveTemp(Update)](FRHICommandListImmediate& RHICmdList) mutable
+			{
+				BatchSceneProxy->SetUpdate_RenderThread(MoveTemp(Update));
+			});
+	}
+}
+
+void UGrapplingRopeBatchComponent::CreateRenderState_Concurrent(FRegisterComponentContext* Context)
+{
+	Super::CreateRenderState_Concurrent(Context);
+
+	// A new proxy starts empty, every rope has to be sent again
+	Buffer.MarkAllDirty();
+	SendRenderDynamicData_Concurrent();
+}
+
+FPrimitiveSceneProxy* UGrapplingRopeBatchComponent::CreateSceneProxy()
+{
+	// Grow by powers of two, so a growing number of ropes recreates the render side a few times only
+	ProxySlotCapacity = FMath::RoundUpToPowerOfTwo(FMath::Max(Buffer.GetSlotCount(), 8));
+	return new FGrapplingRopeBatchSceneProxy(this, Buffer, ProxySlotCapacity);
+}
+
+FBoxSphereBounds UGrapplingRopeBatchComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	// The points are already in world space
+	const FBox Bounds = Buffer.GetBounds();
+	if(!Bounds.IsValid)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector(1.f), 1.f);
+	}
+	return FBoxSphereBounds(Bounds);
+}
+
+UMaterialInterface* UGrapplingRopeBatchComponent::GetMaterial(int32 ElementIndex) const
+{
+	UMaterialInterface* OverrideMaterial = Super::GetMaterial(ElementIndex);
+	return OverrideMaterial ? OverrideMaterial : RopeMaterial;
+}
+
+bool UGrapplingRopeBatchComponent::CanBatch(const UGrapplingRopeComponent* Rope) const
+{
+	return Rope->GetMaterial(0) == GetMaterial(0)
+		&& FMath::Clamp(Rope->NumSides, 3, 16) == Buffer.GetNumSides()
+		&& Rope->MaxSegments + 1 <= Buffer.GetRingsPerSlot();
+}
+
+int32 UGrapplingRopeBatchComponent::AddRope()
+{
+	return Buffer.AddSlot();
+}
+
+void UGrapplingRopeBatchComponent::RemoveRope(int32 Slot)
+{
+	Buffer.RemoveSlot(Slot);
+}
+
+void UGrapplingRopeBatchComponent::UpdateRope(int32 Slot, const TArray<FVector>& Points, float Width, float TileMaterial)
+{
+	Buffer.SetPoints(Slot, Points, Width, TileMaterial);
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingRopeBatch.h"
+#include "Components/MeshComponent.h"
+#include "GrapplingRopeBatchComponent.generated.h"
+
+class UGrapplingRopeComponent;
+class UMaterialInterface;
+
+/**
+ * Draws every batched grapple rope of the world as a single mesh: one vertex buffer holding a
+ * slot per rope, one index buffer and one draw call, however many ropes are out. Ropes hand it
+ * their points every frame, only the ones that moved are rebuilt and uploaded.
+ */
+UCLASS(ClassGroup = Rendering)
+class GRAPPLINGSYSTEM_API UGrapplingRopeBatchComponent : public UMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingRopeBatchComponent();
+
+	virtual void OnRegister() override;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	virtual void SendRenderDynamicData_Concurrent() override;
+
+	virtual void CreateRenderState_Concurrent(FRegisterComponentContext* Context) override;
+
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+	virtual int32 GetNumMaterials() const override { return 1; }
+
+	/** RopeMaterial, unless a material override is set */
+	virtual UMaterialInterface* GetMaterial(int32 ElementIndex) const override;
+
+	/** Can the rope be drawn by the batch? It must share its material and sides, and fit in a slot */
+	bool CanBatch(const UGrapplingRopeComponent* Rope) const;
+
+	/** Takes a slot for a rope, returns its index */
+	int32 AddRope();
+
+	void RemoveRope(int32 Slot);
+
+	/** Sets the points of a rope, in world space. Nothing is rebuilt if they did not change */
+	void UpdateRope(int32 Slot, const TArray<FVector>& Points, float Width, float TileMaterial);
+
+	/** Number of ropes drawn by the batch */
+	int32 GetRopeCount() const { return Buffer.GetUsedSlotCount(); }
+
+	/** Sides of the rendered tubes, batched ropes must have as many */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope Rendering", meta = (ClampMin = "3", ClampMax = "16"))
+	int32 NumSides;
+
+	/** Most points of a batched rope */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope Rendering", meta = (ClampMin = "2"))
+	int32 MaxPointsPerRope;
+
+	/** Material of the merged mesh, batched ropes must have the same */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope Rendering")
+	UMaterialInterface* RopeMaterial;
+
+private:
+
+	FGrapplingRopeBatchBuffer Buffer;
+
+	/** Slots the render side was created for, it is recreated when the ropes outgrow it */
+	int32 ProxySlotCapacity;
+};
@@ -0,0 +1,354 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingRopeComponent.h"
+
+#include "DynamicMeshBuilder.h"
+#include "GrapplingRopeBatch.h"
+#include "GrapplingRopeBatchComponent.h"
+#include "GrapplingRopePoolSubsystem.h"
+#include "GrapplingStats.h"
+#include "PrimitiveSceneProxy.h"
+#include "SceneManagement.h"
+#include "Engine/World.h"
+#include "Materials/Material.h"
+
+namespace
+{
+	/** Draws the rope points as a tube, rebuilt every frame since the rope moves every frame */
+	class FGrapplingRopeSceneProxy final : public FPrimitiveSceneProxy
+	{
+	public:
+
+		FGrapplingRopeSceneProxy(UGrapplingRopeComponent* Component)
+			: FPrimitiveSceneProxy(Component)
+			, Material(Component->GetMaterial(0))
+			, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+			, RopeWidth(Component->RopeWidth)
+			, NumSides(FMath::Clamp(Component->NumSides, 3, 16))
+			, TileMaterial(Component->TileMaterial)
+		{
+			if(!Material)
+			{
+				Material = UMaterial::GetDefaultMaterial(MD_Surface);
+			}
+		}
+
+		virtual SIZE_T GetTypeHash() const override
+		{
+			static size_t UniquePointer;
+			return reinterpret_cast<size_t>(&UniquePointer);
+		}
+
+		void SetPoints_RenderThread(TArray<FVector>&& InPoints)
+		{
+			check(IsInRenderingThread());
+			Points = MoveTemp(InPoints);
+		}
+
+		virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily,
+		                                    uint32 VisibilityMap, FMeshElementCollector& Collector) const override
+		{
+			if(Points.Num() < 2) return;
+
+			TArray<FDynamicMeshVertex> Vertices;
+			TArray<uint32> Indices;
+			BuildTube(Vertices, Indices);
+
+			const FMaterialRenderProxy* MaterialProxy = Material->GetRenderProxy();
+			for(int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+			{
+				if(!(VisibilityMap & (1 << ViewIndex))) continue;
+
+				// The points are in world space
+				FDynamicMeshBuilder MeshBuilder(Views[ViewIndex]->GetFeatureLevel());
+				MeshBuilder.AddVertices(Vertices);
+				MeshBuilder.AddTriangles(Indices);
+				MeshBuilder.GetMesh(FMatrix::Identity, MaterialProxy, SDPG_World, false, false, ViewIndex, Collector);
+			}
+		}
+
+		virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+		{
+			FPrimitiveViewRelevance Result;
+			Result.bDrawRelevance = IsShown(View);
+			Result.bShadowRelevance = IsShadowCast(View);
+			Result.bDynamicRelevance = true;
+			MaterialRelevance.SetPrimitiveViewRelevance(Result);
+			return Result;
+		}
+
+		virtual uint32 GetMemoryFootprint() const override
+		{
+			return sizeof(*this) + GetAllocatedSize();
+		}
+
+		uint32 GetAllocatedSize() const
+		{
+			return FPrimitiveSceneProxy::GetAllocatedSize() + Points.GetAllocatedSize();
+		}
+
+	private:
+
+		UMaterialInterface* Material;
+
+		FMaterialRelevance MaterialRelevance;
+
+		float RopeWidth;
+
+		int32 NumSides;
+
+		float TileMaterial;
+
+		/** Rope points in world space */
+		TArray<FVector> Points;
+
+		void BuildTube(TArray<FDynamicMeshVertex>& OutVertices, TArray<uint32>& OutIndices) const
+		{
+			OutVertices.SetNumUninitialized(Points.Num() * (NumSides + 1));
+			FGrapplingRopeMesh::BuildTubeVertices(Points, RopeWidth, NumSides, TileMaterial, Points.Num(), OutVertices.GetData());
+			FGrapplingRopeMesh::BuildTubeIndices(Points.Num(), NumSides, 0, OutIndices);
+		}
+	};
+}
+
+UGrapplingRopeComponent::UGrapplingRopeComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+	bTickInEditor = true;
+	bAutoActivate = true;
+
+	RopeLength = 100.f;
+	EndLocation = FVector(100.f, 0.f, 0.f);
+	RopeWidth = 3.f;
+	NumSides = 4;
+	TileMaterial = 1.f;
+	MaxSegments = 16;
+	MaxSolverIterations = 4;
+	FullDetailDistance = 1500.f;
+	SimulationDistance = 4000.f;
+	SagDistance = 10000.f;
+	Damping = 0.05f;
+	bBatchRendering = true;
+	BatchSlot = INDEX_NONE;
+	RopeLOD = EGrapplingRopeLOD::Sag;
+
+	SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+}
+
+void UGrapplingRopeComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	// Join the rope batch before the render state is created, a batched rope has no proxy of its own
+	UWorld* World = GetWorld();
+	if(bBatchRendering && World && World->IsGameWorld() && GetNetMode() != NM_DedicatedServer)
+	{
+		UGrapplingRopePoolSubsystem* RopePool = World->GetSubsystem<UGrapplingRopePoolSubsystem>();
+		UGrapplingRopeBatchComponent* RopeBatch = RopePool ? RopePool->GetRopeBatch() : nullptr;
+		if(RopeBatch && RopeBatch->CanBatch(this))
+		{
+			Batch = RopeBatch;
+			BatchSlot = RopeBatch->AddRope();
+		}
+	}
+
+	ResetShape();
+}
+
+void UGrapplingRopeComponent::OnUnregister()
+{
+	UGrapplingRopeBatchComponent* RopeBatch = Batch.Get();
+	if(RopeBatch && BatchSlot != INDEX_NONE)
+	{
+		RopeBatch->RemoveRope(BatchSlot);
+	}
+	Batch = nullptr;
+	BatchSlot = INDEX_NONE;
+
+	Super::OnUnregister();
+}
+
+void UGrapplingRopeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Dedicated servers never draw the rope
+	if(GetNetMode() == NM_DedicatedServer) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_RopeSolver);
+	CSV_SCOPED_TIMING_STAT(Grappling, RopeSolver);
+
+	const FVector Start = GetComponentLocation();
+	const FVector End = GetEndLocation();
+	EGrapplingRopeLOD NewLOD = SelectLOD(Start, End);
+
+	const int32 Segments = NewLOD == EGrapplingRopeLOD::Full ? MaxSegments : FMath::Max(MaxSegments / 2, 1);
+	const int32 Iterations = NewLOD == EGrapplingRopeLOD::Full ? MaxSolverIterations : 1;
+	if(NewLOD <= EGrapplingRopeLOD::Reduced)
+	{
+		// Past the budget of the frame the rope keeps its analytic shape, so the solver cost stays flat
+		// however many ropes are out
+		UGrapplingRopePoolSubsystem* RopePool = GetWorld()->GetSubsystem<UGrapplingRopePoolSubsystem>();
+		if(RopePool && !RopePool->ClaimRopeSolverBudget(Segments * Iterations))
+		{
+			NewLOD = EGrapplingRopeLOD::Sag;
+		}
+	}
+
+	switch(NewLOD)
+	{
+	case EGrapplingRopeLOD::Full:
+	case EGrapplingRopeLOD::Reduced:
+		if(RopeLOD > EGrapplingRopeLOD::Reduced || Solver.GetSegmentCount() != Segments)
+		{
+			Solver.Reset(Start, End, RopeLength, Segments);
+		}
+		Solver.Step(Start, End, RopeLength, FVector(0.f, 0.f, GetWorld()->GetGravityZ()), DeltaTime, Iterations, Damping);
+		Solver.GetPoints(Points);
+		break;
+
+	case EGrapplingRopeLOD::Sag:
+		FGrapplingRopeSolver::BuildSagApproximation(Start, End, RopeLength, FVector(0.f, 0.f, -1.f), FMath::Max(MaxSegments / 2, 1), Points);
+		break;
+
+	case EGrapplingRopeLOD::Straight:
+		Points.Reset();
+		Points.Add(Start);
+		Points.Add(End);
+		break;
+	}
+	RopeLOD = NewLOD;
+
+	// Batched ropes hand their points to the batch, which only rebuilds the ones that moved
+	if(UGrapplingRopeBatchComponent* RopeBatch = Batch.Get())
+	{
+		RopeBatch->UpdateRope(BatchSlot, Points, RopeWidth, TileMaterial);
+		return;
+	}
+
+	// Send the new points to the render thread, the bounds changed with them
+	MarkRenderDynamicDataDirty();
+	UpdateBounds();
+	MarkRenderTransformDirty();
+}
+
+void UGrapplingRopeComponent::SendRenderDynamicData_Concurrent()
+{
+	Super::SendRenderDynamicData_Concurrent();
+
+	if(SceneProxy)
+	{
+		FGrapplingRopeSceneProxy* RopeSceneProxy = static_cast<FGrapplingRopeSceneProxy*>(SceneProxy);
+		TArray<FVector> RenderPoints = Points;
+		ENQUEUE_RENDER_COMMAND(FSendGrapplingRopePoints)(
+			[RopeSceneProxy, RenderPoints = MoveTemp(RenderPoints)](FRHICommandListImmediate& RHICmdList) mutable
+			{
+				RopeSceneProxy->SetPoints_RenderThread(MoveTemp(RenderPoints));
+			});
+	}
+}
+
+void UGrapplingRopeComponent::CreateRenderState_Concurrent(FRegisterComponentContext* Context)
+{
+	Super::CreateRenderState_Concurrent(Context);
+
+	SendRenderDynamicData_Concurrent();
+}
+
+FPrimitiveSceneProxy* UGrapplingRopeComponent::CreateSceneProxy()
+{
+	// Parked ropes keep their batch, they are drawn by it again once unparked
+	if(Batch.IsValid()) return nullptr;
+	return new FGrapplingRopeSceneProxy(this);
+}
+
+FBoxSphereBounds UGrapplingRopeComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	// The points are already in world space
+	if(Points.Num() == 0)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector(RopeWidth), RopeWidth);
+	}
+	return FBoxSphereBounds(FBox(Points).ExpandBy(RopeWidth));
+}
+
+void UGrapplingRopeComponent::SetAttachEndToComponent(USceneComponent* Component)
+{
+	AttachEndTo = Component;
+}
+
+void UGrapplingRopeComponent::Park()
+{
+	AttachEndTo = nullptr;
+	UGrapplingRopeBatchComponent* RopeBatch = Batch.Get();
+	if(RopeBatch && BatchSlot != INDEX_NONE)
+	{
+		RopeBatch->RemoveRope(BatchSlot);
+	}
+	BatchSlot = INDEX_NONE;
+	SetComponentTickEnabled(false);
+	SetVisibility(false);
+}
+
+void UGrapplingRopeComponent::Unpark()
+{
+	if(UGrapplingRopeBatchComponent* RopeBatch = Batch.Get())
+	{
+		BatchSlot = RopeBatch->AddRope();
+	}
+	SetVisibility(true);
+	SetComponentTickEnabled(true);
+
+	// The parked rope still holds the shape it was released with
+	ResetShape();
+	MarkRenderDynamicDataDirty();
+	MarkRenderTransformDirty();
+}
+
+EGrapplingRopeLOD UGrapplingRopeComponent::SelectLOD(const FVector& Start, const FVector& End) const
+{
+	// Nobody looks at the rope, on servers or while it is off screen: keep a shape with the right bounds and nothing more
+	// Batched ropes are rendered as part of their batch
+	const UPrimitiveComponent* RenderedComponent = Batch.IsValid() ? static_cast<const UPrimitiveComponent*>(Batch.Get()) : this;
+	const TArray<FVector>& ViewLocations = GetWorld()->ViewLocationsRenderedLastFrame;
+	if(ViewLocations.Num() == 0 || !RenderedComponent->WasRecentlyRendered(0.2f))
+	{
+		return EGrapplingRopeLOD::Sag;
+	}
+
+	float ClosestDistance = BIG_NUMBER;
+	for(const FVector& ViewLocation : ViewLocations)
+	{
+		ClosestDistance = FMath::Min(ClosestDistance, FMath::PointDistToSegment(ViewLocation, Start, End));
+	}
+
+	if(ClosestDistance <= FullDetailDistance) return EGrapplingRopeLOD::Full;
+	if(ClosestDistance <= SimulationDistance) return EGrapplingRopeLOD::Reduced;
+	if(ClosestDistance <= SagDistance) return EGrapplingRopeLOD::Sag;
+	return EGrapplingRopeLOD::Straight;
+}
+
+FVector UGrapplingRopeComponent::GetEndLocation() const
+{
+	if(const USceneComponent* EndComponent = AttachEndTo.Get())
+	{
+		return EndComponent->GetComponentTransform().TransformPosition(EndLocation);
+	}
+	return GetComponentTransform().TransformPosition(EndLocation);
+}
+
+void UGrapplingRopeComponent::ResetShape()
+{
+	// Start from the resting shape, the solver is only set up once the rope is close enough
+	RopeLOD = EGrapplingRopeLOD::Sag;
+	FGrapplingRopeSolver::BuildSagApproximation(GetComponentLocation(), GetEndLocation(), RopeLength,
+	                                            FVector(0.f, 0.f, -1.f), FMath::Max(MaxSegments / 2, 1), Points);
+	UpdateBounds();
+	UGrapplingRopeBatchComponent* RopeBatch = Batch.Get();
+	if(RopeBatch && BatchSlot != INDEX_NONE)
+	{
+		RopeBatch->UpdateRope(BatchSlot, Points, RopeWidth, TileMaterial);
+	}
+}
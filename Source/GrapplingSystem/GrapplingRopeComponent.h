@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingRopeSolver.h"
+#include "Components/MeshComponent.h"
+#include "GrapplingRopeComponent.generated.h"
+
+class UGrapplingRopeBatchComponent;
+
+/** How much work a rope puts into its shape, from the closest to the farthest */
+UENUM(BlueprintType)
+enum class EGrapplingRopeLOD : uint8
+{
+	/** Simulated with every segment and solver iteration */
+	Full,
+
+	/** Simulated with fewer segments and a single solver iteration */
+	Reduced,
+
+	/** Analytic sagging shape, no simulation */
+	Sag,
+
+	/** Straight line between the two ends */
+	Straight
+};
+
+/**
+ * Rope drawn as a tube between the component and an end location, made for grappling ropes.
+ * Close to the camera it is simulated with a light position based solver. Farther away it uses
+ * fewer segments and iterations, then an analytic shape, then a straight line. Ropes that do not
+ * fit in the rope pool solver budget for the frame use the analytic shape too.
+ * In game, ropes are drawn together by the rope batch of the rope pool rather than one by one.
+ */
+UCLASS(ClassGroup = Rendering, meta = (BlueprintSpawnableComponent))
+class GRAPPLINGSYSTEM_API UGrapplingRopeComponent : public UMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingRopeComponent();
+
+	virtual void OnRegister() override;
+
+	virtual void OnUnregister() override;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	virtual void SendRenderDynamicData_Concurrent() override;
+
+	virtual void CreateRenderState_Concurrent(FRegisterComponentContext* Context) override;
+
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+	virtual int32 GetNumMaterials() const override { return 1; }
+
+	/** Attaches the end of the rope to a component, EndLocation becomes relative to it. Pass nullptr to detach */
+	void SetAttachEndToComponent(USceneComponent* Component);
+
+	/** Puts the rope away while it waits in the rope pool: hidden, not ticking and out of the rope batch, but still registered */
+	void Park();
+
+	/** Brings a parked rope back, starting again from its resting shape */
+	void Unpark();
+
+	/** Current detail level of the rope */
+	UFUNCTION(BlueprintPure, Category = "Rope")
+	EGrapplingRopeLOD GetRopeLOD() const { return RopeLOD; }
+
+	/** Rest length of the rope */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope", meta = (ClampMin = "0.0"))
+	float RopeLength;
+
+	/** End of the rope, relative to the attached end component, or to this component if there is none */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope")
+	FVector EndLocation;
+
+	/** Rope width in the rendered tube */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Rendering", meta = (ClampMin = "0.01"))
+	float RopeWidth;
+
+	/** Sides of the rendered tube */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Rendering", meta = (ClampMin = "3", ClampMax = "16"))
+	int32 NumSides;
+
+	/** Texture repeats per 100 units of rope */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Rendering")
+	float TileMaterial;
+
+	/** Segments of the rope at full detail. Every lower level halves them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Budget", meta = (ClampMin = "1", ClampMax = "64"))
+	int32 MaxSegments;
+
+	/** Solver iterations per frame at full detail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Budget", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 MaxSolverIterations;
+
+	/** Farthest distance to the camera at which the rope is simulated with full detail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Budget")
+	float FullDetailDistance;
+
+	/** Farthest distance to the camera at which the rope is simulated at all */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Budget")
+	float SimulationDistance;
+
+	/** Farthest distance to the camera at which the rope sags, beyond it the rope is a straight line */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Budget")
+	float SagDistance;
+
+	/** Draw the rope with the other grapple ropes of the world, in a single merged mesh. Ropes whose
+	 *  material, sides or segments do not match the rope batch are drawn on their own regardless */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Rendering")
+	bool bBatchRendering;
+
+	/** Fraction of the velocity lost every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rope Simulation", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float Damping;
+
+private:
+
+	/** Component the end of the rope is attached to */
+	UPROPERTY()
+	TWeakObjectPtr<USceneComponent> AttachEndTo;
+
+	FGrapplingRopeSolver Solver;
+
+	/** Rope batch drawing the rope, if any */
+	TWeakObjectPtr<UGrapplingRopeBatchComponent> Batch;
+
+	/** Slot of the rope in its batch */
+	int32 BatchSlot;
+
+	/** Rope points in world space, from the component to the end */
+	TArray<FVector> Points;
+
+	EGrapplingRopeLOD RopeLOD;
+
+	/** Picks the detail level from the distance to the closest view */
+	EGrapplingRopeLOD SelectLOD(const FVector& Start, const FVector& End) const;
+
+	FVector GetEndLocation() const;
+
+	/** Lays the rope out in its resting shape, dropping the previous one */
+	void ResetShape();
+};
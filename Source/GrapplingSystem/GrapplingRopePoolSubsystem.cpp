@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingRopePoolSubsystem.h"
+
+#include "GrapplingRopeBatchComponent.h"
+#include "GrapplingRopeComponent.h"
+#include "GrapplingStats.h"
+#include "RopeGuide.h"
+#include "Materials/Material.h"
+
+UGrapplingRopePoolSubsystem::UGrapplingRopePoolSubsystem()
+{
+	RopeGuidePoolSize = 8;
+	RopePoolSize = 8;
+	RopeSolverBudget = 1024;
+	RopeOwner = nullptr;
+	RopeBatch = nullptr;
+	LoadedRopeMaterial = nullptr;
+	RopeGuideMisses = 0;
+	RopeMisses = 0;
+	RemainingRopeSolverBudget = 0;
+	RopeSolverBudgetFrame = 0;
+}
+
+void UGrapplingRopePoolSubsystem::Deinitialize()
+{
+	// The pooled actors belong to the world and are torn down with it
+	RopeGuidePools.Empty();
+	FreeRopes.Empty();
+	RopeOwner = nullptr;
+	RopeBatch = nullptr;
+	LoadedRopeMaterial = nullptr;
+	Super::Deinitialize();
+}
+
+void UGrapplingRopePoolSubsystem::Prewarm(TSubclassOf<ARopeGuide> RopeGuideClass)
+{
+	if(RopeGuideClass)
+	{
+		FGrapplingRopeGuidePool& Pool = RopeGuidePools.FindOrAdd(RopeGuideClass);
+		while(Pool.Free.Num() < RopeGuidePoolSize)
+		{
+			ARopeGuide* RopeGuide = SpawnRopeGuide(RopeGuideClass, FTransform::Identity);
+			if(!RopeGuide) break;
+			ParkRopeGuide(RopeGuide);
+		}
+	}
+
+	while(FreeRopes.Num() < RopePoolSize)
+	{
+		FreeRopes.Add(CreateRope());
+	}
+}
+
+ARopeGuide* UGrapplingRopePoolSubsystem::AcquireRopeGuide(TSubclassOf<ARopeGuide> RopeGuideClass, const FTransform& Transform)
+{
+	if(!RopeGuideClass) return nullptr;
+
+	FGrapplingRopeGuidePool& Pool = RopeGuidePools.FindOrAdd(RopeGuideClass);
+	while(Pool.Free.Num() > 0)
+	{
+		ARopeGuide* RopeGuide = Pool.Free.Pop(false);
+		if(!IsValid(RopeGuide)) continue;
+
+		RopeGuide->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		RopeGuide->SetActorHiddenInGame(false);
+		FGrapplingCounters::AddLiveRopeGuides(1);
+		return RopeGuide;
+	}
+
+	RopeGuideMisses++;
+	ARopeGuide* RopeGuide = SpawnRopeGuide(RopeGuideClass, Transform);
+	if(RopeGuide) FGrapplingCounters::AddLiveRopeGuides(1);
+	return RopeGuide;
+}
+
+void UGrapplingRopePoolSubsystem::ReleaseRopeGuide(ARopeGuide* RopeGuide)
+{
+	if(!IsValid(RopeGuide)) return;
+
+	FGrapplingCounters::AddLiveRopeGuides(-1);
+	ParkRopeGuide(RopeGuide);
+}
+
+void UGrapplingRopePoolSubsystem::ParkRopeGuide(ARopeGuide* RopeGuide)
+{
+	RopeGuide->StopFlight();
+	RopeGuide->SetActorHiddenInGame(true);
+	RopeGuidePools.FindOrAdd(RopeGuide->GetClass()).Free.Add(RopeGuide);
+}
+
+UGrapplingRopeComponent* UGrapplingRopePoolSubsystem::AcquireRope()
+{
+	UGrapplingRopeComponent* Rope = nullptr;
+	while(!Rope && FreeRopes.Num() > 0)
+	{
+		Rope = FreeRopes.Pop(false);
+		if(!IsValid(Rope)) Rope = nullptr;
+	}
+
+	if(!Rope)
+	{
+		RopeMisses++;
+		Rope = CreateRope();
+	}
+
+	// Ropes are registered once and parked between uses, so acquiring one does not recreate its render state
+	if(Rope->IsRegistered())
+	{
+		Rope->Unpark();
+	}
+	else
+	{
+		Rope->RegisterComponent();
+	}
+	return Rope;
+}
+
+void UGrapplingRopePoolSubsystem::ReleaseRope(UGrapplingRopeComponent* Rope)
+{
+	if(!IsValid(Rope)) return;
+
+	Rope->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	Rope->Park();
+	FreeRopes.Add(Rope);
+}
+
+bool UGrapplingRopePoolSubsystem::ClaimRopeSolverBudget(int32 Cost)
+{
+	if(RopeSolverBudgetFrame != GFrameCounter)
+	{
+		RopeSolverBudgetFrame = GFrameCounter;
+		RemainingRopeSolverBudget = RopeSolverBudget;
+	}
+
+	if(Cost > RemainingRopeSolverBudget) return false;
+	RemainingRopeSolverBudget -= Cost;
+	return true;
+}
+
+ARopeGuide* UGrapplingRopePoolSubsystem::SpawnRopeGuide(UClass* RopeGuideClass, const FTransform& Transform)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<ARopeGuide>(RopeGuideClass, Transform, SpawnParams);
+}
+
+UGrapplingRopeComponent* UGrapplingRopePoolSubsystem::CreateRope()
+{
+	// Let the engine pick a unique name, a fixed one collides when a new rope is created
+	// before the previous one has been garbage collected
+	AActor* Owner = GetRopeOwner();
+	const FName RopeName = MakeUniqueObjectName(Owner, UGrapplingRopeComponent::StaticClass(), FName("ThrowableRope"));
+	UGrapplingRopeComponent* Rope = NewObject<UGrapplingRopeComponent>(Owner, UGrapplingRopeComponent::StaticClass(), RopeName);
+	// The same material as the rope batch, so the rope is drawn by it
+	Rope->SetMaterial(0, GetRopeMaterial());
+	return Rope;
+}
+
+UGrapplingRopeBatchComponent* UGrapplingRopePoolSubsystem::GetRopeBatch()
+{
+	if(!RopeBatch)
+	{
+		// The ropes are in world space, so the batch stays at the origin with its owner
+		RopeBatch = NewObject<UGrapplingRopeBatchComponent>(GetRopeOwner(), TEXT("RopeBatch"));
+		RopeBatch->RopeMaterial = GetRopeMaterial();
+		RopeBatch->RegisterComponent();
+	}
+	return RopeBatch;
+}
+
+UMaterialInterface* UGrapplingRopePoolSubsystem::GetRopeMaterial()
+{
+	if(!LoadedRopeMaterial)
+	{
+		LoadedRopeMaterial = RopeMaterial.LoadSynchronous();
+		if(!LoadedRopeMaterial)
+		{
+			LoadedRopeMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+		}
+	}
+	return LoadedRopeMaterial;
+}
+
+AActor* UGrapplingRopePoolSubsystem::GetRopeOwner()
+{
+	if(!RopeOwner)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		RopeOwner = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+	}
+	return RopeOwner;
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingRopePoolSubsystem.generated.h"
+
+class ARopeGuide;
+class UGrapplingRopeBatchComponent;
+class UGrapplingRopeComponent;
+class UMaterialInterface;
+
+/** Free rope guides of a single class */
+USTRUCT()
+struct FGrapplingRopeGuidePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<ARopeGuide*> Free;
+};
+
+/**
+ * Preallocated rope guides and rope components, so throwing a rope does not spawn or
+ * destroy anything once the pools are warm. Also shares the rope solver budget of the frame
+ * between the ropes in use.
+ */
+UCLASS(config=Game)
+class GRAPPLINGSYSTEM_API UGrapplingRopePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingRopePoolSubsystem();
+
+	virtual void Deinitialize() override;
+
+	/** Fills the pools up to their configured size. Called by the characters when they begin play */
+	void Prewarm(TSubclassOf<ARopeGuide> RopeGuideClass);
+
+	/** Takes a rope guide from the pool, spawning one if the pool is empty */
+	ARopeGuide* AcquireRopeGuide(TSubclassOf<ARopeGuide> RopeGuideClass, const FTransform& Transform);
+
+	/** Hides a rope guide and gives it back to the pool */
+	void ReleaseRopeGuide(ARopeGuide* RopeGuide);
+
+	/** Takes a rope from the pool, creating one if the pool is empty. The rope is registered and visible on return */
+	UGrapplingRopeComponent* AcquireRope();
+
+	/** Detaches a rope and parks it in the pool, still registered */
+	void ReleaseRope(UGrapplingRopeComponent* Rope);
+
+	/** Merged mesh the ropes of the world are drawn with, created on first use */
+	UGrapplingRopeBatchComponent* GetRopeBatch();
+
+	/**
+	 * Takes Cost from the rope solver budget of the frame, counted in segment iterations.
+	 * Returns false, without taking anything, when the budget cannot afford it
+	 */
+	bool ClaimRopeSolverBudget(int32 Cost);
+
+	/** Number of rope guides that had to be spawned because the pool was empty */
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	int32 GetRopeGuideMisses() const { return RopeGuideMisses; }
+
+	/** Number of ropes that had to be created because the pool was empty */
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	int32 GetRopeMisses() const { return RopeMisses; }
+
+protected:
+
+	/** Number of rope guides preallocated for each rope guide class */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 RopeGuidePoolSize;
+
+	/** Number of rope components preallocated */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 RopePoolSize;
+
+	/** Rope segment iterations that can be simulated in a frame, over all the ropes */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 RopeSolverBudget;
+
+	/** Material of the pooled ropes and of the rope batch drawing them. The engine default material if unset */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	TSoftObjectPtr<UMaterialInterface> RopeMaterial;
+
+	/** Free rope guides, by class */
+	UPROPERTY()
+	TMap<UClass*, FGrapplingRopeGuidePool> RopeGuidePools;
+
+	/** Free rope components */
+	UPROPERTY()
+	TArray<UGrapplingRopeComponent*> FreeRopes;
+
+	/** Actor owning the pooled ropes while they are not in use, and the rope batch */
+	UPROPERTY()
+	AActor* RopeOwner;
+
+	UPROPERTY()
+	UGrapplingRopeBatchComponent* RopeBatch;
+
+	/** RopeMaterial once loaded */
+	UPROPERTY()
+	UMaterialInterface* LoadedRopeMaterial;
+
+	int32 RopeGuideMisses;
+
+	int32 RopeMisses;
+
+	/** Rope solver budget left in the frame */
+	int32 RemainingRopeSolverBudget;
+
+	/** Frame the remaining budget belongs to */
+	uint64 RopeSolverBudgetFrame;
+
+	ARopeGuide* SpawnRopeGuide(UClass* RopeGuideClass, const FTransform& Transform);
+
+	/** Hides a rope guide and puts it in the free list of its class */
+	void ParkRopeGuide(ARopeGuide* RopeGuide);
+
+	UGrapplingRopeComponent* CreateRope();
+
+	/** Loads the rope material on first use */
+	UMaterialInterface* GetRopeMaterial();
+
+	AActor* GetRopeOwner();
+};
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingRopeSolver.h"
+
+void FGrapplingRopeSolver::Reset(const FVector& Start, const FVector& End, float Length, int32 SegmentCount)
+{
+	ParticleCount = FMath::Max(SegmentCount, 1) + 1;
+
+	TArray<FVector> Points;
+	BuildSagApproximation(Start, End, Length, FVector(0.f, 0.f, -1.f), ParticleCount - 1, Points);
+
+	// The padding particles are never read back, they only keep the vector loops in bounds
+	const int32 PaddedCount = Align(ParticleCount, 4);
+	for(TArray<float>* Array : {&X, &Y, &Z, &PreviousX, &PreviousY, &PreviousZ})
+	{
+		Array->SetNumZeroed(PaddedCount);
+	}
+	for(int32 i = 0; i < ParticleCount; i++)
+	{
+		X[i] = PreviousX[i] = Points[i].X;
+		Y[i] = PreviousY[i] = Points[i].Y;
+		Z[i] = PreviousZ[i] = Points[i].Z;
+	}
+}
+
+void FGrapplingRopeSolver::Step(const FVector& Start, const FVector& End, float Length, const FVector& Gravity,
+                                float DeltaTime, int32 Iterations, float Damping)
+{
+	if(ParticleCount < 2) return;
+
+	Integrate(Gravity, DeltaTime, Damping);
+	Pin(0, Start);
+	Pin(ParticleCount - 1, End);
+
+	const float RestLength = Length / (ParticleCount - 1);
+	for(int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		SolveSegments(0, RestLength);
+		SolveSegments(1, RestLength);
+	}
+}
+
+void FGrapplingRopeSolver::GetPoints(TArray<FVector>& OutPoints) const
+{
+	OutPoints.SetNumUninitialized(ParticleCount);
+	for(int32 i = 0; i < ParticleCount; i++)
+	{
+		OutPoints[i] = FVector(X[i], Y[i], Z[i]);
+	}
+}
+
+void FGrapplingRopeSolver::BuildSagApproximation(const FVector& Start, const FVector& End, float Length, const FVector& Down,
+                                                 int32 SegmentCount, TArray<FVector>& OutPoints)
+{
+	SegmentCount = FMath::Max(SegmentCount, 1);
+	OutPoints.SetNumUninitialized(SegmentCount + 1);
+
+	// A parabola of span D and sag S is about D + 8 S^2 / 3 D long, solved for S
+	const float Span = FVector::Dist(Start, End);
+	const float Sag = Length > Span && Span > KINDA_SMALL_NUMBER ? FMath::Sqrt(3.f * Span * (Length - Span) / 8.f) : 0.f;
+	for(int32 i = 0; i <= SegmentCount; i++)
+	{
+		const float Alpha = float(i) / SegmentCount;
+		OutPoints[i] = FMath::Lerp(Start, End, Alpha) + Down * (4.f * Sag * Alpha * (1.f - Alpha));
+	}
+}
+
+void FGrapplingRopeSolver::Integrate(const FVector& Gravity, float DeltaTime, float Damping)
+{
+	// Verlet: the distance moved last step is the velocity
+	const VectorRegister Keep = VectorSetFloat1(1.f - Damping);
+	const float TimeSquared = DeltaTime * DeltaTime;
+	float* Positions[3] = {X.GetData(), Y.GetData(), Z.GetData()};
+	float* PreviousPositions[3] = {PreviousX.GetData(), PreviousY.GetData(), PreviousZ.GetData()};
+
+	for(int32 Axis = 0; Axis < 3; Axis++)
+	{
+		const VectorRegister Acceleration = VectorSetFloat1(Gravity[Axis] * TimeSquared);
+		float* Position = Positions[Axis];
+		float* PreviousPosition = PreviousPositions[Axis];
+		for(int32 i = 0; i < X.Num(); i += 4)
+		{
+			const VectorRegister Current = VectorLoad(Position + i);
+			const VectorRegister Velocity = VectorMultiply(VectorSubtract(Current, VectorLoad(PreviousPosition + i)), Keep);
+			VectorStore(Current, PreviousPosition + i);
+			VectorStore(VectorAdd(Current, VectorAdd(Velocity, Acceleration)), Position + i);
+		}
+	}
+}
+
+void FGrapplingRopeSolver::SolveSegments(int32 FirstSegment, float RestLength)
+{
+	const int32 LastParticle = ParticleCount - 1;
+	for(int32 i = FirstSegment; i < LastParticle; i += 2)
+	{
+		const int32 j = i + 1;
+		const float DeltaX = X[j] - X[i];
+		const float DeltaY = Y[j] - Y[i];
+		const float DeltaZ = Z[j] - Z[i];
+		const float Distance = FMath::Sqrt(DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ);
+		if(Distance < KINDA_SMALL_NUMBER) continue;
+
+		// The pinned ends do not move, their neighbour takes the whole correction
+		const float WeightI = i == 0 ? 0.f : 1.f;
+		const float WeightJ = j == LastParticle ? 0.f : 1.f;
+		const float WeightSum = WeightI + WeightJ;
+		if(WeightSum == 0.f) continue;
+
+		const float Correction = (Distance - RestLength) / (Distance * WeightSum);
+		X[i] += DeltaX * Correction * WeightI;
+		Y[i] += DeltaY * Correction * WeightI;
+		Z[i] += DeltaZ * Correction * WeightI;
+		X[j] -= DeltaX * Correction * WeightJ;
+		Y[j] -= DeltaY * Correction * WeightJ;
+		Z[j] -= DeltaZ * Correction * WeightJ;
+	}
+}
+
+void FGrapplingRopeSolver::Pin(int32 Index, const FVector& Location)
+{
+	X[Index] = PreviousX[Index] = Location.X;
+	Y[Index] = PreviousY[Index] = Location.Y;
+	Z[Index] = PreviousZ[Index] = Location.Z;
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Position based rope solver. Particles are kept as separate X, Y and Z arrays padded to a
+ * multiple of four, so integration runs four particles at a time with vector instructions, and
+ * distance constraints are solved in two alternating passes of independent segments.
+ * Both ends are pinned to the locations given to Step.
+ */
+struct GRAPPLINGSYSTEM_API FGrapplingRopeSolver
+{
+	/** Lays out the particles on the analytic rope shape, without velocity */
+	void Reset(const FVector& Start, const FVector& End, float Length, int32 SegmentCount);
+
+	/** Integrates the particles and relaxes the segment lengths */
+	void Step(const FVector& Start, const FVector& End, float Length, const FVector& Gravity, float DeltaTime, int32 Iterations, float Damping);
+
+	/** Number of segments the rope was laid out with */
+	int32 GetSegmentCount() const { return ParticleCount - 1; }
+
+	/** Copies the particle locations, from start to end */
+	void GetPoints(TArray<FVector>& OutPoints) const;
+
+	/**
+	 * Rope shape without simulation: a parabola sagging so its length roughly matches Length,
+	 * which is close to a catenary for the slack of a thrown rope. A taut rope is a straight line
+	 */
+	static void BuildSagApproximation(const FVector& Start, const FVector& End, float Length, const FVector& Down,
+	                                  int32 SegmentCount, TArray<FVector>& OutPoints);
+
+private:
+
+	int32 ParticleCount = 0;
+
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	TArray<float> PreviousX;
+	TArray<float> PreviousY;
+	TArray<float> PreviousZ;
+
+	void Integrate(const FVector& Gravity, float DeltaTime, float Damping);
+
+	/** Moves the ends of every other segment, starting from FirstSegment, towards their rest length */
+	void SolveSegments(int32 FirstSegment, float RestLength);
+
+	void Pin(int32 Index, const FVector& Location);
+};
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingSignificanceSubsystem.h"
+
+#include "GrapplingPoint.h"
+#include "GrapplingStats.h"
+#include "SignificanceManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+namespace
+{
+	const FName GrapplingPointTag(TEXT("GrapplingPoint"));
+}
+
+UGrapplingSignificanceSubsystem::UGrapplingSignificanceSubsystem()
+{
+	ActiveDistance = 10000.f;
+	VisibleDistance = 25000.f;
+	BehindViewDistanceScale = 3.f;
+	bEnabled = false;
+}
+
+void UGrapplingSignificanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Servers have no views to sort by
+	const UWorld* World = GetWorld();
+	bEnabled = World && World->IsGameWorld() && World->GetNetMode() != NM_DedicatedServer;
+}
+
+void UGrapplingSignificanceSubsystem::Deinitialize()
+{
+	bEnabled = false;
+	Super::Deinitialize();
+}
+
+void UGrapplingSignificanceSubsystem::RegisterPoint(AGrapplingPoint* Point)
+{
+	USignificanceManager* SignificanceManager = bEnabled ? USignificanceManager::Get(GetWorld()) : nullptr;
+	if(!SignificanceManager || !Point) return;
+
+	// Runs on worker threads during the update, only reads the point location and the settings
+	auto Significance = [this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+	{
+		return GetSignificance(CastChecked<AGrapplingPoint>(ObjectInfo->GetObject())->GetActorLocation(), Viewpoint);
+	};
+
+	// Runs on the game thread once the best significance over all views is known
+	auto PostSignificance = [](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float NewSignificance, bool bFinal)
+	{
+		CastChecked<AGrapplingPoint>(ObjectInfo->GetObject())->SetLOD(GetLOD(NewSignificance));
+	};
+
+	SignificanceManager->RegisterObject(Point, GrapplingPointTag, Significance, USignificanceManager::EPostSignificanceType::Sequential, PostSignificance);
+}
+
+void UGrapplingSignificanceSubsystem::UnregisterPoint(AGrapplingPoint* Point)
+{
+	if(USignificanceManager* SignificanceManager = bEnabled ? USignificanceManager::Get(GetWorld()) : nullptr)
+	{
+		SignificanceManager->UnregisterObject(Point);
+	}
+}
+
+void UGrapplingSignificanceSubsystem::Tick(float DeltaTime)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if(!SignificanceManager) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_Significance);
+
+	TArray<FTransform, TInlineAllocator<4>> Viewpoints;
+	for(FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if(PlayerController && PlayerController->IsLocalController())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			Viewpoints.Add(FTransform(Rotation, Location));
+		}
+	}
+
+	// Without views, keep the tiers as they are rather than putting everything to sleep
+	if(Viewpoints.Num() > 0)
+	{
+		SignificanceManager->Update(Viewpoints);
+	}
+}
+
+bool UGrapplingSignificanceSubsystem::IsTickable() const
+{
+	return bEnabled;
+}
+
+ETickableTickType UGrapplingSignificanceSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UGrapplingSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGrapplingSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+float UGrapplingSignificanceSubsystem::GetSignificance(const FVector& Location, const FTransform& Viewpoint) const
+{
+	const FVector ToPoint = Location - Viewpoint.GetLocation();
+	float Distance = ToPoint.Size();
+	if(FVector::DotProduct(ToPoint, Viewpoint.GetUnitAxis(EAxis::X)) < 0.f)
+	{
+		Distance *= BehindViewDistanceScale;
+	}
+
+	if(Distance <= ActiveDistance) return 2.f;
+	if(Distance <= VisibleDistance) return 1.f;
+	return 0.f;
+}
+
+EGrapplingPointLOD UGrapplingSignificanceSubsystem::GetLOD(float Significance)
+{
+	if(Significance >= 2.f) return EGrapplingPointLOD::Active;
+	if(Significance >= 1.f) return EGrapplingPointLOD::Visible;
+	return EGrapplingPointLOD::Dormant;
+}
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingSignificanceSubsystem.generated.h"
+
+class AGrapplingPoint;
+
+/** How much of a grappling point is kept running, from the most to the least */
+UENUM(BlueprintType)
+enum class EGrapplingPointLOD : uint8
+{
+	/** Everything on: ticking, widget and full mesh */
+	Active,
+
+	/** Drawn with its cheapest mesh LOD, widget asleep */
+	Visible,
+
+	/** Hidden */
+	Dormant
+};
+
+/**
+ * Sorts the grappling points in LOD tiers with the significance manager, from their distance to
+ * the local players views, and whether they are in front of them. Points far away or behind every
+ * view stop ticking and hide their widget and mesh. They stay in the physics scene whatever their
+ * tier, since they can be grappled from farther away than the tiers reach.
+ * Updated once per frame from the views of the local players. Not used on dedicated servers.
+ */
+UCLASS(config=Game)
+class GRAPPLINGSYSTEM_API UGrapplingSignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingSignificanceSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	/** Puts a point under significance management. It starts in the tier given by its distance on the next update */
+	void RegisterPoint(AGrapplingPoint* Point);
+
+	void UnregisterPoint(AGrapplingPoint* Point);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	// End of FTickableGameObject interface
+
+protected:
+
+	/** Farthest distance to a view at which points are active */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float ActiveDistance;
+
+	/** Farthest distance to a view at which points are drawn */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float VisibleDistance;
+
+	/** Points behind a view count as this many times farther from it */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float BehindViewDistanceScale;
+
+	/** Is significance managed in this world? */
+	bool bEnabled;
+
+	/** Significance of a point for a view, higher for the more detailed tiers */
+	float GetSignificance(const FVector& Location, const FTransform& Viewpoint) const;
+
+	static EGrapplingPointLOD GetLOD(float Significance);
+};
@@ -0,0 +1,362 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingSimulationSubsystem.h"
+
+#include "GrapplingStats.h"
+#include "GrapplingTrajectory.h"
+#include "RopeGuide.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GrappleCore/GrappleCore.h"
+
+constexpr int32 UGrapplingSimulationSubsystem::MaxLeapSteps;
+constexpr int32 UGrapplingSimulationSubsystem::BatchSize;
+
+void FGrapplingSimulationTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+                                                   const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if(Target && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->Simulate(DeltaTime);
+	}
+}
+
+FString FGrapplingSimulationTickFunction::DiagnosticMessage()
+{
+	return TEXT("FGrapplingSimulationTickFunction");
+}
+
+UGrapplingSimulationSubsystem::UGrapplingSimulationSubsystem()
+{
+	bFixedTimeStep = false;
+	FixedStepRate = 120.f;
+	FixedStepAccumulator = 0.f;
+	SimulationStep = 0;
+}
+
+void UGrapplingSimulationSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Target = this;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UGrapplingSimulationSubsystem::Deinitialize()
+{
+	if(TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Target = nullptr;
+
+	Leaps = FLeapArrays();
+	RopeFlights = FRopeFlightArrays();
+	LeapIndices.Empty();
+	RopeFlightIndices.Empty();
+	Super::Deinitialize();
+}
+
+int32 UGrapplingSimulationSubsystem::AddLeap(const FGrapplingTrajectory& Trajectory, float Duration, float MaxStepTime, float ElapsedTime)
+{
+	const int32 Index = Leaps.Handles.Num();
+	ElapsedTime = FMath::Clamp(ElapsedTime, 0.f, Duration);
+	const int32 Handle = LeapIndices.Add(Index);
+
+	Leaps.Starts.Add(Trajectory.Start);
+	Leaps.Ends.Add(Trajectory.End);
+	Leaps.Ups.Add(Trajectory.Up);
+	Leaps.Curves.Add(Trajectory.Curve);
+	Leaps.Profiles.Add(Trajectory.Profile);
+	Leaps.ElapsedTimes.Add(ElapsedTime);
+	Leaps.PreviousElapsedTimes.Add(ElapsedTime);
+	Leaps.Durations.Add(Duration);
+	Leaps.MaxStepTimes.Add(FMath::Max(MaxStepTime, KINDA_SMALL_NUMBER));
+	Leaps.Alphas.Add(Duration > 0.f ? ElapsedTime / Duration : 0.f);
+	Leaps.StepCounts.Add(0);
+	Leaps.StepFromTimes.Add(ElapsedTime);
+	Leaps.StepToTimes.Add(ElapsedTime);
+	Leaps.Steps.AddUninitialized(MaxLeapSteps);
+	Leaps.Handles.Add(Handle);
+	return Handle;
+}
+
+void UGrapplingSimulationSubsystem::RemoveLeap(int32 Handle)
+{
+	if(!LeapIndices.IsValidIndex(Handle)) return;
+
+	RemoveLeapAt(LeapIndices[Handle]);
+	LeapIndices.RemoveAt(Handle);
+}
+
+int32 UGrapplingSimulationSubsystem::AdvanceLeap(int32 Handle, float FromTime, float ToTime, FVector* OutSteps)
+{
+	if(!LeapIndices.IsValidIndex(Handle)) return 0;
+
+	const int32 Index = LeapIndices[Handle];
+	const float Duration = Leaps.Durations[Index];
+	FromTime = FMath::Clamp(FromTime, 0.f, Duration);
+	ToTime = FMath::Clamp(ToTime, FromTime, Duration);
+
+	// The leap follows the time of its character from now on
+	Leaps.ElapsedTimes[Index] = ToTime;
+	Leaps.PreviousElapsedTimes[Index] = ToTime;
+	Leaps.Alphas[Index] = Duration > 0.f ? ToTime / Duration : 1.f;
+
+	// Usually the character moves by the frame the parallel pass already computed, they can only be taken once
+	int32 StepCount = Leaps.StepCounts[Index];
+	Leaps.StepCounts[Index] = 0;
+	if(StepCount > 0 && FMath::IsNearlyEqual(FromTime, Leaps.StepFromTimes[Index], KINDA_SMALL_NUMBER)
+	   && FMath::IsNearlyEqual(ToTime, Leaps.StepToTimes[Index], KINDA_SMALL_NUMBER))
+	{
+		FMemory::Memcpy(OutSteps, Leaps.Steps.GetData() + Index * MaxLeapSteps, StepCount * sizeof(FVector));
+		return StepCount;
+	}
+
+	StepCount = GrappleCore::SubStepCount(ToTime - FromTime, Leaps.MaxStepTimes[Index], MaxLeapSteps);
+	float StepAlphas[MaxLeapSteps];
+	GrappleCore::SubStepAlphas(Duration > 0.f ? FromTime / Duration : 1.f, Leaps.Alphas[Index], StepCount, StepAlphas);
+
+	const FGrapplingTrajectory Trajectory(Leaps.Starts[Index], Leaps.Ends[Index], Leaps.Ups[Index], Leaps.Curves[Index], Leaps.Profiles[Index]);
+	Trajectory.GetLocations(StepAlphas, OutSteps, StepCount);
+	return StepCount;
+}
+
+int32 UGrapplingSimulationSubsystem::StepLeap(int32 Handle, float& ElapsedTime, float& PreviousElapsedTime, int32 StepCount,
+                                              float Interpolation, FVector* OutSteps, FVector& OutDrawnLocation)
+{
+	if(!LeapIndices.IsValidIndex(Handle)) return 0;
+
+	const int32 Index = LeapIndices[Handle];
+	const float Duration = Leaps.Durations[Index];
+	StepCount = FMath::Clamp(StepCount, 0, MaxLeapSteps);
+
+	// One location per step, at its end, and the drawn one after them
+	float StepAlphas[MaxLeapSteps + 1];
+	const float StepTime = GetFixedStepTime();
+	for(int32 Step = 0; Step < StepCount; Step++)
+	{
+		PreviousElapsedTime = ElapsedTime;
+		ElapsedTime = FMath::Min(ElapsedTime + StepTime, Duration);
+		StepAlphas[Step] = Duration > 0.f ? ElapsedTime / Duration : 1.f;
+	}
+	const float DrawnTime = FMath::Lerp(PreviousElapsedTime, ElapsedTime, FMath::Clamp(Interpolation, 0.f, 1.f));
+	StepAlphas[StepCount] = Duration > 0.f ? DrawnTime / Duration : 1.f;
+
+	Leaps.ElapsedTimes[Index] = ElapsedTime;
+	Leaps.PreviousElapsedTimes[Index] = PreviousElapsedTime;
+	Leaps.Alphas[Index] = StepAlphas[StepCount];
+	Leaps.StepCounts[Index] = 0;
+
+	FVector Locations[MaxLeapSteps + 1];
+	const FGrapplingTrajectory Trajectory(Leaps.Starts[Index], Leaps.Ends[Index], Leaps.Ups[Index], Leaps.Curves[Index], Leaps.Profiles[Index]);
+	Trajectory.GetLocations(StepAlphas, Locations, StepCount + 1);
+	FMemory::Memcpy(OutSteps, Locations, StepCount * sizeof(FVector));
+	OutDrawnLocation = Locations[StepCount];
+	return StepCount;
+}
+
+float UGrapplingSimulationSubsystem::GetLeapAlpha(int32 Handle) const
+{
+	return LeapIndices.IsValidIndex(Handle) ? Leaps.Alphas[LeapIndices[Handle]] : 1.f;
+}
+
+bool UGrapplingSimulationSubsystem::IsLeapFinished(int32 Handle) const
+{
+	return GetLeapAlpha(Handle) >= 1.f;
+}
+
+int32 UGrapplingSimulationSubsystem::AddRopeFlight(ARopeGuide* RopeGuide, const FVector& Start, const FVector& End, float Duration)
+{
+	const int32 Index = RopeFlights.Handles.Num();
+	const int32 Handle = RopeFlightIndices.Add(Index);
+
+	RopeFlights.Starts.Add(Start);
+	RopeFlights.Ends.Add(End);
+	RopeFlights.ElapsedTimes.Add(0.f);
+	RopeFlights.PreviousElapsedTimes.Add(0.f);
+	RopeFlights.Durations.Add(Duration);
+	RopeFlights.Alphas.Add(0.f);
+	RopeFlights.Locations.Add(Start);
+	RopeFlights.RopeGuides.Add(RopeGuide);
+	RopeFlights.Handles.Add(Handle);
+	return Handle;
+}
+
+void UGrapplingSimulationSubsystem::RemoveRopeFlight(int32 Handle)
+{
+	if(!RopeFlightIndices.IsValidIndex(Handle)) return;
+
+	RemoveRopeFlightAt(RopeFlightIndices[Handle]);
+	RopeFlightIndices.RemoveAt(Handle);
+}
+
+void UGrapplingSimulationSubsystem::Simulate(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_Simulation);
+	CSV_SCOPED_TIMING_STAT(Grappling, Simulation);
+
+	int32 StepCount = 1;
+	float Interpolation = 1.f;
+	if(bFixedTimeStep)
+	{
+		// Long frames drop the time past the sub-step limit rather than falling further behind
+		const float StepTime = GetFixedStepTime();
+		FixedStepAccumulator = FMath::Min(FixedStepAccumulator + DeltaTime, StepTime * (MaxLeapSteps + 1));
+		StepCount = FMath::Min(FMath::FloorToInt(FixedStepAccumulator / StepTime), MaxLeapSteps);
+		FixedStepAccumulator = FMath::Max(FixedStepAccumulator - StepCount * StepTime, 0.f);
+		Interpolation = FMath::Min(FixedStepAccumulator / StepTime, 1.f);
+	}
+	SimulationStep += StepCount;
+
+	SimulateLeaps(DeltaTime);
+	SimulateRopeFlights(DeltaTime, StepCount, Interpolation);
+}
+
+void UGrapplingSimulationSubsystem::SetFixedTimeStep(bool bEnable, float StepRate)
+{
+	bFixedTimeStep = bEnable;
+	FixedStepRate = FMath::Max(StepRate, 1.f);
+	FixedStepAccumulator = 0.f;
+}
+
+float UGrapplingSimulationSubsystem::AdvanceTime(float& ElapsedTime, float& PreviousElapsedTime, float Duration, float DeltaTime,
+                                                 int32 StepCount, float Interpolation) const
+{
+	if(!bFixedTimeStep)
+	{
+		ElapsedTime = FMath::Min(ElapsedTime + DeltaTime, Duration);
+		PreviousElapsedTime = ElapsedTime;
+		return ElapsedTime;
+	}
+
+	// Stepping one step at a time keeps the result independent of how steps group into frames
+	const float StepTime = GetFixedStepTime();
+	for(int32 Step = 0; Step < StepCount; Step++)
+	{
+		PreviousElapsedTime = ElapsedTime;
+		ElapsedTime = FMath::Min(ElapsedTime + StepTime, Duration);
+	}
+	return FMath::Lerp(PreviousElapsedTime, ElapsedTime, Interpolation);
+}
+
+void UGrapplingSimulationSubsystem::SimulateLeaps(float DeltaTime)
+{
+	// In fixed step mode the movement components step their leaps by the time of their moves
+	const int32 Count = Leaps.Handles.Num();
+	if(Count == 0 || bFixedTimeStep) return;
+
+	const int32 BatchCount = FMath::DivideAndRoundUp(Count, BatchSize);
+	ParallelFor(BatchCount, [this, DeltaTime, Count](int32 Batch)
+	{
+		const int32 End = FMath::Min((Batch + 1) * BatchSize, Count);
+		for(int32 i = Batch * BatchSize; i < End; i++)
+		{
+			const float Duration = Leaps.Durations[i];
+			const float PreviousAlpha = Leaps.Alphas[i];
+			Leaps.StepFromTimes[i] = PreviousAlpha * Duration;
+			const float DrawnTime = AdvanceTime(Leaps.ElapsedTimes[i], Leaps.PreviousElapsedTimes[i], Duration, DeltaTime, 1, 1.f);
+			const float Alpha = Duration > 0.f ? DrawnTime / Duration : 1.f;
+			Leaps.Alphas[i] = Alpha;
+			Leaps.StepToTimes[i] = DrawnTime;
+
+			// Same sub-stepping as the movement component would do, so fast leaps still follow the curve
+			const int32 StepCount = GrappleCore::SubStepCount(DeltaTime, Leaps.MaxStepTimes[i], MaxLeapSteps);
+			float StepAlphas[MaxLeapSteps];
+			GrappleCore::SubStepAlphas(PreviousAlpha, Alpha, StepCount, StepAlphas);
+
+			const FGrapplingTrajectory Trajectory(Leaps.Starts[i], Leaps.Ends[i], Leaps.Ups[i], Leaps.Curves[i], Leaps.Profiles[i]);
+			Trajectory.GetLocations(StepAlphas, Leaps.Steps.GetData() + i * MaxLeapSteps, StepCount);
+			Leaps.StepCounts[i] = StepCount;
+		}
+	}, BatchCount == 1);
+}
+
+void UGrapplingSimulationSubsystem::SimulateRopeFlights(float DeltaTime, int32 FixedStepCount, float Interpolation)
+{
+	const int32 Count = RopeFlights.Handles.Num();
+	if(Count == 0) return;
+
+	const int32 BatchCount = FMath::DivideAndRoundUp(Count, BatchSize);
+	ParallelFor(BatchCount, [this, DeltaTime, FixedStepCount, Interpolation, Count](int32 Batch)
+	{
+		const int32 End = FMath::Min((Batch + 1) * BatchSize, Count);
+		for(int32 i = Batch * BatchSize; i < End; i++)
+		{
+			const float Duration = RopeFlights.Durations[i];
+			const float DrawnTime = AdvanceTime(RopeFlights.ElapsedTimes[i], RopeFlights.PreviousElapsedTimes[i], Duration, DeltaTime,
+			                                    FixedStepCount, Interpolation);
+			RopeFlights.Alphas[i] = Duration > 0.f ? DrawnTime / Duration : 1.f;
+			RopeFlights.Locations[i] = FMath::Lerp(RopeFlights.Starts[i], RopeFlights.Ends[i], RopeFlights.Alphas[i]);
+		}
+	}, BatchCount == 1);
+
+	// Moving actors has to happen on the game thread, all in one go once the locations are known
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_RopeGuideUpdate);
+	for(int32 i = Count - 1; i >= 0; i--)
+	{
+		ARopeGuide* RopeGuide = RopeFlights.RopeGuides[i].Get();
+		if(!RopeGuide)
+		{
+			RemoveRopeFlight(RopeFlights.Handles[i]);
+			continue;
+		}
+
+		RopeGuide->SetActorLocation(RopeFlights.Locations[i], false);
+		if(RopeFlights.Alphas[i] >= 1.f)
+		{
+			// Removing swaps the last flight in, which has already been moved
+			RemoveRopeFlight(RopeFlights.Handles[i]);
+			RopeGuide->OnFlightFinished();
+		}
+	}
+}
+
+void UGrapplingSimulationSubsystem::RemoveLeapAt(int32 Index)
+{
+	const int32 Last = Leaps.Handles.Num() - 1;
+	if(Index != Last)
+	{
+		LeapIndices[Leaps.Handles[Last]] = Index;
+		FMemory::Memcpy(Leaps.Steps.GetData() + Index * MaxLeapSteps, Leaps.Steps.GetData() + Last * MaxLeapSteps, MaxLeapSteps * sizeof(FVector));
+	}
+
+	Leaps.Starts.RemoveAtSwap(Index, 1, false);
+	Leaps.Ends.RemoveAtSwap(Index, 1, false);
+	Leaps.Ups.RemoveAtSwap(Index, 1, false);
+	Leaps.Curves.RemoveAtSwap(Index, 1, false);
+	Leaps.Profiles.RemoveAtSwap(Index, 1, false);
+	Leaps.ElapsedTimes.RemoveAtSwap(Index, 1, false);
+	Leaps.PreviousElapsedTimes.RemoveAtSwap(Index, 1, false);
+	Leaps.Durations.RemoveAtSwap(Index, 1, false);
+	Leaps.MaxStepTimes.RemoveAtSwap(Index, 1, false);
+	Leaps.Alphas.RemoveAtSwap(Index, 1, false);
+	Leaps.StepCounts.RemoveAtSwap(Index, 1, false);
+	Leaps.StepFromTimes.RemoveAtSwap(Index, 1, false);
+	Leaps.StepToTimes.RemoveAtSwap(Index, 1, false);
+	Leaps.Steps.RemoveAt(Last * MaxLeapSteps, MaxLeapSteps, false);
+	Leaps.Handles.RemoveAtSwap(Index, 1, false);
+}
+
+void UGrapplingSimulationSubsystem::RemoveRopeFlightAt(int32 Index)
+{
+	const int32 Last = RopeFlights.Handles.Num() - 1;
+	if(Index != Last)
+	{
+		RopeFlightIndices[RopeFlights.Handles[Last]] = Index;
+	}
+
+	RopeFlights.Starts.RemoveAtSwap(Index, 1, false);
+	RopeFlights.Ends.RemoveAtSwap(Index, 1, false);
+	RopeFlights.ElapsedTimes.RemoveAtSwap(Index, 1, false);
+	RopeFlights.PreviousElapsedTimes.RemoveAtSwap(Index, 1, false);
+	RopeFlights.Durations.RemoveAtSwap(Index, 1, false);
+	RopeFlights.Alphas.RemoveAtSwap(Index, 1, false);
+	RopeFlights.Locations.RemoveAtSwap(Index, 1, false);
+	RopeFlights.RopeGuides.RemoveAtSwap(Index, 1, false);
+	RopeFlights.Handles.RemoveAtSwap(Index, 1, false);
+}
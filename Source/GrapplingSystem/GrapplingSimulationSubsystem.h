@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingSimulationSubsystem.generated.h"
+
+class ARopeGuide;
+class UCurveFloat;
+class UGrapplingSimulationSubsystem;
+struct FGrapplingCurveLUT;
+struct FGrapplingTrajectory;
+
+/** Runs the grappling simulation once per frame, before the character movement components */
+USTRUCT()
+struct FGrapplingSimulationTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UGrapplingSimulationSubsystem* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	                         const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGrapplingSimulationTickFunction> : public TStructOpsTypeTraitsBase2<FGrapplingSimulationTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Owns every leap and rope guide flight in progress, stored as parallel arrays, and advances
+ * them all in a single parallel pass per frame instead of one tick per actor.
+ * Rope guides are moved by the subsystem itself. Leaps only get their sub-step locations
+ * computed here: the movement components still sweep the characters through them, and keep the
+ * time of the leap, which the subsystem follows.
+ * Handles stay valid until the leap or flight is removed.
+ * In fixed step mode the leaps and flights advance by whole steps of the configured rate, so they
+ * play out the same whatever the frame rate, and are drawn interpolated between the last two steps.
+ * The movement components count the fixed steps of their leaps themselves, from the time of their
+ * moves, and step them with StepLeap.
+ */
+UCLASS(config=Game)
+class GRAPPLINGSYSTEM_API UGrapplingSimulationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Largest number of sub-steps a leap is split into in a frame */
+	static constexpr int32 MaxLeapSteps = 8;
+
+	/** Leaps and flights handled by a single task of the parallel pass */
+	static constexpr int32 BatchSize = 64;
+
+	UGrapplingSimulationSubsystem();
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+	/** Tick function of the subsystem, for components that must run after it */
+	FTickFunction& GetTickFunction() { return TickFunction; }
+
+	/**
+	 * Starts simulating a leap reaching its end in Duration seconds, ElapsedTime seconds of which
+	 * already went by. Each frame is split in sub-steps no longer than MaxStepTime. The trajectory
+	 * curve and profile must outlive the leap
+	 */
+	int32 AddLeap(const FGrapplingTrajectory& Trajectory, float Duration, float MaxStepTime, float ElapsedTime = 0.f);
+
+	/** Stops simulating a leap */
+	void RemoveLeap(int32 Handle);
+
+	/**
+	 * Moves a leap from FromTime to ToTime, in seconds since it started, and writes the locations it
+	 * goes through to OutSteps, in order, one per sub-step. The locations computed by the last simulated
+	 * frame are used when they cover the same times, the trajectory is evaluated otherwise, as when a
+	 * server runs the moves of a client or a client replays its moves. Returns the number of locations,
+	 * at most MaxLeapSteps
+	 */
+	int32 AdvanceLeap(int32 Handle, float FromTime, float ToTime, FVector* OutSteps);
+
+	/**
+	 * Fixed step counterpart of AdvanceLeap: moves a leap by StepCount whole fixed steps, updating ElapsedTime
+	 * and PreviousElapsedTime, and writes the location reached at the end of each step to OutSteps.
+	 * Interpolation is how far the frame went into the next step, OutDrawnLocation is the leap that far
+	 * between the last two steps. Returns the number of locations, at most MaxLeapSteps
+	 */
+	int32 StepLeap(int32 Handle, float& ElapsedTime, float& PreviousElapsedTime, int32 StepCount, float Interpolation,
+	               FVector* OutSteps, FVector& OutDrawnLocation);
+
+	/** Fraction of the leap already travelled */
+	float GetLeapAlpha(int32 Handle) const;
+
+	/** Has the leap reached its end? */
+	bool IsLeapFinished(int32 Handle) const;
+
+	/** Starts moving a rope guide in a straight line. The guide is told when it arrives */
+	int32 AddRopeFlight(ARopeGuide* RopeGuide, const FVector& Start, const FVector& End, float Duration);
+
+	/** Stops moving a rope guide */
+	void RemoveRopeFlight(int32 Handle);
+
+	/** Number of leaps being simulated */
+	int32 GetNumLeaps() const { return Leaps.Handles.Num(); }
+
+	/** Number of rope guides flying */
+	int32 GetNumRopeFlights() const { return RopeFlights.Handles.Num(); }
+
+	/** Advances every leap and flight. Called by the tick function */
+	void Simulate(float DeltaTime);
+
+	/** Switches fixed step mode on or off, overriding the configuration. Leaps in progress carry on */
+	void SetFixedTimeStep(bool bEnable, float StepRate);
+
+	/** Is the simulation advancing by fixed steps? */
+	bool IsFixedTimeStep() const { return bFixedTimeStep; }
+
+	/** Duration of a fixed step, in seconds */
+	float GetFixedStepTime() const { return 1.f / FixedStepRate; }
+
+	/** Number of fixed steps simulated since the world began play, or frames when not in fixed step mode */
+	uint32 GetSimulationStep() const { return SimulationStep; }
+
+protected:
+
+	/** Advance leaps and flights by fixed steps instead of by the frame time? */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	bool bFixedTimeStep;
+
+	/** Fixed steps per second */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling", meta = (ClampMin = "1"))
+	float FixedStepRate;
+
+private:
+
+	/** Leaps in progress, one element per leap in every array */
+	struct FLeapArrays
+	{
+		TArray<FVector> Starts;
+		TArray<FVector> Ends;
+		TArray<FVector> Ups;
+		TArray<const UCurveFloat*> Curves;
+		TArray<const FGrapplingCurveLUT*> Profiles;
+		TArray<float> ElapsedTimes;
+
+		/** Elapsed time one fixed step earlier, interpolated from in fixed step mode */
+		TArray<float> PreviousElapsedTimes;
+		TArray<float> Durations;
+		TArray<float> MaxStepTimes;
+
+		/** Fraction of the leap drawn, interpolated between the last two fixed steps in fixed step mode */
+		TArray<float> Alphas;
+		TArray<int32> StepCounts;
+
+		/** Leap times the precomputed locations go from and to */
+		TArray<float> StepFromTimes;
+		TArray<float> StepToTimes;
+
+		/** MaxLeapSteps locations per leap */
+		TArray<FVector> Steps;
+
+		/** Handle of each leap */
+		TArray<int32> Handles;
+	};
+
+	/** Rope guide flights in progress, one element per flight in every array */
+	struct FRopeFlightArrays
+	{
+		TArray<FVector> Starts;
+		TArray<FVector> Ends;
+		TArray<float> ElapsedTimes;
+		TArray<float> PreviousElapsedTimes;
+		TArray<float> Durations;
+
+		/** Fraction of the flight drawn */
+		TArray<float> Alphas;
+		TArray<FVector> Locations;
+		TArray<TWeakObjectPtr<ARopeGuide>> RopeGuides;
+
+		/** Handle of each flight */
+		TArray<int32> Handles;
+	};
+
+	FLeapArrays Leaps;
+
+	FRopeFlightArrays RopeFlights;
+
+	/** Array index of every leap, by handle */
+	TSparseArray<int32> LeapIndices;
+
+	/** Array index of every flight, by handle */
+	TSparseArray<int32> RopeFlightIndices;
+
+	FGrapplingSimulationTickFunction TickFunction;
+
+	/** Frame time not simulated yet in fixed step mode, less than a step */
+	float FixedStepAccumulator;
+
+	uint32 SimulationStep;
+
+	/** Advances the leaps by the frame and computes their sub-step locations. Not used in fixed step mode */
+	void SimulateLeaps(float DeltaTime);
+
+	/** Advances the flights, then moves the rope guides and reports those that arrived */
+	void SimulateRopeFlights(float DeltaTime, int32 StepCount, float Interpolation);
+
+	/** Advances one elapsed time, by a variable frame or by whole fixed steps. Returns the time to draw */
+	float AdvanceTime(float& ElapsedTime, float& PreviousElapsedTime, float Duration, float DeltaTime, int32 StepCount,
+	                  float Interpolation) const;
+
+	void RemoveLeapAt(int32 Index);
+
+	void RemoveRopeFlightAt(int32 Index);
+};
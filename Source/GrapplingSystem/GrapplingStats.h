@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Grappling"), STATGROUP_Grappling, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LineTraceGrapplingPoint"), STAT_Grappling_LineTrace, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trajectory Validation"), STAT_Grappling_Validation, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grapple"), STAT_Grappling_Grapple, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RotateTowardsGrapplingPoint"), STAT_Grappling_Rotate, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rope Spawn"), STAT_Grappling_Rope, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simulation"), STAT_Grappling_Simulation, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rope Solver"), STAT_Grappling_RopeSolver, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rope Batch Build"), STAT_Grappling_RopeBatch, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rope Batch Upload"), STAT_Grappling_RopeBatchUpload, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Indicators"), STAT_Grappling_Indicators, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Server Validation"), STAT_Grappling_ServerValidation, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Significance"), STAT_Grappling_Significance, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RopeGuide UpdatePosition"), STAT_Grappling_RopeGuideUpdate, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Trajectory Sweeps"), STAT_Grappling_Sweeps, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Grapples"), STAT_Grappling_ActiveGrapples, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Validation Queue Depth"), STAT_Grappling_ValidationQueueDepth, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Rope Guides"), STAT_Grappling_LiveRopeGuides, STATGROUP_Grappling, GRAPPLINGSYSTEM_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(GRAPPLINGSYSTEM_API, Grappling);
+
+/**
+ * Game thread counters behind the grappling stats. They are kept outside of the stats system
+ * so the CSV profiler and tools can read them in builds where stats are compiled out.
+ */
+struct GRAPPLINGSYSTEM_API FGrapplingCounters
+{
+	/** Characters currently doing a grappling leap */
+	static int32 ActiveGrapples;
+
+	/** Rope guides currently taken from the pool */
+	static int32 LiveRopeGuides;
+
+	/** Physics sweeps issued by the grappling code this frame */
+	static int32 FrameSweeps;
+
+	/** Physics sweeps issued by the grappling code since startup */
+	static uint64 TotalSweeps;
+
+	static void AddSweeps(int32 Count);
+
+	static void AddActiveGrapples(int32 Delta);
+
+	static void AddLiveRopeGuides(int32 Delta);
+
+	/** Publishes the per-frame values to the CSV profiler and resets them. Called at the end of every frame */
+	static void EndFrame();
+};
@@ -8,7 +8,7 @@ public class GrapplingSystem : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "CableComponent" });
-		PrivateDependencyModuleNames.AddRange(new string[] {"CableComponent"});
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay" });
+		PrivateDependencyModuleNames.AddRange(new string[] {"Json", "RenderCore", "RHI", "AssetRegistry", "SignificanceManager"});
 	}
 }
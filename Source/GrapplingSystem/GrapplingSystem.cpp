@@ -1,7 +1,95 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GrapplingSystem.h"
+#include "GrapplingStats.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, GrapplingSystem, "GrapplingSystem" );
- 
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogGrappling);
+
+DEFINE_STAT(STAT_Grappling_LineTrace);
+DEFINE_STAT(STAT_Grappling_Validation);
+DEFINE_STAT(STAT_Grappling_Grapple);
+DEFINE_STAT(STAT_Grappling_Rotate);
+DEFINE_STAT(STAT_Grappling_Rope);
+DEFINE_STAT(STAT_Grappling_Simulation);
+DEFINE_STAT(STAT_Grappling_RopeSolver);
+DEFINE_STAT(STAT_Grappling_RopeBatch);
+DEFINE_STAT(STAT_Grappling_RopeBatchUpload);
+DEFINE_STAT(STAT_Grappling_Indicators);
+DEFINE_STAT(STAT_Grappling_ServerValidation);
+DEFINE_STAT(STAT_Grappling_Significance);
+DEFINE_STAT(STAT_Grappling_RopeGuideUpdate);
+DEFINE_STAT(STAT_Grappling_Sweeps);
+DEFINE_STAT(STAT_Grappling_ActiveGrapples);
+DEFINE_STAT(STAT_Grappling_ValidationQueueDepth);
+DEFINE_STAT(STAT_Grappling_LiveRopeGuides);
+
+CSV_DEFINE_CATEGORY_MODULE(GRAPPLINGSYSTEM_API, Grappling, true);
+
+int32 FGrapplingCounters::ActiveGrapples = 0;
+int32 FGrapplingCounters::LiveRopeGuides = 0;
+int32 FGrapplingCounters::FrameSweeps = 0;
+uint64 FGrapplingCounters::TotalSweeps = 0;
+
+void FGrapplingCounters::AddSweeps(int32 Count)
+{
+	FrameSweeps += Count;
+	TotalSweeps += Count;
+	INC_DWORD_STAT_BY(STAT_Grappling_Sweeps, Count);
+}
+
+void FGrapplingCounters::AddActiveGrapples(int32 Delta)
+{
+	ActiveGrapples += Delta;
+	if(Delta > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_Grappling_ActiveGrapples, Delta);
+	}
+	else
+	{
+		DEC_DWORD_STAT_BY(STAT_Grappling_ActiveGrapples, -Delta);
+	}
+}
+
+void FGrapplingCounters::AddLiveRopeGuides(int32 Delta)
+{
+	LiveRopeGuides += Delta;
+	if(Delta > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_Grappling_LiveRopeGuides, Delta);
+	}
+	else
+	{
+		DEC_DWORD_STAT_BY(STAT_Grappling_LiveRopeGuides, -Delta);
+	}
+}
+
+void FGrapplingCounters::EndFrame()
+{
+	CSV_CUSTOM_STAT(Grappling, ActiveGrapples, ActiveGrapples, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Grappling, LiveRopeGuides, LiveRopeGuides, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Grappling, SweepsPerFrame, FrameSweeps, ECsvCustomStatOp::Set);
+	FrameSweeps = 0;
+}
+
+class FGrapplingSystemModule : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void StartupModule() override
+	{
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FGrapplingCounters::EndFrame);
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	}
+
+private:
+
+	FDelegateHandle EndFrameHandle;
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FGrapplingSystemModule, GrapplingSystem, "GrapplingSystem" );
@@ -3,23 +3,66 @@
 #include "GrapplingSystemCharacter.h"
 
 #include "DrawDebugHelpers.h"
+#include "GrapplingMovementComponent.h"
 #include "GrapplingPoint.h"
+#include "GrapplingPointSubsystem.h"
+#include "GrapplingReplaySubsystem.h"
+#include "GrapplingRopeComponent.h"
+#include "GrapplingRopePoolSubsystem.h"
+#include "GrapplingStats.h"
+#include "GrapplingTelemetrySubsystem.h"
+#include "GrapplingValidationSubsystem.h"
 #include "HeadMountedDisplayFunctionLibrary.h"
+#include "Animation/AnimMontage.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
 #include "GameFramework/SpringArmComponent.h"
-#include "Kismet/GameplayStatics.h"
+#include "GrappleCore/GrappleCore.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "CableComponent.h"
+#include "Net/UnrealNetwork.h"
 #include "RopeGuide.h"
+#include "ThrowMovementAnimNotify.h"
+#include "TimerManager.h"
+
+bool FGrappleLeapReplication::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << LeapCount;
+	bool bStartSuccess = true;
+	bool bEndSuccess = true;
+	Start.NetSerialize(Ar, Map, bStartSuccess);
+	End.NetSerialize(Ar, Map, bEndSuccess);
+
+	// The point id is most of the size, leaps that do not end on a registered point go without it
+	uint8 bHasPoint = PointId.IsValid() ? 1 : 0;
+	Ar.SerializeBits(&bHasPoint, 1);
+	if(bHasPoint)
+	{
+		Ar << PointId;
+	}
+	else if(Ar.IsLoading())
+	{
+		PointId.Invalidate();
+	}
+
+	Ar << ServerStartTime;
+	bOutSuccess = bStartSuccess && bEndSuccess;
+	return true;
+}
 
 //////////////////////////////////////////////////////////////////////////
 // AGrapplingSystemCharacter
 
-AGrapplingSystemCharacter::AGrapplingSystemCharacter()
+AGrapplingSystemCharacter::AGrapplingSystemCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UGrapplingMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -39,6 +82,9 @@ AGrapplingSystemCharacter::AGrapplingSystemCharacter()
 	GetCharacterMovement()->JumpZVelocity = 600.f;
 	GetCharacterMovement()->AirControl = 0.2f;
 
+	// The leap itself is a movement mode of the character movement
+	GrapplingMovement = Cast<UGrapplingMovementComponent>(GetCharacterMovement());
+
 	// Create a camera boom (pulls in towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(RootComponent);
@@ -56,20 +102,160 @@ AGrapplingSystemCharacter::AGrapplingSystemCharacter()
 	// Grappling parameters
 	GrappleEndVerticalOffset = 100.f;
 	GrapplingSpeed = 1500.f;
+	SpeculativeClearanceMoveThreshold = 50.f;
+	SpeculativeClearanceMaxAge = 0.5f;
+	BakedReachabilityTolerance = 50.f;
+	ProxyLeapStartTolerance = 20.f;
+	ValidationMode = EGrappleValidationMode::SweptSegments;
+	ValidationTolerance = 10.f;
+	MaxValidationSegments = 16;
+	CurveBakeResolution = 64;
+	CurveBakeTolerance = 0.001f;
+	TargetSelection = EGrappleTargetSelection::CrosshairTrace;
+	TargetConeHalfAngle = 10.f;
+	TargetMaxDistance = 50'000.f;
+	ServerAimConeHalfAngle = 60.f;
+	TargetAngleWeight = 1.f;
+	TargetDistanceWeight = 0.25f;
+	bTargetRequireLineOfSight = true;
+	FocusMoveThreshold = 5.f;
+	FocusAngleThreshold = 0.25f;
+	FocusMaxInterval = 0.25f;
+
+	ThrowableRope = nullptr;
+	ActiveRopeGuide = nullptr;
+	RopeThrowTime = 0.f;
+	LeapStartTime = 0.f;
+	FocusStartTime = 0.f;
+	bLeapPausedMovementReplication = false;
+	bGrappleRequestPending = false;
+	LeapStartDelay = -1.f;
+	NotRenderedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	bGrappleAssetsLoaded = false;
+}
+
+void AGrapplingSystemCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ClearanceTraceDelegate.BindUObject(this, &AGrapplingSystemCharacter::OnClearanceTraceDone);
+	GrapplingMovement->OnLeapFinished.BindUObject(this, &AGrapplingSystemCharacter::OnGrappleLeapFinished);
+
+	LoadGrappleAssets();
+}
+
+void AGrapplingSystemCharacter::GetGrappleAssetPaths(bool bIncludeCosmetic, TArray<FSoftObjectPath>& OutPaths) const
+{
+	// The curve shapes the leap and the montage times its start, the server needs both to validate and run leaps
+	for(const FSoftObjectPath& Path : {GrapplingVerticalCurve.ToSoftObjectPath(), GrappleThrowMontage.ToSoftObjectPath()})
+	{
+		if(!Path.IsNull()) OutPaths.Add(Path);
+	}
+	if(bIncludeCosmetic && !RopeGuideObject.IsNull())
+	{
+		OutPaths.Add(RopeGuideObject.ToSoftObjectPath());
+	}
+}
+
+void AGrapplingSystemCharacter::LoadGrappleAssets()
+{
+	// Dedicated servers draw nothing, they skip the rope guide and everything it references
+	TArray<FSoftObjectPath> Paths;
+	GetGrappleAssetPaths(GetNetMode() != NM_DedicatedServer, Paths);
+
+	// Commandlets do not tick the async loading, they would wait forever
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	if(Paths.Num() == 0 || IsRunningCommandlet())
+	{
+		if(Paths.Num() > 0)
+		{
+			GrappleAssetsHandle = Streamable.RequestSyncLoad(Paths);
+		}
+		OnGrappleAssetsLoaded();
+		return;
+	}
+
+	// Usually already in memory, preloaded by the game mode while the character was being spawned
+	GrappleAssetsHandle = Streamable.RequestAsyncLoad(Paths, FStreamableDelegate::CreateUObject(this, &AGrapplingSystemCharacter::OnGrappleAssetsLoaded),
+	                                                  FStreamableManager::AsyncLoadHighPriority);
+}
+
+void AGrapplingSystemCharacter::OnGrappleAssetsLoaded()
+{
+	if(bGrappleAssetsLoaded) return;
+
+	// Bake the leap curve once, so the per-frame and validation samples are table lookups
+	GrapplingProfile.Build(GrapplingVerticalCurve.Get(), CurveBakeResolution, CurveBakeTolerance);
+
+	// Once the leap can start without the throw notify, nothing needs the pose of a character nobody sees
+	const UAnimMontage* ThrowMontage = GrappleThrowMontage.Get();
+	LeapStartDelay = FindLeapStartDelay(ThrowMontage);
+	if(LeapStartDelay >= 0.f || !ThrowMontage)
+	{
+		GetMesh()->VisibilityBasedAnimTickOption = NotRenderedAnimTickOption;
+	}
+
+	// Fill the rope pools now, so the first throw does not have to spawn anything. There is no rope without a rope guide
+	UGrapplingRopePoolSubsystem* RopePool = GetWorld()->GetSubsystem<UGrapplingRopePoolSubsystem>();
+	if(RopePool && RopeGuideObject.Get())
+	{
+		RopePool->Prewarm(RopeGuideObject.Get());
+	}
+
+	bGrappleAssetsLoaded = true;
+}
+
+void AGrapplingSystemCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Keep the active grapples count right for characters removed mid-leap
+	if(bIsGrappling)
+	{
+		bIsGrappling = false;
+		FGrapplingCounters::AddActiveGrapples(-1);
+	}
+
+	// A character removed mid-leap still holds its rope, give it back or the pool keeps counting it as live
+	if(ThrowableRope || ActiveRopeGuide)
+	{
+		if(UGrapplingRopePoolSubsystem* RopePool = GetWorld()->GetSubsystem<UGrapplingRopePoolSubsystem>())
+		{
+			RopePool->ReleaseRope(ThrowableRope);
+			RopePool->ReleaseRopeGuide(ActiveRopeGuide);
+		}
+		ThrowableRope = nullptr;
+		ActiveRopeGuide = nullptr;
+	}
+
+	// Stop loading, or let the grappling assets go once no other character holds them
+	if(GrappleAssetsHandle.IsValid())
+	{
+		GrappleAssetsHandle->CancelHandle();
+		GrappleAssetsHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGrapplingSystemCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owning client runs its leaps itself, once the server accepts them
+	DOREPLIFETIME_CONDITION(AGrapplingSystemCharacter, ReplicatedLeap, COND_SimulatedOnly);
 }
 
 void AGrapplingSystemCharacter::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	// Check if the character is looking at a grappling point
-	LineTraceGrapplingPoint();
+	// Check if the player is looking at a grappling point
+	UpdateFocus();
+
+	// Check the path towards it in the background, so pressing the button does not stall the frame
+	UpdateSpeculativeClearance();
 
 	//Rotate towards the focused grappling point, if any
 	RotateTowardsGrapplingPoint(DeltaSeconds);
-
-	//Leap towards the focused grappling point, if any
-	Grapple(DeltaSeconds);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -168,56 +354,409 @@ void AGrapplingSystemCharacter::MoveRight(float Value)
 void AGrapplingSystemCharacter::StartGrappling()
 {
 	// If the character is not looking at a grapple point, or if he's 
-	// already leaping towards one, do nothing
-	if(!bGrapplePointFocused) return;
+	// already leaping towards one, do nothing. Nothing can be done either until the grappling assets are in
+	if(!bGrapplePointFocused || !bGrappleAssetsLoaded) return;
+	if(UGrapplingReplaySubsystem* Replay = GetWorld()->GetSubsystem<UGrapplingReplaySubsystem>())
+	{
+		Replay->RecordInput(this, GrappleTarget, GetActorLocation(), GrappleEndLocation);
+	}
 	if(bIsGrappling|| bIsRotatingTowardsGrapplePoint) return;
 
+	// Remote clients leave the path checks to the server, and throw once it accepts
+	if(GetLocalRole() == ROLE_AutonomousProxy)
+	{
+		if(!bGrappleRequestPending && GrappleTarget.IsValid())
+		{
+			bGrappleRequestPending = true;
+			ServerRequestGrapple(GrappleTarget);
+		}
+		return;
+	}
+
 	// Get the character and grappling point positions to calculate the leap duration
 	// Note that these values are not exact in the case the character starts leaping while
 	// in the air, but overall it still works
 	GrappleStartLocation = GetActorLocation();
 	GrappleTotalDistance = UKismetMathLibrary::Vector_Distance(GrappleStartLocation, GrappleEndLocation);
-	GrappleTotalDuration = GrappleTotalDistance/GrapplingSpeed;
+	GrappleTotalDuration = GrappleCore::LeapDuration(GrappleTotalDistance, GrapplingSpeed);
 	
-	// Check if the path from start to end is clear, doing a discrete number of capsule-casts
-	// along the trajectory the character would have to travel across
-	const int TestCount = 10;
-	FVector Direction = UKismetMathLibrary::GetDirectionUnitVector(GrappleStartLocation, GrappleEndLocation);
-	FVector TestLocation;
-	float Offset = GrappleTotalDistance / TestCount;
-	float CurveValue; 
-
-	FHitResult OutHitResult;
-	bool bHitObstacle;
+	// Check if the path from start to end is clear, doing capsule-casts along the trajectory the
+	// character would have to travel across. If the leap goes from a point to another and was baked,
+	// or if the background tests issued while the point was focused are still valid, use their
+	// result instead
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_Validation);
+	CSV_SCOPED_TIMING_STAT(Grappling, TrajectoryValidation);
 	bool bFoundAnyObstacle = false;
-	for(int i = 0; i <= TestCount; i++)
+	const EGrappleReachability BakedReachability = GetBakedReachability();
+	if(BakedReachability != EGrappleReachability::Unknown)
+	{
+		bFoundAnyObstacle = BakedReachability == EGrappleReachability::Blocked;
+	}
+	else if(IsClearanceCacheFresh(GrappleStartLocation, GrappleEndLocation))
+	{
+		// Tests still in flight report back within a frame, the throw waits for them rather than sweeping again
+		if(ClearanceCache.PendingSweeps > 0)
+		{
+			ClearanceCache.bThrowWaiting = true;
+			return;
+		}
+		bFoundAnyObstacle = ClearanceCache.bBlocked;
+	}
+	else
 	{
-		CurveValue = GrapplingVerticalCurve->GetFloatValue(float(i)/TestCount);
-		TestLocation = Direction * i * Offset + GrappleStartLocation + GetActorUpVector()*CurveValue*300.f;
-		bHitObstacle = GetWorld()->SweepSingleByChannel(
-			OutHitResult,TestLocation,TestLocation,FQuat::Identity, ECollisionChannel::ECC_Visibility,
-			FCollisionShape::MakeCapsule(GetCapsuleComponent()->GetScaledCapsuleRadius(),
-			                             GetCapsuleComponent()->GetScaledCapsuleHalfHeight()));
-		if(bHitObstacle) bFoundAnyObstacle = true;
-		DrawDebugCapsule(GetWorld(),TestLocation,GetCapsuleComponent()->GetScaledCapsuleHalfHeight(), GetCapsuleComponent()->GetScaledCapsuleRadius(),
-		                 FQuat::Identity,bHitObstacle ? FColor::Red : FColor::Blue, false,2.f,3,0.25f);
+		TArray<FGrappleTrajectorySweep> Sweeps;
+		BuildValidationSweeps(GrappleStartLocation, GrappleEndLocation, Sweeps);
+
+		const FCollisionShape Capsule = FCollisionShape::MakeCapsule(GetCapsuleComponent()->GetScaledCapsuleRadius(),
+		                                                             GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+		FGrappleTrajectoryHit TrajectoryHit;
+		bFoundAnyObstacle = FGrapplingTrajectory::SweepForObstacle(GetWorld(), Sweeps, Capsule,
+		                                                           FCollisionQueryParams(SCENE_QUERY_STAT(GrappleTrajectory), false, this),
+		                                                           TrajectoryHit);
+
+		// The sweeps before the obstacle are drawn blue, the one that met it red, and the rest of the leap not at all
+		for(const FGrappleTrajectorySweep& Sweep : Sweeps)
+		{
+			const bool bBlockedHere = bFoundAnyObstacle
+				&& Sweep.StartAlpha <= TrajectoryHit.LeapFraction && TrajectoryHit.LeapFraction <= Sweep.EndAlpha;
+			DrawDebugCapsule(GetWorld(),Sweep.StartLocation,Capsule.GetCapsuleHalfHeight(), Capsule.GetCapsuleRadius(),
+			                 FQuat::Identity,bBlockedHere ? FColor::Red : FColor::Blue, false,2.f,3,0.25f);
+			if(bBlockedHere) break;
+		}
 	}
 
+	ResolveGrappleCheck(bFoundAnyObstacle);
+}
+
+void AGrapplingSystemCharacter::ResolveGrappleCheck(bool bFoundAnyObstacle)
+{
+	const float FocusDuration = GetWorld()->GetTimeSeconds() - FocusStartTime;
+	RecordTelemetry(EGrapplingTelemetryEventType::ThrowAttempted, GrappleTotalDistance, FocusDuration);
+
 	// If obstacles have been found, exit
-	if(bFoundAnyObstacle) return;
+	if(bFoundAnyObstacle)
+	{
+		RecordTelemetry(EGrapplingTelemetryEventType::ThrowBlocked, GrappleTotalDistance, FocusDuration);
+		return;
+	}
 
 	// If no obstacle has been found in the path between the character and the grappling point,
-	// spawn the rope, fire the rope throw animation, and rotate towards the grappling point
+	// start the throw
+	BeginGrappleThrow();
+}
+
+void AGrapplingSystemCharacter::BeginGrappleThrow()
+{
+	// Spawn the rope, fire the rope throw animation, and rotate towards the grappling point
 	Rope();
 	bIsRotatingTowardsGrapplePoint = true;
 	AnimInstance = GetMesh()->GetAnimInstance();
-	AnimInstance->Montage_Play(GrappleThrowMontage);
-	AnimInstance->Montage_JumpToSection(FName("Default"));
+
+	// Dedicated servers do not need the throw pose, the leap starts on the timer there
+	UAnimMontage* ThrowMontage = GrappleThrowMontage.Get();
+	const bool bHasThrowAnimation = AnimInstance && ThrowMontage;
+	if(bHasThrowAnimation && !(LeapStartDelay >= 0.f && GetNetMode() == NM_DedicatedServer))
+	{
+		AnimInstance->Montage_Play(ThrowMontage);
+		AnimInstance->Montage_JumpToSection(FName("Default"));
+	}
+
+	// Without a throw animation there is no notify to wait for. With one, a timer set to when the
+	// notify is due starts the leap anyway if the notify does not come, as where the animation is
+	// not ticked or the notify is skipped. Whichever comes first starts the leap
+	if(!bHasThrowAnimation || LeapStartDelay == 0.f)
+	{
+		StartLeap();
+	}
+	else if(LeapStartDelay > 0.f)
+	{
+		GetWorldTimerManager().SetTimer(LeapStartTimer, this, &AGrapplingSystemCharacter::StartLeap, LeapStartDelay, false);
+	}
+}
+
+float AGrapplingSystemCharacter::FindLeapStartDelay(const UAnimMontage* Montage)
+{
+	if(!Montage) return -1.f;
+
+	// The throw is played from the start of its default section
+	const int32 SectionIndex = Montage->GetSectionIndex(FName("Default"));
+	const float SectionStart = SectionIndex != INDEX_NONE ? Montage->CompositeSections[SectionIndex].GetTime() : 0.f;
+
+	float TriggerTime = BIG_NUMBER;
+	for(const FAnimNotifyEvent& Event : Montage->Notifies)
+	{
+		if(Cast<UThrowMovementAnimNotify>(Event.Notify) && Event.GetTriggerTime() >= SectionStart)
+		{
+			TriggerTime = FMath::Min(TriggerTime, Event.GetTriggerTime());
+		}
+	}
+
+	// The notify may be on the animations the montage plays rather than on the montage itself
+	for(const FSlotAnimationTrack& SlotTrack : Montage->SlotAnimTracks)
+	{
+		for(const FAnimSegment& Segment : SlotTrack.AnimTrack.AnimSegments)
+		{
+			if(!Segment.AnimReference || Segment.AnimPlayRate <= 0.f) continue;
+
+			for(const FAnimNotifyEvent& Event : Segment.AnimReference->Notifies)
+			{
+				const float AnimTime = Event.GetTriggerTime();
+				if(!Cast<UThrowMovementAnimNotify>(Event.Notify) || AnimTime < Segment.AnimStartTime || AnimTime > Segment.AnimEndTime) continue;
+
+				const float Time = Segment.StartPos + (AnimTime - Segment.AnimStartTime) / Segment.AnimPlayRate;
+				if(Time >= SectionStart)
+				{
+					TriggerTime = FMath::Min(TriggerTime, Time);
+				}
+			}
+		}
+	}
+
+	if(TriggerTime == BIG_NUMBER) return -1.f;
+	return (TriggerTime - SectionStart) / FMath::Max(Montage->RateScale, KINDA_SMALL_NUMBER);
+}
+
+void AGrapplingSystemCharacter::SetGrappleTarget(const FGrapplingPointTarget& Target)
+{
+	GrappleEndLocation = Target.GetLocation() + FVector::UpVector*GrappleEndVerticalOffset;
+	GrappleTarget = Target;
+	GrappleStartLocation = GetActorLocation();
+	GrappleTotalDistance = UKismetMathLibrary::Vector_Distance(GrappleStartLocation, GrappleEndLocation);
+	GrappleTotalDuration = GrappleCore::LeapDuration(GrappleTotalDistance, GrapplingSpeed);
+}
+
+bool AGrapplingSystemCharacter::ServerRequestGrapple_Validate(const FGrapplingPointTarget& Target)
+{
+	// A target is a point actor or an instance of a point set, never both. Anything else was forged
+	return !(Target.Point && Target.PointSet) && (!Target.PointSet || Target.Instance >= 0);
+}
+
+void AGrapplingSystemCharacter::ServerRequestGrapple_Implementation(const FGrapplingPointTarget& Target)
+{
+	// Requests sent while a grapple is going on or being validated are spam, drop them
+	if(!Target.IsValid() || IsGrappleInProgress() || bGrappleRequestPending) return;
+
+	// The leap cannot be checked before the curve is loaded, the client is free to ask again.
+	// Points the client could not have been looking at are refused before any sweep is queued
+	if(!bGrappleAssetsLoaded || !IsGrappleRequestInReach(Target))
+	{
+		ClientGrappleValidated(Target, false);
+		return;
+	}
+
+	SetGrappleTarget(Target);
+	bGrappleRequestPending = true;
+
+	// The server does not know when the client focused the point
+	RecordTelemetry(EGrapplingTelemetryEventType::ThrowAttempted, GrappleTotalDistance, -1.f);
+
+	const EGrappleReachability BakedReachability = GetBakedReachability();
+	if(BakedReachability != EGrappleReachability::Unknown)
+	{
+		OnServerGrappleValidated(BakedReachability == EGrappleReachability::Reachable);
+		return;
+	}
+
+	// The sweeps of every client run together in the validation queue, with the result a frame later
+	UGrapplingValidationSubsystem* Validation = GetWorld()->GetSubsystem<UGrapplingValidationSubsystem>();
+	FGrappleValidationRequest Request;
+	Request.Start = GrappleStartLocation;
+	Request.End = GrappleEndLocation;
+	Request.Shape = FCollisionShape::MakeCapsule(GetCapsuleComponent()->GetScaledCapsuleRadius(),
+	                                             GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+	BuildValidationSweeps(GrappleStartLocation, GrappleEndLocation, Request.Sweeps);
+	if(!Validation || !Validation->RequestValidation(this, MoveTemp(Request),
+	                                                 FOnGrappleValidated::CreateUObject(this, &AGrapplingSystemCharacter::OnServerGrappleValidated)))
+	{
+		OnServerGrappleValidated(false);
+	}
+}
+
+bool AGrapplingSystemCharacter::IsGrappleRequestInReach(const FGrapplingPointTarget& Target) const
+{
+	const FVector PointLocation = Target.GetLocation();
+	if(FVector::DistSquared(GetActorLocation(), PointLocation) > FMath::Square(TargetMaxDistance)) return false;
+
+	// The server knows the aim of the client from its moves, but not where its camera is
+	const FVector ToPoint = (PointLocation - GetPawnViewLocation()).GetSafeNormal();
+	if(ToPoint.IsZero()) return true;
+	return FVector::DotProduct(ToPoint, GetBaseAimRotation().Vector()) >= FMath::Cos(FMath::DegreesToRadians(ServerAimConeHalfAngle));
+}
+
+void AGrapplingSystemCharacter::OnServerGrappleValidated(bool bClear)
+{
+	bGrappleRequestPending = false;
+
+	if(!bClear)
+	{
+		RecordTelemetry(EGrapplingTelemetryEventType::ThrowBlocked, GrappleTotalDistance, -1.f);
+	}
+
+	const bool bAccepted = bClear && GrappleTarget.IsValid() && !IsGrappleInProgress();
+	if(bAccepted)
+	{
+		BeginGrappleThrow();
+	}
+	ClientGrappleValidated(GrappleTarget, bAccepted);
+}
+
+void AGrapplingSystemCharacter::ClientGrappleValidated_Implementation(const FGrapplingPointTarget& Target, bool bAccepted)
+{
+	bGrappleRequestPending = false;
+	if(!bAccepted || !Target.IsValid() || IsGrappleInProgress()) return;
+
+	SetGrappleTarget(Target);
+	BeginGrappleThrow();
+}
+
+FGrappleReachabilitySettings AGrapplingSystemCharacter::MakeReachabilitySettings(float MaxRange) const
+{
+	FGrappleReachabilitySettings Settings;
+	Settings.MaxRange = MaxRange;
+	Settings.GrapplingSpeed = GrapplingSpeed;
+	Settings.VerticalOffset = GrappleEndVerticalOffset;
+	Settings.CapsuleRadius = GetCapsuleComponent()->GetScaledCapsuleRadius();
+	Settings.CapsuleHalfHeight = GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	// Baking runs in the editor and in commandlets, where loading on the spot is fine
+	Settings.VerticalCurve = GrapplingVerticalCurve.LoadSynchronous();
+	Settings.ValidationMode = ValidationMode;
+	Settings.ValidationSampleCount = ClearanceTestCount;
+	Settings.ValidationTolerance = ValidationTolerance;
+	Settings.MaxValidationSegments = MaxValidationSegments;
+	return Settings;
+}
+
+bool AGrapplingSystemCharacter::TryGrappleTo(AGrapplingPoint* Point)
+{
+	return TryGrappleToTarget(FGrapplingPointTarget(Point));
+}
+
+bool AGrapplingSystemCharacter::TryGrappleToTarget(const FGrapplingPointTarget& Target)
+{
+	if(!Target.IsValid()) return false;
+
+	return TryGrappleTowards(Target, Target.GetLocation() + FVector::UpVector*GrappleEndVerticalOffset);
+}
+
+bool AGrapplingSystemCharacter::TryGrappleToLocation(const FVector& EndLocation)
+{
+	return TryGrappleTowards(FGrapplingPointTarget(), EndLocation);
+}
+
+bool AGrapplingSystemCharacter::TryGrappleTowards(const FGrapplingPointTarget& Target, const FVector& EndLocation)
+{
+	if(IsGrappleInProgress() || !bGrappleAssetsLoaded) return false;
+
+	// Focus the point as the crosshair trace would, then go through the usual checks
+	bGrapplePointFocused = true;
+	FocusStartTime = GetWorld()->GetTimeSeconds();
+	GrappleEndLocation = EndLocation;
+	GrappleTarget = Target;
+	StartGrappling();
+	return IsGrappleInProgress();
+}
+
+FGrapplingTrajectory AGrapplingSystemCharacter::MakeTrajectory(const FVector& Start, const FVector& End) const
+{
+	return FGrapplingTrajectory(Start, End, GetActorUpVector(), GrapplingVerticalCurve.Get(), &GrapplingProfile);
+}
+
+void AGrapplingSystemCharacter::BuildValidationSweeps(const FVector& Start, const FVector& End, TArray<FGrappleTrajectorySweep>& OutSweeps) const
+{
+	MakeTrajectory(Start, End).BuildValidationSweeps(ValidationMode, ClearanceTestCount, ValidationTolerance,
+	                                                 MaxValidationSegments, OutSweeps);
+}
+
+EGrappleReachability AGrapplingSystemCharacter::GetBakedReachability() const
+{
+	if(!AnchorTarget.IsValid() || !GrappleTarget.IsValid()) return EGrappleReachability::Unknown;
+
+	// The graph was baked for leaps starting where a leap to the anchor lands
+	const FVector AnchorLocation = AnchorTarget.GetLocation() + FVector::UpVector*GrappleEndVerticalOffset;
+	if(FVector::DistSquared(GetActorLocation(), AnchorLocation) > FMath::Square(BakedReachabilityTolerance))
+	{
+		return EGrappleReachability::Unknown;
+	}
+
+	const UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>();
+	return Registry ? Registry->GetReachability(AnchorTarget.GetPointId(), GrappleTarget.GetPointId()) : EGrappleReachability::Unknown;
+}
+
+bool AGrapplingSystemCharacter::IsClearanceCacheFresh(const FVector& Start, const FVector& End) const
+{
+	return ClearanceCache.bValid
+		&& ClearanceCache.EndLocation.Equals(End, KINDA_SMALL_NUMBER)
+		&& FVector::DistSquared(ClearanceCache.StartLocation, Start) <= FMath::Square(SpeculativeClearanceMoveThreshold)
+		&& GetWorld()->GetTimeSeconds() - ClearanceCache.IssueTime <= SpeculativeClearanceMaxAge;
+}
+
+void AGrapplingSystemCharacter::UpdateSpeculativeClearance()
+{
+	if(!bGrapplePointFocused || bIsGrappling || bIsRotatingTowardsGrapplePoint || ClearanceCache.bThrowWaiting) return;
+
+	// Keep the current batch while the character stays close to where it was issued,
+	// the focused point is the same and the batch is recent enough
+	const FVector Start = GetActorLocation();
+	if(IsClearanceCacheFresh(Start, GrappleEndLocation)) return;
+
+	// Issue a new batch, any result still in flight for the previous one will be ignored
+	ClearanceCache.Generation++;
+	ClearanceCache.bBlocked = false;
+	ClearanceCache.BlockedLeapFraction = 1.f;
+	ClearanceCache.StartLocation = Start;
+	ClearanceCache.EndLocation = GrappleEndLocation;
+	ClearanceCache.IssueTime = GetWorld()->GetTimeSeconds();
+	ClearanceCache.bValid = true;
+	BuildValidationSweeps(Start, GrappleEndLocation, ClearanceCache.Sweeps);
+	ClearanceCache.PendingSweeps = ClearanceCache.Sweeps.Num();
+
+	const FCollisionShape Capsule = FCollisionShape::MakeCapsule(GetCapsuleComponent()->GetScaledCapsuleRadius(),
+	                                                             GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GrappleTrajectory), false, this);
+	FGrapplingCounters::AddSweeps(ClearanceCache.Sweeps.Num());
+	ClearanceCache.TraceHandles.Reset();
+	for(const FGrappleTrajectorySweep& Sweep : ClearanceCache.Sweeps)
+	{
+		ClearanceCache.TraceHandles.Add(GetWorld()->AsyncSweepByChannel(
+			EAsyncTraceType::Single, Sweep.StartLocation, Sweep.EndLocation, FQuat::Identity,
+			ECollisionChannel::ECC_Visibility, Capsule, QueryParams, FCollisionResponseParams::DefaultResponseParam,
+			&ClearanceTraceDelegate, ClearanceCache.Generation));
+	}
+}
+
+void AGrapplingSystemCharacter::OnClearanceTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	// Results of a batch that has been replaced since are of no use
+	if(TraceDatum.UserData != ClearanceCache.Generation) return;
+
+	if(const FHitResult* Hit = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits))
+	{
+		// Keep the earliest obstacle along the leap
+		const int32 SweepIndex = ClearanceCache.TraceHandles.IndexOfByKey(TraceHandle);
+		if(ClearanceCache.Sweeps.IsValidIndex(SweepIndex))
+		{
+			const float LeapFraction = FGrapplingTrajectory::GetLeapFraction(ClearanceCache.Sweeps[SweepIndex], Hit->Time);
+			ClearanceCache.BlockedLeapFraction = FMath::Min(ClearanceCache.BlockedLeapFraction, LeapFraction);
+		}
+		ClearanceCache.bBlocked = true;
+	}
+	ClearanceCache.PendingSweeps--;
+
+	// Resolve the press that waited for the batch, unless the focused point changed meanwhile
+	if(ClearanceCache.PendingSweeps == 0 && ClearanceCache.bThrowWaiting)
+	{
+		ClearanceCache.bThrowWaiting = false;
+		if(!bIsGrappling && !bIsRotatingTowardsGrapplePoint && ClearanceCache.EndLocation.Equals(GrappleEndLocation, KINDA_SMALL_NUMBER))
+		{
+			ResolveGrappleCheck(ClearanceCache.bBlocked);
+		}
+	}
 }
 
 void AGrapplingSystemCharacter::RotateTowardsGrapplingPoint(float DeltaTime)
 {
 	if(!bIsRotatingTowardsGrapplePoint) return;
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_Rotate);
 
 	// Simple rotation towards the grappling point, before to actually leap towards it
 	FVector GrappleDirection = UKismetMathLibrary::GetDirectionUnitVector(GrappleStartLocation, GrappleEndLocation);
@@ -228,126 +767,342 @@ void AGrapplingSystemCharacter::RotateTowardsGrapplingPoint(float DeltaTime)
 	GetCapsuleComponent()->SetWorldRotation(InterpRotation);
 }
 
-void AGrapplingSystemCharacter::Grapple(float DeltaTime)
+void AGrapplingSystemCharacter::OnGrappleLeapFinished()
 {
-	// Since the function is called every frame it has to check if the character
-	// is actually doing the leap, if not exit
 	if(!bIsGrappling) return;
 
-	// Stop rotating towards the grapple point
-	bIsRotatingTowardsGrapplePoint = false;
-
-	// Increase the elapsed time, which is used as Linear Interpolation Alpha for the leap motion
-	ElapsedGrapplingTime+= DeltaTime;
-	const float LerpValue = FMath::Clamp(ElapsedGrapplingTime/GrappleTotalDuration,0.f,1.f);
-
-	// Sample the curve value to determine the vertical position of the character
-	const float CurveValue = GrapplingVerticalCurve->GetFloatValue(LerpValue);
-	const FVector NewLocation = UKismetMathLibrary::VLerp(GrappleStartLocation, GrappleEndLocation, LerpValue) + GetActorUpVector()*CurveValue*300.f;
-	FLatentActionInfo LatentInfo;
-	LatentInfo.CallbackTarget = this;
-
-	// Move the character to the new position
-	UKismetSystemLibrary::MoveComponentTo(GetCapsuleComponent(), NewLocation, GetActorRotation(),
-	                                      false, false, 0.1f, false, EMoveComponentAction::Move, LatentInfo);
+	// The character reached destination, stop all the leap logic and put away the rope he's holding
+	bIsGrappling = false;
+	FGrapplingCounters::AddActiveGrapples(-1);
 
-	// If the character reached destination, stop all the leap logic for next
-	// frame and destroy the rope he's holding
-	if(ElapsedGrapplingTime >= GrappleTotalDuration)
+	// Leaps are recorded where they started, simulated proxies only play them back
+	if(HasAuthority() || IsLocallyControlled())
 	{
-		bIsGrappling = false;
-		ThrowableRope->DestroyComponent();
+		if(UGrapplingReplaySubsystem* Replay = GetWorld()->GetSubsystem<UGrapplingReplaySubsystem>())
+		{
+			Replay->RecordLeapEnd(this, GetActorLocation());
+		}
+		const float Now = GetWorld()->GetTimeSeconds();
+		RecordTelemetry(EGrapplingTelemetryEventType::LeapFinished, FVector::Dist(GrappleStartLocation, GetActorLocation()), Now - LeapStartTime);
+		if(ActiveRopeGuide)
+		{
+			RecordTelemetry(EGrapplingTelemetryEventType::RopeReleased, 0.f, Now - RopeThrowTime);
+		}
+	}
+	if(bLeapPausedMovementReplication)
+	{
+		// Proxies take the landing location from the movement updates again
+		SetReplicatingMovement(true);
+		bLeapPausedMovementReplication = false;
 	}
+	if(UGrapplingRopePoolSubsystem* RopePool = GetWorld()->GetSubsystem<UGrapplingRopePoolSubsystem>())
+	{
+		RopePool->ReleaseRope(ThrowableRope);
+		RopePool->ReleaseRopeGuide(ActiveRopeGuide);
+	}
+	ThrowableRope = nullptr;
+	ActiveRopeGuide = nullptr;
 }
 
 void AGrapplingSystemCharacter::Rope()
 {
-	// Spawn the object that will act as rope end and move towards the grappling point
-	FActorSpawnParameters SpawnParams;
-	ARopeGuide* RopeGuide = GetWorld()->SpawnActor<ARopeGuide>(RopeGuideObject, GetTransform(), SpawnParams);
-	RopeGuide->SetTarget(GetActorLocation(),GrappleScenePoint->GetComponentLocation());
-	RopeGuide->RegisterAllComponents();
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_Rope);
+	CSV_SCOPED_TIMING_STAT(Grappling, Rope);
+
+	UGrapplingRopePoolSubsystem* RopePool = GetWorld()->GetSubsystem<UGrapplingRopePoolSubsystem>();
+	if(!RopePool) return;
 
-	// Spawn the cable component that will act as rope, and fix one end to the character's hand, and the
+	// Take the object that will act as rope end and move towards the grappling point from the pool
+	ActiveRopeGuide = RopePool->AcquireRopeGuide(RopeGuideObject.Get(), GetTransform());
+	if(!ActiveRopeGuide) return;
+	RopeThrowTime = GetWorld()->GetTimeSeconds();
+	ActiveRopeGuide->SetTarget(GetActorLocation(),GrappleEndLocation - FVector::UpVector*GrappleEndVerticalOffset);
+
+	// Take a rope component from the pool, and fix one end to the character's hand, and the
 	// other end to the object that moves towards the grappling point
 	FAttachmentTransformRules AttRules = FAttachmentTransformRules( EAttachmentRule::KeepRelative, false );;
-	ThrowableRope = NewObject<UCableComponent>(this, UCableComponent::StaticClass(), FName("ThrowableRope"));
-	ThrowableRope->CableLength = UKismetMathLibrary::Vector_Distance(GrappleStartLocation, GrappleEndLocation)/2;
+	ThrowableRope = RopePool->AcquireRope();
+	ThrowableRope->RopeLength = UKismetMathLibrary::Vector_Distance(GrappleStartLocation, GrappleEndLocation)/2;
 	ThrowableRope->EndLocation = {0,0,0};
 	ThrowableRope->AttachToComponent(GetMesh(), AttRules,"hand_rSocket");
-	ThrowableRope->SetAttachEndToComponent(RopeGuide->Mesh);
-	ThrowableRope->RegisterComponent();
+	ThrowableRope->SetAttachEndToComponent(ActiveRopeGuide->Mesh);
 }
 
 void AGrapplingSystemCharacter::AnimNotify_GrappleLeapStart(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation)
 {
+	StartLeap();
+}
+
+void AGrapplingSystemCharacter::StartLeap()
+{
+	// The notify and the timer can both fire for a throw whose character became visible midway,
+	// the first one starts the leap
+	if(!bIsRotatingTowardsGrapplePoint) return;
+	GetWorldTimerManager().ClearTimer(LeapStartTimer);
+
 	// The leap start point is updated here to handle cases where the 
 	// character starts the grapple when he's in the air and moving
 	GrappleStartLocation = GetActorLocation();
 	
-	// Setting bGrappling to true, the leap movement will start
+	// Setting bGrappling to true and stopping the rotation towards the grapple point,
+	// the movement component takes over and starts the leap movement
+	if(!bIsGrappling) FGrapplingCounters::AddActiveGrapples(1);
 	bIsGrappling = true;
+	bIsRotatingTowardsGrapplePoint = false;
+	AnchorTarget = GrappleTarget;
+	GrapplingMovement->StartLeap(MakeTrajectory(GrappleStartLocation, GrappleEndLocation), GrappleTotalDuration);
+	if(UGrapplingReplaySubsystem* Replay = GetWorld()->GetSubsystem<UGrapplingReplaySubsystem>())
+	{
+		Replay->RecordLeapStart(this, AnchorTarget, GrappleStartLocation, GrappleEndLocation);
+	}
+	LeapStartTime = GetWorld()->GetTimeSeconds();
+	RecordTelemetry(EGrapplingTelemetryEventType::LeapStarted, GrappleTotalDistance, GrappleTotalDuration);
+
+	// Simulated proxies play the leap from this single update, the movement stream pauses until it ends
+	if(HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+		ReplicatedLeap.LeapCount++;
+		ReplicatedLeap.Start = GrappleStartLocation;
+		ReplicatedLeap.End = GrappleEndLocation;
+		ReplicatedLeap.PointId = AnchorTarget.GetPointId();
+		ReplicatedLeap.ServerStartTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+		if(IsReplicatingMovement())
+		{
+			SetReplicatingMovement(false);
+			bLeapPausedMovementReplication = true;
+		}
+	}
 	
 	// bGrapplePointFocused was set to true to avoid the grapple button spam,
 	// but now that the leap started it's reset so the character can grapple again
 	bGrapplePointFocused = false;
-	ElapsedGrapplingTime = 0;
-	
+	SetFocusedTarget(FGrapplingPointTarget());
 }
 
-bool AGrapplingSystemCharacter::LineTraceGrapplingPoint()
+void AGrapplingSystemCharacter::OnRep_ReplicatedLeap()
 {
-	// Disable line tracing while the grappling routine has started
-	if(bIsGrappling || bIsRotatingTowardsGrapplePoint) return false;
-	
-	// Get Viewport Size
-	FVector2D ViewportSize;
-	if (GEngine && GEngine->GameViewport)
+	// Without the curve the leap cannot be rebuilt, the proxy then follows the server as usual
+	if(GetLocalRole() != ROLE_SimulatedProxy || !bGrappleAssetsLoaded) return;
+
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const float ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	const float ElapsedTime = FMath::Max(ServerTime - ReplicatedLeap.ServerStartTime, 0.f);
+	const float Distance = FVector::Dist(ReplicatedLeap.Start, ReplicatedLeap.End);
+	const float Duration = GrappleCore::LeapDuration(Distance, GrapplingSpeed);
+
+	// Leaps already over, as players joining late receive them, are not worth playing
+	if(ElapsedTime >= Duration) return;
+
+	FGrapplingPointTarget Target;
+	if(const UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>())
+	{
+		const int32 Index = Registry->FindPoint(ReplicatedLeap.PointId);
+		if(Index != INDEX_NONE)
+		{
+			Target = FGrapplingPointTarget::FromEntry(Registry->GetEntry(Index));
+		}
+	}
+
+	// A leap still going on locally ends here, putting its rope away
+	if(bIsGrappling)
+	{
+		GrapplingMovement->SetMovementMode(MOVE_Falling);
+	}
+
+	// The start is quantized and the proxy lags behind the server: close enough, the leap starts from
+	// where the proxy is rather than popping it over by the error
+	const FVector OldLocation = GetActorLocation();
+	const FQuat OldRotation = GetActorQuat();
+	const bool bStartFromProxy = FVector::DistSquared(OldLocation, ReplicatedLeap.Start) <= FMath::Square(ProxyLeapStartTolerance);
+
+	GrappleTarget = Target;
+	GrappleStartLocation = bStartFromProxy ? OldLocation : FVector(ReplicatedLeap.Start);
+	GrappleEndLocation = ReplicatedLeap.End;
+	GrappleTotalDistance = Distance;
+	GrappleTotalDuration = Duration;
+
+	// The rope flies from the hand as if just thrown, while the leap catches up with the server
+	Rope();
+	if(!bIsGrappling) FGrapplingCounters::AddActiveGrapples(1);
+	bIsGrappling = true;
+	bIsRotatingTowardsGrapplePoint = false;
+	AnchorTarget = Target;
+	LeapStartTime = GetWorld()->GetTimeSeconds() - ElapsedTime;
+	const FGrapplingTrajectory Trajectory = MakeTrajectory(GrappleStartLocation, GrappleEndLocation);
+
+	// Farther away, the capsule is put where the server is in the leap and the mesh blends over from where it was
+	if(!bStartFromProxy)
+	{
+		const FVector LeapLocation = Trajectory.GetLocation(Duration > 0.f ? ElapsedTime / Duration : 1.f);
+		SetActorLocation(LeapLocation, false, nullptr, ETeleportType::TeleportPhysics);
+		GrapplingMovement->SmoothCorrection(OldLocation, OldRotation, GetActorLocation(), GetActorQuat());
+	}
+	GrapplingMovement->StartLeap(Trajectory, Duration, ElapsedTime);
+}
+
+void AGrapplingSystemCharacter::SetFocusedTarget(const FGrapplingPointTarget& Target)
+{
+	if(FocusedTarget.IsValid() && FocusedTarget != Target)
+	{
+		FocusedTarget.SetFocused(false);
+	}
+	if(Target.IsValid())
+	{
+		Target.SetFocused(true);
+	}
+	if(Target != FocusedTarget)
+	{
+		FocusStartTime = GetWorld()->GetTimeSeconds();
+	}
+	FocusedTarget = Target;
+}
+
+void AGrapplingSystemCharacter::RecordTelemetry(EGrapplingTelemetryEventType Type, float Distance, float Duration) const
+{
+	if(UGrapplingTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UGrapplingTelemetrySubsystem>())
+	{
+		Telemetry->Record(Type, this, Distance, Duration);
+	}
+}
+
+bool AGrapplingSystemCharacter::FocusGrappleTarget(const FGrapplingPointTarget& Target)
+{
+	if(!Target.IsValid())
+	{
+		SetFocusedTarget(FGrapplingPointTarget());
+		bGrapplePointFocused = false;
+		return false;
+	}
+
+	// If the target is a GrapplingPoint, send the message to enable it
+	// (which will cause its indicator to enlarge)
+	SetFocusedTarget(Target);
+	bGrapplePointFocused = true;
+	// Set the end location as the GrapplingPoint plus a small vertical offset
+	GrappleEndLocation = Target.GetLocation() + FVector::UpVector*GrappleEndVerticalOffset;
+	GrappleTarget = Target;
+	return true;
+}
+
+bool AGrapplingSystemCharacter::LineTraceGrapplingPoint(const FVector& ViewLocation, const FVector& ViewDirection)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_LineTrace);
+	CSV_SCOPED_TIMING_STAT(Grappling, LineTraceGrapplingPoint);
+
+	if(TargetSelection == EGrappleTargetSelection::ConeScoring)
 	{
-		GEngine->GameViewport->GetViewportSize(ViewportSize);
+		return FocusGrappleTarget(SelectConeTarget(ViewLocation, ViewDirection));
 	}
 
-	// Get screen space location of crosshairs
-	FVector2D CrosshairLocation(ViewportSize.X / 2.f, ViewportSize.Y / 2.f);
-	FVector CrosshairWorldPosition;
-	FVector CrosshairWorldDirection;
+	// Trace from the crosshair, at the center of the view, outward
+	const FVector Start{ ViewLocation };
+	const FVector End{ Start + ViewDirection * 50'000.f };
 	FHitResult OutHitResult;
 
-	// Get world position and direction of crosshairs
-	const bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(
-		UGameplayStatics::GetPlayerController(this, 0),
-		CrosshairLocation,
-		CrosshairWorldPosition,
-		CrosshairWorldDirection);
+	// The registry knows where every grappling point is, so the physics sweep only
+	// runs when at least one point actually lies along the crosshair ray
+	const UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>();
+	if(Registry && !Registry->HasPointInCone(Start, ViewDirection, 0.f, 50'000.f))
+	{
+		return FocusGrappleTarget(FGrapplingPointTarget());
+	}
+
+	FGrapplingCounters::AddSweeps(1);
+	GetWorld()->SweepSingleByChannel(OutHitResult, Start, End,FQuat::Identity, ECC_GameTraceChannel1,
+	                                 FCollisionShape::MakeBox(FVector(0.01f, 0.01f, 0.01f)));
 
-	if (bScreenToWorld)
+	FGrapplingPointTarget Target;
+	if(OutHitResult.bBlockingHit)
 	{
-		// Trace from Crosshair world location outward
-		const FVector Start{ CrosshairWorldPosition };
-		const FVector End{ Start + CrosshairWorldDirection * 50'000.f };
+		// If the line trace was successful check if the hit was a grappling point,
+		// it should be since the sweep was set to find only objects with that
+		// collision channel. Point sets tell which of their points was hit by the hit item
+		if(AGrapplingPoint* TraceHitItem = Cast<AGrapplingPoint>(OutHitResult.Actor))
+		{
+			Target = FGrapplingPointTarget(TraceHitItem);
+		}
+		else if(UGrapplingPointSetComponent* PointSet = Cast<UGrapplingPointSetComponent>(OutHitResult.GetComponent()))
+		{
+			Target = FGrapplingPointTarget(PointSet, PointSet->GetHitInstance(OutHitResult));
+		}
+	}
+	return FocusGrappleTarget(Target);
+}
 
-		GetWorld()->SweepSingleByChannel(OutHitResult, Start, End,FQuat::Identity, ECC_GameTraceChannel1,
-		                                 FCollisionShape::MakeBox(FVector(0.01f, 0.01f, 0.01f)));
+void AGrapplingSystemCharacter::UpdateFocus()
+{
+	// Only a local player looks through a crosshair, other characters are given their target
+	const APlayerController* PlayerController = Cast<APlayerController>(Controller);
+	if(!PlayerController || !PlayerController->IsLocalController()) return;
 
-		if(OutHitResult.bBlockingHit)
+	// Disable focus tracking while the grappling routine has started, and look again once it is over
+	if(bIsGrappling || bIsRotatingTowardsGrapplePoint)
+	{
+		FocusCache.bValid = false;
+		return;
+	}
+
+	// The crosshair sits at the center of the view, along the camera forward
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
+
+	const UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>();
+	const uint32 RegistryVersion = Registry ? Registry->GetVersion() : 0;
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	// Keep the focus while neither the camera nor the points moved enough to change it.
+	// Collision changes are not versioned, so the focus is refreshed now and then anyway
+	if(FocusCache.bValid
+		&& FocusCache.RegistryVersion == RegistryVersion
+		&& Now - FocusCache.Time < FocusMaxInterval
+		&& FVector::DistSquared(FocusCache.ViewLocation, ViewLocation) <= FMath::Square(FocusMoveThreshold)
+		&& FVector::DotProduct(FocusCache.ViewDirection, ViewDirection) >= FMath::Cos(FMath::DegreesToRadians(FocusAngleThreshold)))
+	{
+		return;
+	}
+
+	// Split screen players take turns, so a single frame never pays for every one of them
+	if(FocusCache.bValid)
+	{
+		const ULocalPlayer* LocalPlayer = PlayerController->GetLocalPlayer();
+		const UGameInstance* GameInstance = GetGameInstance();
+		const int32 PlayerCount = GameInstance ? GameInstance->GetNumLocalPlayers() : 1;
+		if(PlayerCount > 1 && LocalPlayer)
 		{
-			// If the line trace was successful check if the hit was a grappling point,
-			// it should be since the sweep was set to find only objects with that
-			// collision channel
-			AGrapplingPoint* TraceHitItem= Cast<AGrapplingPoint>(OutHitResult.Actor);
-			if(TraceHitItem)
-			{
-				// If the hit item is a GrapplingPoint, send the message to enable it
-				// (which will cause its UI Widget to enlarge
-				TraceHitItem->EnableFocused();
-				bGrapplePointFocused = true;
-				// Set the end location as the GrapplingPoint plus a small vertical offset
-				GrappleEndLocation = TraceHitItem->GetActorLocation() + FVector::UpVector*GrappleEndVerticalOffset;
-				GrappleScenePoint = OutHitResult.GetComponent();
-				return true;
-			}
+			const int32 PlayerIndex = GameInstance->GetLocalPlayers().IndexOfByKey(LocalPlayer);
+			if((GFrameCounter + PlayerIndex) % PlayerCount != 0) return;
 		}
 	}
-	bGrapplePointFocused = false;
-	return false;
+
+	FocusCache.bValid = true;
+	FocusCache.ViewLocation = ViewLocation;
+	FocusCache.ViewDirection = ViewDirection;
+	FocusCache.RegistryVersion = RegistryVersion;
+	FocusCache.Time = Now;
+	LineTraceGrapplingPoint(ViewLocation, ViewDirection);
+}
+
+FGrapplingPointTarget AGrapplingSystemCharacter::SelectConeTarget(const FVector& ViewLocation, const FVector& ViewDirection) const
+{
+	const UGrapplingPointSubsystem* Registry = GetWorld()->GetSubsystem<UGrapplingPointSubsystem>();
+	if(!Registry) return FGrapplingPointTarget();
+
+	const int32 Best = Registry->FindBestInCone(ViewLocation, ViewDirection, FMath::DegreesToRadians(TargetConeHalfAngle),
+	                                            TargetMaxDistance, TargetAngleWeight, TargetDistanceWeight);
+	if(Best == INDEX_NONE) return FGrapplingPointTarget();
+
+	const FGrapplingPointTarget Target = FGrapplingPointTarget::FromEntry(Registry->GetEntry(Best));
+	if(!bTargetRequireLineOfSight) return Target;
+
+	// Only the winner is confirmed, stopping short of its hitbox so that any blocking hit is an obstacle
+	const FGrapplingPointEntry& Entry = Registry->GetEntry(Best);
+	const FVector ToPoint = Entry.Location - ViewLocation;
+	const FVector End = Entry.Location - ToPoint.GetSafeNormal() * Entry.Radius;
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(GrappleTargetLineOfSight), false, this);
+	FGrapplingCounters::AddSweeps(1);
+	return GetWorld()->LineTraceTestByChannel(ViewLocation, End, ECC_Visibility, Params) ? FGrapplingPointTarget() : Target;
 }
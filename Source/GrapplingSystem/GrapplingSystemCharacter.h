@@ -3,11 +3,126 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "CableComponent.h"
+#include "GrappleReachabilityGraph.h"
+#include "GrapplingCurveLUT.h"
+#include "GrapplingPointSetComponent.h"
+#include "GrapplingTrajectory.h"
 #include "RopeGuide.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Engine/NetSerialization.h"
 #include "GameFramework/Character.h"
 #include "GrapplingSystemCharacter.generated.h"
 
+class AGrapplingPoint;
+struct FStreamableHandle;
+enum class EGrapplingTelemetryEventType : uint8;
+
+/** How a character picks the grappling point it is looking at */
+UENUM(BlueprintType)
+enum class EGrappleTargetSelection : uint8
+{
+	/** The point the crosshair ray hits */
+	CrosshairTrace,
+
+	/** The best scoring point of a cone around the camera forward, confirmed by a single trace */
+	ConeScoring
+};
+
+/** Result of the background obstacle tests a character runs for its focused grappling point */
+struct FGrappleClearanceCache
+{
+	/** Incremented every time new tests are issued, so results of older batches are ignored */
+	uint32 Generation = 0;
+
+	/** Tests of the current batch that have not reported back yet */
+	int32 PendingSweeps = 0;
+
+	/** Has any test of the current batch hit an obstacle? */
+	bool bBlocked = false;
+
+	/** Earliest leap fraction at which a test of the current batch hit an obstacle */
+	float BlockedLeapFraction = 1.f;
+
+	/** Sweeps of the current batch, in leap order */
+	TArray<FGrappleTrajectorySweep> Sweeps;
+
+	/** Trace handles of the current batch, matching Sweeps */
+	TArray<FTraceHandle> TraceHandles;
+
+	/** Leap start location the batch was issued for */
+	FVector StartLocation = FVector::ZeroVector;
+
+	/** Leap end location the batch was issued for */
+	FVector EndLocation = FVector::ZeroVector;
+
+	/** World time the batch was issued at */
+	float IssueTime = 0.f;
+
+	/** Is there any batch issued or completed? */
+	bool bValid = false;
+
+	/** Was the grapple pressed while the batch was in flight? It is resolved when the last test reports back */
+	bool bThrowWaiting = false;
+};
+
+/** View the focused grappling point of a local player was last looked up from */
+struct FGrappleFocusCache
+{
+	FVector ViewLocation = FVector::ZeroVector;
+
+	FVector ViewDirection = FVector::ForwardVector;
+
+	/** Version of the point registry at the time of the lookup */
+	uint32 RegistryVersion = 0;
+
+	/** World time of the lookup */
+	float Time = 0.f;
+
+	/** Is there any lookup to compare with? */
+	bool bValid = false;
+};
+
+/**
+ * Leap of a character as replicated to simulated proxies, once per leap, for them to play it on
+ * their own instead of receiving movement updates. Locations are rounded to the centimetre and
+ * packed, the point id is only sent when there is one: a leap takes a few dozen bytes
+ */
+USTRUCT()
+struct FGrappleLeapReplication
+{
+	GENERATED_BODY()
+
+	/** Incremented on every leap, so that two identical leaps in a row still replicate */
+	UPROPERTY()
+	uint8 LeapCount = 0;
+
+	/** Location the leap started from on the server */
+	UPROPERTY()
+	FVector_NetQuantize Start = FVector::ZeroVector;
+
+	UPROPERTY()
+	FVector_NetQuantize End = FVector::ZeroVector;
+
+	/** Point leapt to, invalid if it is not a registered point */
+	UPROPERTY()
+	FGuid PointId;
+
+	/** Server world time the leap started at */
+	UPROPERTY()
+	float ServerStartTime = 0.f;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGrappleLeapReplication> : public TStructOpsTypeTraitsBase2<FGrappleLeapReplication>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
 UCLASS(config=Game)
 class AGrapplingSystemCharacter : public ACharacter
 {
@@ -21,7 +136,7 @@ class AGrapplingSystemCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FollowCamera;
 public:
-	AGrapplingSystemCharacter();
+	AGrapplingSystemCharacter(const FObjectInitializer& ObjectInitializer);
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -31,9 +146,16 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	float BaseLookUpRate;
 
-	/** Component that will act as rope end */
+	/** Component that will act as rope end. Only drawn, so dedicated servers never load it */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
-	TSubclassOf<ARopeGuide> RopeGuideObject;
+	TSoftClassPtr<ARopeGuide> RopeGuideObject;
+
+	/** Are the grappling assets loaded? The character cannot grapple before they are */
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	bool AreGrappleAssetsLoaded() const { return bGrappleAssetsLoaded; }
+
+	/** Lists the assets the character needs to grapple, the cosmetic ones only if asked for */
+	void GetGrappleAssetPaths(bool bIncludeCosmetic, TArray<FSoftObjectPath>& OutPaths) const;
 
 protected:
 
@@ -66,6 +188,12 @@ protected:
 
 	void Tick(float DeltaSeconds) override;
 
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
@@ -77,6 +205,25 @@ public:
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
 
+	/** Starts a grapple towards the given point without having to look at it, as AI and scripted
+	 *  characters do. Returns true if the path is clear and the throw started */
+	UFUNCTION(BlueprintCallable, Category = "Grappling")
+	bool TryGrappleTo(AGrapplingPoint* Point);
+
+	/** TryGrappleTo for any grappling point, including the instances of point sets */
+	bool TryGrappleToTarget(const FGrapplingPointTarget& Target);
+
+	/** TryGrappleTo for a leap ending at EndLocation with no grappling point there, as when a replay
+	 *  refers to a point missing from the map */
+	bool TryGrappleToLocation(const FVector& EndLocation);
+
+	/** Leap parameters of this character, to bake reachability graphs with */
+	FGrappleReachabilitySettings MakeReachabilitySettings(float MaxRange) const;
+
+	/** Is the character throwing the rope or leaping? */
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	bool IsGrappleInProgress() const { return bIsGrappling || bIsRotatingTowardsGrapplePoint; }
+
 	UFUNCTION(BlueprintCallable, Category = "Grappling")
 	//void AnimNotify_GrappleLeapStartNow();
 	void AnimNotify_GrappleLeapStart(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation);
@@ -98,9 +245,6 @@ protected:
 	/** Distance between the character and the grappling point when he starts the leap */
 	float GrappleTotalDistance;
 
-	/** Time passed since the character started the grappling leap */
-	float ElapsedGrapplingTime;
-
 	/** Estimate total time it takes for the character to reach the grappling point when he starts the leap */
 	float GrappleTotalDuration;
 
@@ -114,24 +258,221 @@ protected:
 	FVector GrappleEndLocation;
 
 	/** Rope that is spawned when the character starts the grappling leap */
-	UCableComponent* ThrowableRope;
+	UPROPERTY(Transient)
+	class UGrapplingRopeComponent* ThrowableRope;
+
+	/** Rope end flying towards the grappling point, taken from the rope pool */
+	UPROPERTY(Transient)
+	ARopeGuide* ActiveRopeGuide;
+
+	/** World time the rope was thrown at, for the telemetry */
+	float RopeThrowTime;
+
+	/** World time the leap started at, for the telemetry */
+	float LeapStartTime;
+
+	/** World time the focused point was focused at, for the telemetry */
+	float FocusStartTime;
+
+	/** Did the server stop replicating the movement of the character for the current leap? */
+	bool bLeapPausedMovementReplication;
 	
-	/** Raytrace looking for a grappling point */
-	bool LineTraceGrapplingPoint();
+	/** Raytrace looking for a grappling point along the given view */
+	bool LineTraceGrapplingPoint(const FVector& ViewLocation, const FVector& ViewDirection);
+
+	/** For locally controlled players, looks for the grappling point at the crosshair again when the
+	 *  camera or the points moved since the last lookup */
+	void UpdateFocus();
+
+	/** View of the last focus lookup */
+	FGrappleFocusCache FocusCache;
+
+	/** Distance the camera can move before the focused grappling point is looked up again */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float FocusMoveThreshold;
+
+	/** Angle the camera can turn before the focused grappling point is looked up again, in degrees */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float FocusAngleThreshold;
+
+	/** Longest time the focused grappling point is kept without being looked up again, in seconds */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float FocusMaxInterval;
+
+	/** How the grappling point the character is looking at is picked */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	EGrappleTargetSelection TargetSelection;
+
+	/** In cone scoring mode, half angle of the cone around the camera forward, in degrees */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true", ClampMin = "0.1", ClampMax = "89"))
+	float TargetConeHalfAngle;
+
+	/** In cone scoring mode, farthest a grappling point can be picked from. The server also refuses
+	 *  grapple requests for points farther than this from the character */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float TargetMaxDistance;
+
+	/** Half angle of the cone around the aim of a remote client in which the server accepts its grapple
+	 *  requests, in degrees. Wider than the targeting cone, as the camera sits behind the character */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "180"))
+	float ServerAimConeHalfAngle;
+
+	/** In cone scoring mode, weight of being close to the camera forward */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float TargetAngleWeight;
+
+	/** In cone scoring mode, weight of being close to the camera */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float TargetDistanceWeight;
+
+	/** In cone scoring mode, should the best point be dropped when something is between it and the camera? */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	bool bTargetRequireLineOfSight;
+
+	/** Picks the best scoring grappling point of the cone in front of the camera */
+	FGrapplingPointTarget SelectConeTarget(const FVector& ViewLocation, const FVector& ViewDirection) const;
+
+	/** Grappling point the crosshair is on, whose indicator is highlighted */
+	UPROPERTY(Transient)
+	FGrapplingPointTarget FocusedTarget;
+
+	/** Moves the highlight to another grappling point, or removes it if Target is invalid */
+	void SetFocusedTarget(const FGrapplingPointTarget& Target);
+
+	/** Adds a grappling telemetry event about this character, if telemetry is being recorded */
+	void RecordTelemetry(EGrapplingTelemetryEventType Type, float Distance, float Duration) const;
+
+	/** Makes Target the point a grapple press goes to, or drops the focus if it is invalid.
+	 *  Returns true if a point is focused */
+	bool FocusGrappleTarget(const FGrapplingPointTarget& Target);
 
 	/** Evaluates if the character can start a leap, checking if a grappling point is selected and if there
 	 *  are no obstacles in the path */
 	void StartGrappling();
+
+	/** Spawns the rope and plays the throw, once the leap path is known to be clear */
+	void BeginGrappleThrow();
+
+	/** Aims the grapple at a point, from the current location of the character */
+	void SetGrappleTarget(const FGrapplingPointTarget& Target);
+
+	/** Is a grapple request waiting for the server to validate it? */
+	bool bGrappleRequestPending;
+
+	/** Asks the server to validate a grapple towards Target. Queued with the requests of every client */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerRequestGrapple(const FGrapplingPointTarget& Target);
+
+	/** Could the client have aimed at Target, given where the character is and where it aims on the server? */
+	bool IsGrappleRequestInReach(const FGrapplingPointTarget& Target) const;
+
+	/** Result of a queued server validation */
+	void OnServerGrappleValidated(bool bClear);
+
+	/** Tells the owning client whether its grapple request was accepted */
+	UFUNCTION(Client, Reliable)
+	void ClientGrappleValidated(const FGrapplingPointTarget& Target, bool bAccepted);
+
+	/** Number of capsule-casts used to check if the leap path is clear in discrete mode, plus one */
+	static constexpr int32 ClearanceTestCount = 10;
+
+	/** How the leap path is checked for obstacles */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	EGrappleValidationMode ValidationMode;
+
+	/** In swept mode, how far a swept segment may stray from the leap curve */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float ValidationTolerance;
+
+	/** In swept mode, the most segments a leap path is split into */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	int32 MaxValidationSegments;
+
+	/** Focuses Target, which may be invalid, and presses the grapple button for a leap ending at EndLocation */
+	bool TryGrappleTowards(const FGrapplingPointTarget& Target, const FVector& EndLocation);
+
+	/** Leap path from Start to End */
+	FGrapplingTrajectory MakeTrajectory(const FVector& Start, const FVector& End) const;
+
+	/** Lists the sweeps that check the leap path from Start to End for obstacles */
+	void BuildValidationSweeps(const FVector& Start, const FVector& End, TArray<FGrappleTrajectorySweep>& OutSweeps) const;
+
+	/** Result of the background obstacle tests for the focused grappling point */
+	FGrappleClearanceCache ClearanceCache;
+
+	FTraceDelegate ClearanceTraceDelegate;
+
+	/** Distance the character can move before the background obstacle tests are issued again */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float SpeculativeClearanceMoveThreshold;
+
+	/** Seconds after which the background obstacle tests are issued again, even if the character did not move,
+	 *  so moving obstacles are not missed */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float SpeculativeClearanceMaxAge;
+
+	/** Grappling point the character last leapt to */
+	UPROPERTY(Transient)
+	FGrapplingPointTarget AnchorTarget;
+
+	/** Last leap started on the server, for simulated proxies to play */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_ReplicatedLeap)
+	FGrappleLeapReplication ReplicatedLeap;
+
+	/** Starts the replicated leap on a simulated proxy, from where the server is in it, along with the rope flight */
+	UFUNCTION()
+	void OnRep_ReplicatedLeap();
+
+	/** How far a simulated proxy may be from the start of a replicated leap for the leap to start where
+	 *  the proxy is. Farther, the proxy is moved onto the leap and its mesh blends over */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float ProxyLeapStartTolerance;
+
+	/** How close to where it landed on its last grappling point the character must be for the
+	 *  baked reachability of that point to be used instead of sweeping */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float BakedReachabilityTolerance;
+
+	/** Baked result of a leap to the focused point, Unknown unless the character stands where it landed on a point */
+	EGrappleReachability GetBakedReachability() const;
+
+	/** Does the cached obstacle test batch still describe a leap from Start to End? */
+	bool IsClearanceCacheFresh(const FVector& Start, const FVector& End) const;
+
+	/** While a grappling point is focused, checks the leap path in the background so a
+	 *  press can be resolved without sweeping on the game thread */
+	void UpdateSpeculativeClearance();
+
+	/** Collects the result of a background obstacle test */
+	void OnClearanceTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Throws the rope once the leap path has been checked, or gives up if an obstacle was found */
+	void ResolveGrappleCheck(bool bFoundAnyObstacle);
 	
-	/** Launches the character towards the focused grappling point */
-	void Grapple(float DeltaTime);
+	/** Movement component, that moves the character along the leap in its grappling mode */
+	UPROPERTY()
+	class UGrapplingMovementComponent* GrapplingMovement;
+
+	/** Called by the movement component when the leap is over, to put the rope away */
+	void OnGrappleLeapFinished();
 
 	/** Rotate the character towards the focused grappling point */
 	void RotateTowardsGrapplingPoint(float DeltaTime);
 
 	/** Vertical displacement in the grappling leap motion */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
-	UCurveFloat* GrapplingVerticalCurve;
+	TSoftObjectPtr<UCurveFloat> GrapplingVerticalCurve;
+
+	/** Number of intervals GrapplingVerticalCurve is baked into before refinement */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	int32 CurveBakeResolution;
+
+	/** Largest difference allowed between the baked and the source GrapplingVerticalCurve */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	float CurveBakeTolerance;
+
+	/** GrapplingVerticalCurve baked into a lookup table when the character begins play */
+	FGrapplingCurveLUT GrapplingProfile;
 
 	/** Base speed multiplier of grappling leap */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
@@ -141,15 +482,44 @@ protected:
 	void Rope();
 
 	/** Reference to the focused grappling point, needed to set the end point of the spawned rope */
-	USceneComponent* GrappleScenePoint;
+	UPROPERTY(Transient)
+	FGrapplingPointTarget GrappleTarget;
 
 	/** Montage for throwing the grapple */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* GrappleThrowMontage;
+	TSoftObjectPtr<UAnimMontage> GrappleThrowMontage;
+
+	/** Are the curve, the montage and, where something is drawn, the rope guide class loaded? */
+	bool bGrappleAssetsLoaded;
+
+	/** Keeps the grappling assets loaded for as long as the character lives */
+	TSharedPtr<FStreamableHandle> GrappleAssetsHandle;
+
+	/** Starts loading the grappling assets in the background, when the character begins play */
+	void LoadGrappleAssets();
+
+	/** Prepares what depends on the grappling assets, then lets the character grapple */
+	void OnGrappleAssetsLoaded();
 
 	/** Reference to the Animations */
 	UAnimInstance* AnimInstance;
 
+	/** Time from the start of the throw montage to its leap start notify, negative if it has none */
+	float LeapStartDelay;
+
+	/** Starts the leap at the end of the throw, from the montage notify or from the leap start timer, whichever comes first */
+	void StartLeap();
+
+	FTimerHandle LeapStartTimer;
+
+	/** Finds when the leap start notify fires after the throw montage starts playing, negative if it never does */
+	static float FindLeapStartDelay(const UAnimMontage* Montage);
+
+	/** How the mesh animation ticks while nobody sees the character. Only applied when the leap can
+	 *  start without the throw notify */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Grappling", meta = (AllowPrivateAccess = "true"))
+	EVisibilityBasedAnimTickOption NotRenderedAnimTickOption;
+
 };
 
 
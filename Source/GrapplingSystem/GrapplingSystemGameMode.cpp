@@ -2,14 +2,71 @@
 
 #include "GrapplingSystemGameMode.h"
 #include "GrapplingSystemCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
+#include "GameFramework/PlayerController.h"
 
 AGrapplingSystemGameMode::AGrapplingSystemGameMode()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPersonCPP/Blueprints/ThirdPersonCharacter"));
-	if (PlayerPawnBPClass.Class != NULL)
+	// set default pawn class to our Blueprinted character, without loading it along with the game mode
+	DefaultPawnSoftClass = TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/ThirdPersonCPP/Blueprints/ThirdPersonCharacter.ThirdPersonCharacter_C")));
+}
+
+void AGrapplingSystemGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	if(DefaultPawnSoftClass.IsNull()) return;
+
+	// Commandlets do not tick the async loading, they would wait forever
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	if(IsRunningCommandlet())
+	{
+		PawnClassHandle = Streamable.RequestSyncLoad(DefaultPawnSoftClass.ToSoftObjectPath());
+		OnPawnClassLoaded();
+		return;
+	}
+	PawnClassHandle = Streamable.RequestAsyncLoad(DefaultPawnSoftClass.ToSoftObjectPath(),
+	                                              FStreamableDelegate::CreateUObject(this, &AGrapplingSystemGameMode::OnPawnClassLoaded),
+	                                              FStreamableManager::AsyncLoadHighPriority);
+}
+
+void AGrapplingSystemGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	// The player is spawned with the pawn class, so it waits until the class is in
+	if(PawnClassHandle.IsValid() && PawnClassHandle->IsLoadingInProgress())
+	{
+		PendingPlayers.Add(NewPlayer);
+		return;
+	}
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+}
+
+void AGrapplingSystemGameMode::OnPawnClassLoaded()
+{
+	if(UClass* PawnClass = DefaultPawnSoftClass.Get())
+	{
+		DefaultPawnClass = PawnClass;
+
+		// Start on the grappling assets right away, rather than when the first character begins play.
+		// Dedicated servers leave out what is only drawn
+		if(const AGrapplingSystemCharacter* Character = Cast<AGrapplingSystemCharacter>(PawnClass->GetDefaultObject()))
+		{
+			TArray<FSoftObjectPath> Paths;
+			Character->GetGrappleAssetPaths(GetNetMode() != NM_DedicatedServer, Paths);
+			if(Paths.Num() > 0)
+			{
+				GrappleAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Paths, FStreamableDelegate(),
+				                                                                             FStreamableManager::AsyncLoadHighPriority);
+			}
+		}
+	}
+
+	TArray<APlayerController*> Players = MoveTemp(PendingPlayers);
+	for(APlayerController* Player : Players)
 	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
+		if(IsValid(Player))
+		{
+			HandleStartingNewPlayer(Player);
+		}
 	}
 }
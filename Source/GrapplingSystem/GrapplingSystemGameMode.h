@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "GrapplingSystemGameMode.generated.h"
 
+struct FStreamableHandle;
+
 UCLASS(minimalapi)
 class AGrapplingSystemGameMode : public AGameModeBase
 {
@@ -13,7 +15,29 @@ class AGrapplingSystemGameMode : public AGameModeBase
 
 public:
 	AGrapplingSystemGameMode();
-};
 
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+
+protected:
+
+	/** Pawn of the players, loaded in the background when the game starts. Replaces DefaultPawnClass once
+	 *  loaded, players joining before then wait for it. Leave empty to use DefaultPawnClass as it is */
+	UPROPERTY(EditDefaultsOnly, Category = "Classes")
+	TSoftClassPtr<APawn> DefaultPawnSoftClass;
 
+private:
 
+	/** Keeps the pawn class loaded */
+	TSharedPtr<FStreamableHandle> PawnClassHandle;
+
+	/** Keeps the grappling assets of the pawn class loaded, so characters can grapple as soon as they spawn */
+	TSharedPtr<FStreamableHandle> GrappleAssetsHandle;
+
+	/** Players that joined while the pawn class was loading */
+	UPROPERTY()
+	TArray<APlayerController*> PendingPlayers;
+
+	void OnPawnClassLoaded();
+};
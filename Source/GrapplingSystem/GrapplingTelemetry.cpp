@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingTelemetry.h"
+
+#include "GrapplingSystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	constexpr uint32 TelemetryMagic = 0x4C545247; // "GRTL"
+	constexpr uint32 TelemetryVersion = 1;
+
+	const TCHAR* GetEventTypeName(EGrapplingTelemetryEventType Type)
+	{
+		switch(Type)
+		{
+		case EGrapplingTelemetryEventType::ThrowAttempted: return TEXT("ThrowAttempted");
+		case EGrapplingTelemetryEventType::ThrowBlocked: return TEXT("ThrowBlocked");
+		case EGrapplingTelemetryEventType::LeapStarted: return TEXT("LeapStarted");
+		case EGrapplingTelemetryEventType::LeapFinished: return TEXT("LeapFinished");
+		case EGrapplingTelemetryEventType::RopeReleased: return TEXT("RopeReleased");
+		}
+		return TEXT("Unknown");
+	}
+
+	void WriteText(FArchive& Archive, const FString& Text)
+	{
+		const FTCHARToUTF8 Utf8(*Text);
+		Archive.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+FGrapplingTelemetryWriter::FGrapplingTelemetryWriter(const FString& InDirectory, bool bInCsv, int64 InMaxFileSize, int32 InMaxFiles)
+	: Directory(InDirectory)
+	, SessionName(FDateTime::Now().ToString())
+	, bCsv(bInCsv)
+	, MaxFileSize(FMath::Max<int64>(InMaxFileSize, 1024))
+	, MaxFiles(FMath::Max(InMaxFiles, 1))
+{
+	IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+FGrapplingTelemetryWriter::~FGrapplingTelemetryWriter()
+{
+	if(File)
+	{
+		File->Close();
+	}
+}
+
+bool FGrapplingTelemetryWriter::Write(const FGrapplingTelemetryEvent* Events, int32 Count)
+{
+	if(Count <= 0) return true;
+	if((!File || File->Tell() >= MaxFileSize) && !OpenNextFile()) return false;
+
+	if(bCsv)
+	{
+		FString Lines;
+		Lines.Reserve(Count * 64);
+		for(int32 i = 0; i < Count; i++)
+		{
+			const FGrapplingTelemetryEvent& Event = Events[i];
+			Lines += FString::Printf(TEXT("%.3f,%u,%s,%.1f,%.3f\n"), Event.Time, Event.CharacterId,
+			                         GetEventTypeName(Event.Type), Event.Distance, Event.Duration);
+		}
+		WriteText(*File, Lines);
+	}
+	else
+	{
+		for(int32 i = 0; i < Count; i++)
+		{
+			FGrapplingTelemetryEvent Event = Events[i];
+			uint8 Type = uint8(Event.Type);
+			*File << Event.Time << Event.CharacterId << Event.Distance << Event.Duration << Type;
+		}
+	}
+
+	EventCount += Count;
+	return !File->IsError();
+}
+
+void FGrapplingTelemetryWriter::Flush()
+{
+	if(File)
+	{
+		File->Flush();
+	}
+}
+
+bool FGrapplingTelemetryWriter::OpenNextFile()
+{
+	if(File)
+	{
+		File->Close();
+		File.Reset();
+	}
+
+	FileIndex = (FileIndex + 1) % MaxFiles;
+	const FString Filename = FPaths::Combine(Directory, FString::Printf(TEXT("GrappleTelemetry_%s_%d.%s"), *SessionName, FileIndex,
+	                                                                     bCsv ? TEXT("csv") : TEXT("bin")));
+	File.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if(!File)
+	{
+		UE_LOG(LogGrappling, Error, TEXT("Could not open grappling telemetry file %s"), *Filename);
+		return false;
+	}
+
+	if(bCsv)
+	{
+		WriteText(*File, TEXT("Time,Character,Event,Distance,Duration\n"));
+	}
+	else
+	{
+		uint32 Magic = TelemetryMagic;
+		uint32 Version = TelemetryVersion;
+		*File << Magic << Version;
+	}
+	return true;
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Kinds of grappling telemetry events */
+enum class EGrapplingTelemetryEventType : uint8
+{
+	/** A throw was checked, with the leap distance and how long the point was focused before */
+	ThrowAttempted,
+
+	/** The checked throw found an obstacle, with the same values */
+	ThrowBlocked,
+
+	/** A leap started, with its distance and planned duration */
+	LeapStarted,
+
+	/** A leap ended, with the distance covered and how long it took */
+	LeapFinished,
+
+	/** A rope was put away, with how long it was out */
+	RopeReleased
+};
+
+/** One grappling telemetry event, kept small so recording it is a plain copy */
+struct FGrapplingTelemetryEvent
+{
+	/** World time of the event */
+	float Time = 0.f;
+
+	/** Unique id of the character object */
+	uint32 CharacterId = 0;
+
+	/** Distance of the throw or leap, 0 for ropes */
+	float Distance = 0.f;
+
+	/** Duration the event type is about, -1 when not known */
+	float Duration = 0.f;
+
+	EGrapplingTelemetryEventType Type = EGrapplingTelemetryEventType::ThrowAttempted;
+};
+
+/**
+ * Writes grappling telemetry events to rotating files: when the current file grows past the size
+ * limit the next one is started, and past the file count the oldest one is overwritten. Files are
+ * either CSV with a header line, or binary: a magic and version followed by the events, fields in order.
+ */
+class GRAPPLINGSYSTEM_API FGrapplingTelemetryWriter
+{
+public:
+
+	FGrapplingTelemetryWriter(const FString& InDirectory, bool bInCsv, int64 InMaxFileSize, int32 InMaxFiles);
+
+	~FGrapplingTelemetryWriter();
+
+	/** Appends Count events to the current file. Returns false if the file could not be written */
+	bool Write(const FGrapplingTelemetryEvent* Events, int32 Count);
+
+	/** Flushes the current file */
+	void Flush();
+
+	int64 NumEventsWritten() const { return EventCount; }
+
+private:
+
+	FString Directory;
+
+	/** Date of the session, shared by the names of its files */
+	FString SessionName;
+
+	bool bCsv = false;
+
+	int64 MaxFileSize = 0;
+
+	int32 MaxFiles = 0;
+
+	/** Index of the current file, cycling through MaxFiles */
+	int32 FileIndex = INDEX_NONE;
+
+	TUniquePtr<FArchive> File;
+
+	int64 EventCount = 0;
+
+	/** Closes the current file and starts the next one */
+	bool OpenNextFile();
+};
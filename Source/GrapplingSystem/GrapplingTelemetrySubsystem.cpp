@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingTelemetrySubsystem.h"
+
+#include "GrapplingSystem.h"
+#include "TimerManager.h"
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GrappleCore/GrappleEventRing.h"
+#include "Misc/CommandLine.h"
+
+/** Ring filled by the game thread and emptied by the drain task, which alone touches the writer */
+struct FGrapplingTelemetrySession
+{
+	/** A few seconds of heavy grappling in a full server */
+	static constexpr uint32 RingCapacity = 4096;
+
+	GrappleCore::TEventRing<FGrapplingTelemetryEvent, RingCapacity> Ring;
+
+	FGrapplingTelemetryWriter Writer;
+
+	FGrapplingTelemetrySession(const FString& Directory, bool bCsv, int64 MaxFileSize, int32 MaxFiles)
+		: Writer(Directory, bCsv, MaxFileSize, MaxFiles)
+	{
+	}
+
+	/** Writes everything in the ring. Only one drain may run at a time */
+	void Drain()
+	{
+		FGrapplingTelemetryEvent Events[256];
+		while(const uint32 Count = Ring.Pop(Events, uint32(UE_ARRAY_COUNT(Events))))
+		{
+			Writer.Write(Events, int32(Count));
+		}
+		Writer.Flush();
+	}
+};
+
+UGrapplingTelemetrySubsystem::UGrapplingTelemetrySubsystem()
+{
+	DrainInterval = 1.f;
+	MaxFileSize = 4 * 1024 * 1024;
+	MaxFiles = 8;
+	DroppedEvents = 0;
+}
+
+void UGrapplingTelemetrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString Directory;
+	if(InWorld.IsGameWorld() && FParse::Value(FCommandLine::Get(), TEXT("GrappleTelemetry="), Directory))
+	{
+		StartTelemetry(Directory, FParse::Param(FCommandLine::Get(), TEXT("GrappleTelemetryCsv")));
+	}
+}
+
+void UGrapplingTelemetrySubsystem::Deinitialize()
+{
+	StopTelemetry();
+	Super::Deinitialize();
+}
+
+void UGrapplingTelemetrySubsystem::StartTelemetry(const FString& Directory, bool bCsv)
+{
+	StopTelemetry();
+
+	Session = MakeShared<FGrapplingTelemetrySession, ESPMode::ThreadSafe>(Directory, bCsv, MaxFileSize, MaxFiles);
+	DroppedEvents = 0;
+	GetWorld()->GetTimerManager().SetTimer(DrainTimer, this, &UGrapplingTelemetrySubsystem::DrainAsync, FMath::Max(DrainInterval, 0.1f), true);
+}
+
+void UGrapplingTelemetrySubsystem::StopTelemetry()
+{
+	if(!Session) return;
+
+	if(UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(DrainTimer);
+	}
+	if(DrainTask.IsValid())
+	{
+		DrainTask.Wait();
+		DrainTask.Reset();
+	}
+
+	// Nothing else drains anymore, the rest is written here
+	Session->Drain();
+	UE_LOG(LogGrappling, Display, TEXT("Grappling telemetry stopped: %lld events written, %d dropped"),
+	       Session->Writer.NumEventsWritten(), DroppedEvents);
+	Session.Reset();
+}
+
+void UGrapplingTelemetrySubsystem::Record(EGrapplingTelemetryEventType Type, const AActor* Character, float Distance, float Duration)
+{
+	if(!Session) return;
+
+	FGrapplingTelemetryEvent Event;
+	Event.Time = GetWorld()->GetTimeSeconds();
+	Event.CharacterId = Character ? Character->GetUniqueID() : 0;
+	Event.Distance = Distance;
+	Event.Duration = Duration;
+	Event.Type = Type;
+	if(!Session->Ring.Push(Event))
+	{
+		DroppedEvents++;
+	}
+}
+
+void UGrapplingTelemetrySubsystem::DrainAsync()
+{
+	if(!Session || (DrainTask.IsValid() && !DrainTask.IsReady()) || Session->Ring.Num() == 0) return;
+
+	TSharedPtr<FGrapplingTelemetrySession, ESPMode::ThreadSafe> DrainedSession = Session;
+	DrainTask = Async(EAsyncExecution::ThreadPool, [DrainedSession]()
+	{
+		DrainedSession->Drain();
+	});
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingTelemetry.h"
+#include "Async/Future.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingTelemetrySubsystem.generated.h"
+
+struct FGrapplingTelemetrySession;
+
+/**
+ * Collects grappling analytics without logging on the game thread: throws, blocked throws, leaps
+ * and rope lifetimes are copied into a lock-free ring, which a thread pool task drains to rotating
+ * CSV or binary files at a fixed interval. Events recorded while the ring is full are dropped and
+ * counted, recording never waits. Starts with the world when -GrappleTelemetry=<Directory> is on
+ * the command line, in CSV when -GrappleTelemetryCsv is too.
+ */
+UCLASS(config=Game)
+class GRAPPLINGSYSTEM_API UGrapplingTelemetrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingTelemetrySubsystem();
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+	/** Starts writing telemetry files to Directory */
+	UFUNCTION(BlueprintCallable, Category = "Grappling")
+	void StartTelemetry(const FString& Directory, bool bCsv);
+
+	/** Writes the events still in the ring and closes the files */
+	UFUNCTION(BlueprintCallable, Category = "Grappling")
+	void StopTelemetry();
+
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	bool IsRecordingTelemetry() const { return Session.IsValid(); }
+
+	/** Number of events dropped because the ring was full since telemetry started */
+	UFUNCTION(BlueprintPure, Category = "Grappling")
+	int32 GetDroppedEvents() const { return DroppedEvents; }
+
+	/** Adds an event about Character. Game thread only */
+	void Record(EGrapplingTelemetryEventType Type, const AActor* Character, float Distance, float Duration);
+
+protected:
+
+	/** Seconds between two drains of the ring */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float DrainInterval;
+
+	/** Size in bytes past which the next telemetry file is started */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 MaxFileSize;
+
+	/** Number of telemetry files kept per session, the oldest one is overwritten past it */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 MaxFiles;
+
+private:
+
+	/** Ring and files, shared with the drain task */
+	TSharedPtr<FGrapplingTelemetrySession, ESPMode::ThreadSafe> Session;
+
+	/** Drain running in the thread pool, if any */
+	TFuture<void> DrainTask;
+
+	FTimerHandle DrainTimer;
+
+	int32 DroppedEvents;
+
+	/** Starts a drain, unless the previous one is still running */
+	void DrainAsync();
+};
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingTrajectory.h"
+
+#include "GrapplingCurveLUT.h"
+#include "GrapplingStats.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+
+constexpr float FGrapplingTrajectory::VerticalScale;
+
+FGrapplingTrajectory::FGrapplingTrajectory(const FVector& InStart, const FVector& InEnd, const FVector& InUp, const UCurveFloat* InCurve,
+                                           const FGrapplingCurveLUT* InProfile)
+	: Start(InStart)
+	, End(InEnd)
+	, Up(InUp)
+	, Curve(InCurve)
+	, Profile(InProfile && InProfile->IsValid() ? InProfile : nullptr)
+{
+}
+
+FVector FGrapplingTrajectory::GetLocation(float Alpha) const
+{
+	return GrappleCore::LeapLocation(Start, End, Up, Alpha, GetCurveValue(Alpha));
+}
+
+void FGrapplingTrajectory::GetLocations(const float* Alphas, FVector* OutLocations, int32 Count) const
+{
+	TArray<float, TInlineAllocator<64>> CurveValues;
+	CurveValues.SetNumUninitialized(Count);
+	if(Profile)
+	{
+		Profile->EvaluateBatch(Alphas, CurveValues.GetData(), Count);
+	}
+	else
+	{
+		for(int32 i = 0; i < Count; i++)
+		{
+			CurveValues[i] = GetCurveValue(Alphas[i]);
+		}
+	}
+	GrappleCore::LeapLocations(Start, End, Up, Alphas, CurveValues.GetData(), OutLocations, Count);
+}
+
+void FGrapplingTrajectory::BuildValidationSweeps(EGrappleValidationMode Mode, int32 SampleCount, float Tolerance,
+                                                 int32 MaxSegments, TArray<FGrappleTrajectorySweep>& OutSweeps) const
+{
+	OutSweeps.Reset();
+
+	if(Mode == EGrappleValidationMode::DiscreteSamples)
+	{
+		// Zero-length sweeps at SampleCount + 1 evenly spaced fractions
+		TArray<float, TInlineAllocator<32>> Alphas;
+		TArray<FVector, TInlineAllocator<32>> Locations;
+		Alphas.SetNumUninitialized(SampleCount + 1);
+		Locations.SetNumUninitialized(SampleCount + 1);
+		GrappleCore::UniformAlphas(SampleCount, Alphas.GetData());
+		GetLocations(Alphas.GetData(), Locations.GetData(), Alphas.Num());
+
+		for(int32 i = 0; i <= SampleCount; i++)
+		{
+			OutSweeps.Add({Alphas[i], Alphas[i], Locations[i], Locations[i]});
+		}
+		return;
+	}
+
+	// Split the segment with the largest deviation until every segment is close enough to the
+	// curve or the budget is spent
+	MaxSegments = FMath::Max(MaxSegments, 1);
+	TArray<float, TInlineAllocator<33>> Alphas;
+	TArray<float, TInlineAllocator<32>> Deviations;
+	Alphas.SetNumUninitialized(MaxSegments + 1);
+	Deviations.SetNumUninitialized(MaxSegments);
+	const int32 AlphaCount = GrappleCore::SubdivideLeap([this](float Alpha) { return GetCurveValue(Alpha); },
+	                                                    Tolerance, MaxSegments, Alphas.GetData(), Deviations.GetData());
+	Alphas.SetNum(AlphaCount, false);
+
+	FVector SegmentStart = GetLocation(0.f);
+	for(int32 i = 1; i < Alphas.Num(); i++)
+	{
+		const FVector SegmentEnd = GetLocation(Alphas[i]);
+		OutSweeps.Add({Alphas[i - 1], Alphas[i], SegmentStart, SegmentEnd});
+		SegmentStart = SegmentEnd;
+	}
+}
+
+bool FGrapplingTrajectory::SweepForObstacle(const UWorld* World, const TArray<FGrappleTrajectorySweep>& Sweeps,
+                                            const FCollisionShape& Shape, const FCollisionQueryParams& Params,
+                                            FGrappleTrajectoryHit& OutHit)
+{
+	for(const FGrappleTrajectorySweep& Sweep : Sweeps)
+	{
+		FGrapplingCounters::AddSweeps(1);
+		if(World->SweepSingleByChannel(OutHit.Hit, Sweep.StartLocation, Sweep.EndLocation, FQuat::Identity,
+		                               ECollisionChannel::ECC_Visibility, Shape, Params))
+		{
+			OutHit.LeapFraction = GetLeapFraction(Sweep, OutHit.Hit.Time);
+			return true;
+		}
+	}
+	OutHit.LeapFraction = 1.f;
+	return false;
+}
+
+float FGrapplingTrajectory::GetLeapFraction(const FGrappleTrajectorySweep& Sweep, float HitTime)
+{
+	return GrappleCore::Lerp(Sweep.StartAlpha, Sweep.EndAlpha, HitTime);
+}
+
+float FGrapplingTrajectory::GetCurveValue(float Alpha) const
+{
+	if(Profile) return Profile->Evaluate(Alpha);
+	return Curve ? Curve->GetFloatValue(Alpha) : 0.f;
+}
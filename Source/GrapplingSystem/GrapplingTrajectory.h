@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+#include "GrappleCore/GrappleCore.h"
+#include "GrapplingTrajectory.generated.h"
+
+class UCurveFloat;
+struct FGrapplingCurveLUT;
+
+/** How the leap path is checked for obstacles before a leap */
+UENUM(BlueprintType)
+enum class EGrappleValidationMode : uint8
+{
+	/** Overlap tests at evenly spaced points of the trajectory */
+	DiscreteSamples,
+
+	/** Capsule sweeps between consecutive points of the trajectory, split where it bends */
+	SweptSegments
+};
+
+/** One capsule sweep of a trajectory validation, between two leap fractions */
+struct FGrappleTrajectorySweep
+{
+	float StartAlpha;
+	float EndAlpha;
+	FVector StartLocation;
+	FVector EndLocation;
+};
+
+/** First obstacle found along a trajectory */
+struct FGrappleTrajectoryHit
+{
+	/** Fraction of the leap at which the obstacle is met */
+	float LeapFraction = 1.f;
+
+	FHitResult Hit;
+};
+
+/** Leap path from a start to an end location, lifted along Up by the vertical curve */
+struct GRAPPLINGSYSTEM_API FGrapplingTrajectory
+{
+	/** Height the vertical curve value is scaled by */
+	static constexpr float VerticalScale = GrappleCore::VerticalScale;
+
+	FVector Start;
+	FVector End;
+	FVector Up;
+	const UCurveFloat* Curve;
+
+	/** Baked version of Curve, used instead of it when set */
+	const FGrapplingCurveLUT* Profile;
+
+	FGrapplingTrajectory(const FVector& InStart, const FVector& InEnd, const FVector& InUp, const UCurveFloat* InCurve,
+	                     const FGrapplingCurveLUT* InProfile = nullptr);
+
+	/** Location at the given fraction of the leap */
+	FVector GetLocation(float Alpha) const;
+
+	/** Locations at many fractions of the leap, evaluating the baked curve in a single batch */
+	void GetLocations(const float* Alphas, FVector* OutLocations, int32 Count) const;
+
+	/**
+	 * Lists the sweeps needed to check the trajectory, in leap order.
+	 * In swept mode the trajectory is split until every segment strays from the curve by less than
+	 * Tolerance. Only the curve bends the path, so the count depends on its shape, not on the leap
+	 * length: flat leaps need a single sweep while long ones can no longer slip between samples.
+	 */
+	void BuildValidationSweeps(EGrappleValidationMode Mode, int32 SampleCount, float Tolerance, int32 MaxSegments,
+	                           TArray<FGrappleTrajectorySweep>& OutSweeps) const;
+
+	/** Runs the sweeps in order and reports the first blocking hit. Returns true if the path is blocked */
+	static bool SweepForObstacle(const UWorld* World, const TArray<FGrappleTrajectorySweep>& Sweeps, const FCollisionShape& Shape,
+	                             const FCollisionQueryParams& Params, FGrappleTrajectoryHit& OutHit);
+
+	/** Converts the time of a hit in a sweep to a fraction of the leap */
+	static float GetLeapFraction(const FGrappleTrajectorySweep& Sweep, float HitTime);
+
+private:
+
+	float GetCurveValue(float Alpha) const;
+};
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrapplingValidationSubsystem.h"
+
+#include "GrapplingStats.h"
+#include "Engine/World.h"
+
+UGrapplingValidationSubsystem::UGrapplingValidationSubsystem()
+{
+	MaxSweepsPerFrame = 256;
+	MaxQueuedRequests = 512;
+	MergeCellSize = 50.f;
+	QueuedRequests = 0;
+}
+
+bool UGrapplingValidationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UGrapplingValidationSubsystem::Deinitialize()
+{
+	PendingJobs.Empty();
+	PendingJobsByKey.Empty();
+	IssuedJobs.Empty();
+	WaitingRequesters.Empty();
+	QueuedRequests = 0;
+	Super::Deinitialize();
+}
+
+bool UGrapplingValidationSubsystem::RequestValidation(const AActor* Requester, FGrappleValidationRequest&& Request, FOnGrappleValidated Callback)
+{
+	if(QueuedRequests >= MaxQueuedRequests || WaitingRequesters.Contains(Requester)) return false;
+	WaitingRequesters.Add(Requester);
+
+	const FGrappleValidationKey Key = MakeKey(Request);
+	FGrappleValidationJob* Job = PendingJobsByKey.FindRef(Key);
+	if(!Job)
+	{
+		Job = PendingJobs.Add_GetRef(MakeUnique<FGrappleValidationJob>()).Get();
+		Job->Key = Key;
+		Job->Request = MoveTemp(Request);
+		PendingJobsByKey.Add(Key, Job);
+	}
+	Job->Requesters.Add(Requester);
+	Job->Callbacks.Add(MoveTemp(Callback));
+	QueuedRequests++;
+	return true;
+}
+
+void UGrapplingValidationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Grappling_ServerValidation);
+
+	DeliverResults();
+	IssueJobs();
+
+	SET_DWORD_STAT(STAT_Grappling_ValidationQueueDepth, QueuedRequests);
+	CSV_CUSTOM_STAT(Grappling, ValidationQueueDepth, QueuedRequests, ECsvCustomStatOp::Set);
+}
+
+ETickableTickType UGrapplingValidationSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Always;
+}
+
+TStatId UGrapplingValidationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGrapplingValidationSubsystem, STATGROUP_Tickables);
+}
+
+void UGrapplingValidationSubsystem::DeliverResults()
+{
+	UWorld* World = GetWorld();
+	for(int32 i = 0; i < IssuedJobs.Num(); i++)
+	{
+		FGrappleValidationJob& Job = *IssuedJobs[i];
+
+		bool bReady = true;
+		bool bBlocked = false;
+		for(const FTraceHandle& TraceHandle : Job.TraceHandles)
+		{
+			FTraceDatum TraceDatum;
+			if(!World->QueryTraceData(TraceHandle, TraceDatum))
+			{
+				// Traces are only ever a frame late, a handle that is no longer known was dropped
+				bReady = !World->IsTraceHandleValid(TraceHandle, false);
+				bBlocked = true;
+				break;
+			}
+			bBlocked |= FHitResult::GetFirstBlockingHit(TraceDatum.OutHits) != nullptr;
+		}
+		if(!bReady) continue;
+
+		for(const TWeakObjectPtr<const AActor>& Requester : Job.Requesters)
+		{
+			WaitingRequesters.Remove(Requester.Get());
+		}
+
+		// A callback may queue a new request, take the job out first
+		const TUniquePtr<FGrappleValidationJob> DoneJob = MoveTemp(IssuedJobs[i]);
+		IssuedJobs.RemoveAt(i--, 1, false);
+		for(const FOnGrappleValidated& Callback : DoneJob->Callbacks)
+		{
+			Callback.ExecuteIfBound(!bBlocked);
+		}
+	}
+}
+
+void UGrapplingValidationSubsystem::IssueJobs()
+{
+	UWorld* World = GetWorld();
+	int32 RemainingSweeps = MaxSweepsPerFrame;
+	int32 IssuedCount = 0;
+	for(; IssuedCount < PendingJobs.Num(); IssuedCount++)
+	{
+		FGrappleValidationJob& Job = *PendingJobs[IssuedCount];
+
+		// The oldest job always goes, even if it alone is over the budget, so nothing waits forever
+		const int32 SweepCount = Job.Request.Sweeps.Num();
+		if(IssuedCount > 0 && SweepCount > RemainingSweeps) break;
+		RemainingSweeps -= SweepCount;
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GrappleServerValidation), false);
+		for(const TWeakObjectPtr<const AActor>& Requester : Job.Requesters)
+		{
+			QueryParams.AddIgnoredActor(Requester.Get());
+		}
+
+		// Issued together, the sweeps of every job run in the same async trace batch
+		FGrapplingCounters::AddSweeps(SweepCount);
+		for(const FGrappleTrajectorySweep& Sweep : Job.Request.Sweeps)
+		{
+			Job.TraceHandles.Add(World->AsyncSweepByChannel(
+				EAsyncTraceType::Single, Sweep.StartLocation, Sweep.EndLocation, FQuat::Identity,
+				ECollisionChannel::ECC_Visibility, Job.Request.Shape, QueryParams));
+		}
+
+		QueuedRequests -= Job.Callbacks.Num();
+		PendingJobsByKey.Remove(Job.Key);
+		IssuedJobs.Add(MoveTemp(PendingJobs[IssuedCount]));
+	}
+	PendingJobs.RemoveAt(0, IssuedCount, false);
+}
+
+FGrappleValidationKey UGrapplingValidationSubsystem::MakeKey(const FGrappleValidationRequest& Request) const
+{
+	auto GetCell = [this](const FVector& Location)
+	{
+		return FIntVector(
+			FMath::FloorToInt(Location.X / MergeCellSize),
+			FMath::FloorToInt(Location.Y / MergeCellSize),
+			FMath::FloorToInt(Location.Z / MergeCellSize));
+	};
+
+	FGrappleValidationKey Key;
+	Key.StartCell = GetCell(Request.Start);
+	Key.EndCell = GetCell(Request.End);
+	Key.CapsuleSize = FIntPoint(FMath::RoundToInt(Request.Shape.GetCapsuleRadius()), FMath::RoundToInt(Request.Shape.GetCapsuleHalfHeight()));
+	return Key;
+}
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionShape.h"
+#include "GrapplingTrajectory.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrapplingValidationSubsystem.generated.h"
+
+/** Called with the result of a queued validation, true if the leap path is clear */
+DECLARE_DELEGATE_OneParam(FOnGrappleValidated, bool /*bClear*/);
+
+/** Leap path to check for obstacles on behalf of a client */
+struct FGrappleValidationRequest
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+
+	/** Sweeps checking the leap path, in leap order */
+	TArray<FGrappleTrajectorySweep> Sweeps;
+
+	/** Capsule of the leaping character */
+	FCollisionShape Shape;
+};
+
+/** Requests that would sweep the same path share a key, and a single validation */
+struct FGrappleValidationKey
+{
+	FIntVector StartCell;
+	FIntVector EndCell;
+	FIntPoint CapsuleSize;
+
+	bool operator==(const FGrappleValidationKey& Other) const
+	{
+		return StartCell == Other.StartCell && EndCell == Other.EndCell && CapsuleSize == Other.CapsuleSize;
+	}
+
+	friend uint32 GetTypeHash(const FGrappleValidationKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.StartCell), GetTypeHash(Key.EndCell)), GetTypeHash(Key.CapsuleSize));
+	}
+};
+
+/** Validation shared by every request with the same key */
+struct FGrappleValidationJob
+{
+	FGrappleValidationKey Key;
+
+	FGrappleValidationRequest Request;
+
+	/** Characters waiting for the result, ignored by the sweeps */
+	TArray<TWeakObjectPtr<const AActor>> Requesters;
+
+	TArray<FOnGrappleValidated> Callbacks;
+
+	/** Async sweeps issued, one per sweep of the request */
+	TArray<FTraceHandle> TraceHandles;
+};
+
+/**
+ * Validates the grapple requests of remote clients on the server. Requests received during a frame
+ * are queued, those starting from the same cell towards the same target are merged, and their
+ * sweeps are issued together as async traces, up to a budget of sweeps per frame. Results are
+ * delivered the frame after, once the traces are done. Requests beyond the queue capacity are
+ * refused right away, so grapple spam costs no more than the budget.
+ */
+UCLASS(config=Game)
+class GRAPPLINGSYSTEM_API UGrapplingValidationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UGrapplingValidationSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Queues a request on behalf of Requester. Callback is called once the path is checked, from a
+	 * later frame. Returns false, without calling it, if the queue is full or Requester already waits
+	 */
+	bool RequestValidation(const AActor* Requester, FGrappleValidationRequest&& Request, FOnGrappleValidated Callback);
+
+	/** Requests waiting for their sweeps to be issued */
+	int32 GetQueueDepth() const { return QueuedRequests; }
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	// End of FTickableGameObject interface
+
+protected:
+
+	/** Sweeps that can be issued in a frame, over all requests */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 MaxSweepsPerFrame;
+
+	/** Requests that can wait in the queue before new ones are refused */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	int32 MaxQueuedRequests;
+
+	/** Size of the cells leap starts and ends are merged in */
+	UPROPERTY(config, EditAnywhere, Category = "Grappling")
+	float MergeCellSize;
+
+	/** Jobs waiting for their sweeps to be issued, oldest first */
+	TArray<TUniquePtr<FGrappleValidationJob>> PendingJobs;
+
+	/** Pending job of every key */
+	TMap<FGrappleValidationKey, FGrappleValidationJob*> PendingJobsByKey;
+
+	/** Jobs whose sweeps are in flight */
+	TArray<TUniquePtr<FGrappleValidationJob>> IssuedJobs;
+
+	/** Requests of the pending jobs */
+	int32 QueuedRequests;
+
+	/** Characters waiting for a result, pending or issued */
+	TSet<TObjectKey<AActor>> WaitingRequesters;
+
+	/** Hands the results of the jobs whose sweeps are done to their callbacks */
+	void DeliverResults();
+
+	/** Issues the sweeps of the oldest pending jobs, within the frame budget */
+	void IssueJobs();
+
+	FGrappleValidationKey MakeKey(const FGrappleValidationRequest& Request) const;
+};
@@ -3,50 +3,50 @@
 
 #include "RopeGuide.h"
 
-#include <ThirdParty/openexr/Deploy/OpenEXR-2.3.0/OpenEXR/include/ImathMath.h>
-
-#include "Kismet/KismetMathLibrary.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "GrapplingSimulationSubsystem.h"
+#include "Engine/World.h"
 
 // Sets default values
 ARopeGuide::ARopeGuide()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// The grappling simulation moves the object, so it does not need to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
 	RootComponent = Mesh;
 
-	ElapsedTime = 0.f;
 	TargetTime = 0.5f;
-	bIsFlying = false;
+	FlightHandle = INDEX_NONE;
 }
 
 void ARopeGuide::SetTarget(FVector StartPosition, FVector EndPosition)
 {
-	Start = StartPosition;
-	End = EndPosition;
-	Direction = UKismetMathLibrary::GetDirectionUnitVector(Start, End);
-	bIsFlying = true;
-	ElapsedTime = 0.f;
+	StopFlight();
+
+	SetActorLocation(StartPosition, false);
+	if(UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>())
+	{
+		FlightHandle = Simulation->AddRopeFlight(this, StartPosition, EndPosition, TargetTime);
+	}
 }
 
-void ARopeGuide::UpdatePosition(float DeltaTime)
+void ARopeGuide::StopFlight()
 {
-	if(!bIsFlying) return;
-	FLatentActionInfo LatentInfo;
-	LatentInfo.CallbackTarget = this;
-	ElapsedTime+= DeltaTime;
-	ElapsedTime = UKismetMathLibrary::FClamp(ElapsedTime, 0.f, TargetTime);
-	FVector NewPosition = UKismetMathLibrary::VLerp(Start, End, ElapsedTime/TargetTime);
-	SetActorLocation(NewPosition,false);
+	if(FlightHandle == INDEX_NONE) return;
 
-	// When the object reaches destination, destroy it
-	if(ElapsedTime >= TargetTime)
+	if(UGrapplingSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGrapplingSimulationSubsystem>())
 	{
-		bIsFlying = false;
-		this->Destroy();
+		Simulation->RemoveRopeFlight(FlightHandle);
 	}
+	FlightHandle = INDEX_NONE;
+}
+
+void ARopeGuide::OnFlightFinished()
+{
+	// When the object reaches destination, hide it. The character gives it back to the pool
+	// together with the cable when the leap is over, since the cable is still attached to it
+	FlightHandle = INDEX_NONE;
+	SetActorHiddenInGame(true);
 }
 
 // Called when the game starts or when spawned
@@ -55,10 +55,8 @@ void ARopeGuide::BeginPlay()
 	Super::BeginPlay();
 }
 
-// Called every frame
-void ARopeGuide::Tick(float DeltaTime)
+void ARopeGuide::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
-	UpdatePosition(DeltaTime);
+	StopFlight();
+	Super::EndPlay(EndPlayReason);
 }
-
@@ -21,36 +21,23 @@ public:
 
 	/** Sets the Start and End positions. Called by the Character when starting a grappling leap */
 	void SetTarget(FVector StartPosition, FVector EndPosition);
+
+	/** Stops the flight where the object currently is */
+	void StopFlight();
+
+	/** Called by the grappling simulation when the object reaches destination */
+	void OnFlightFinished();
 	
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	float ElapsedTime;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** The time it takes for the object to reach destination */
 	float TargetTime;
 
-	/** Is the object moving? It should always be true, when it is not it
-	 *  means the object gets destroyed */
-	bool bIsFlying;
-
-	/** Start position */
-	FVector Start;
-
-	/** End position */
-	FVector End;
-
-	/** Movement direction */
-	FVector Direction;
-
-	/** Called every frame to update the position of the object */
-	void UpdatePosition(float DeltaTime);
-
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	/** Handle of the flight in the grappling simulation, which moves the object. INDEX_NONE when not flying */
+	int32 FlightHandle;
 
 };
-
-
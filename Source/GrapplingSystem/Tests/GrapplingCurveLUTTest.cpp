@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "GrapplingCurveLUT.h"
+#include "Curves/CurveFloat.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrapplingCurveLUTDeviationTest, "GrapplingSystem.CurveLUT.Deviation",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrapplingCurveLUTDeviationTest::RunTest(const FString& Parameters)
+{
+	// A leap shaped curve: up, then down, with cubic keys so a coarse table cannot follow it
+	UCurveFloat* Curve = NewObject<UCurveFloat>();
+	for(const FVector2D& Key : {FVector2D(0.f, 0.f), FVector2D(0.3f, 0.8f), FVector2D(0.5f, 1.f), FVector2D(1.f, 0.f)})
+	{
+		const FKeyHandle Handle = Curve->FloatCurve.AddKey(Key.X, Key.Y);
+		Curve->FloatCurve.SetKeyInterpMode(Handle, RCIM_Cubic);
+	}
+	Curve->FloatCurve.AutoSetTangents();
+
+	constexpr float Tolerance = 1e-3f;
+	FGrapplingCurveLUT Table;
+	TestTrue(TEXT("Build meets the tolerance"), Table.Build(Curve, 4, Tolerance));
+	TestTrue(TEXT("Resolution grew past the requested one"), Table.GetResolution() > 4);
+	TestTrue(TEXT("Measured deviation is under the tolerance"), Table.GetMaxDeviation() <= Tolerance);
+
+	// Probe between the points measured while baking, with some slack since those are not the worst ones
+	constexpr int32 ProbeCount = 10007;
+	float Deviation = 0.f;
+	for(int32 i = 0; i <= ProbeCount; i++)
+	{
+		const float Alpha = float(i) / ProbeCount;
+		Deviation = FMath::Max(Deviation, FMath::Abs(Table.Evaluate(Alpha) - Curve->GetFloatValue(Alpha)));
+	}
+	TestTrue(FString::Printf(TEXT("Deviation %f stays under the tolerance"), Deviation), Deviation <= 2.f * Tolerance);
+
+	// The batched evaluation matches the scalar one, including the clamped alphas
+	constexpr int32 AlphaCount = 11;
+	float Alphas[AlphaCount];
+	float Values[AlphaCount];
+	for(int32 i = 0; i < AlphaCount; i++)
+	{
+		Alphas[i] = -0.1f + 0.12f * i;
+	}
+	Table.EvaluateBatch(Alphas, Values, AlphaCount);
+	for(int32 i = 0; i < AlphaCount; i++)
+	{
+		TestEqual(FString::Printf(TEXT("Batched value at %f"), Alphas[i]), Values[i], Table.Evaluate(Alphas[i]), 1e-5f);
+	}
+
+	// Nothing to bake from no curve
+	FGrapplingCurveLUT EmptyTable;
+	TestFalse(TEXT("Build fails without a curve"), EmptyTable.Build(nullptr, 64, Tolerance));
+	TestFalse(TEXT("Empty table is not valid"), EmptyTable.IsValid());
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "GrapplingRopeBatch.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrapplingRopeBatchSlotsTest, "GrapplingSystem.RopeBatch.Slots",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrapplingRopeBatchSlotsTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 RingsPerSlot = 5;
+	constexpr int32 NumSides = 4;
+	FGrapplingRopeBatchBuffer Buffer;
+	Buffer.Init(RingsPerSlot, NumSides);
+	const int32 SlotVertexCount = Buffer.GetSlotVertexCount();
+	TestEqual(TEXT("Vertices per slot"), SlotVertexCount, RingsPerSlot * (NumSides + 1));
+	TestEqual(TEXT("Indices per slot"), Buffer.GetSlotIndexCount(), (RingsPerSlot - 1) * NumSides * 6);
+
+	// Slots are handed out in order, and the lowest freed one is taken first
+	const int32 Slot0 = Buffer.AddSlot();
+	const int32 Slot1 = Buffer.AddSlot();
+	const int32 Slot2 = Buffer.AddSlot();
+	const int32 Slot3 = Buffer.AddSlot();
+	TestEqual(TEXT("First slot"), Slot0, 0);
+	TestEqual(TEXT("Last slot"), Slot3, 3);
+	Buffer.RemoveSlot(Slot2);
+	Buffer.RemoveSlot(Slot1);
+	TestEqual(TEXT("Used slots after freeing two"), Buffer.GetUsedSlotCount(), 2);
+	TestEqual(TEXT("Freed slots are kept"), Buffer.GetSlotCount(), 4);
+	TestEqual(TEXT("Lowest freed slot is reused"), Buffer.AddSlot(), Slot1);
+	Buffer.RemoveSlot(Slot1);
+	Buffer.RemoveSlot(Slot1);
+	TestEqual(TEXT("Freeing twice frees once"), Buffer.GetUsedSlotCount(), 2);
+
+	// Every slot changed since it was added or freed, and each gets a full range of vertices
+	const TArray<FVector> Points = {FVector(0.f, 0.f, 0.f), FVector(100.f, 0.f, 0.f), FVector(200.f, 0.f, -50.f)};
+	TestTrue(TEXT("New points are taken"), Buffer.SetPoints(Slot3, Points, 2.f, 1.f));
+	FGrapplingRopeBatchUpdate Update;
+	Buffer.BuildDirtySlots(Update);
+	TestTrue(TEXT("Changed slots"), Update.Slots == TArray<int32>({0, 1, 2, 3}));
+	TestEqual(TEXT("Vertices of the changed slots"), Update.Vertices.Num(), Update.Slots.Num() * SlotVertexCount);
+	TestEqual(TEXT("Drawn slots reach the last one in use"), Update.DrawnSlotCount, 4);
+	TestFalse(TEXT("Nothing left to build"), Buffer.HasDirtySlots());
+
+	// Rings past the last point collapse onto it
+	const FDynamicMeshVertex* Slot3Vertices = Update.Vertices.GetData() + 3 * SlotVertexCount;
+	for(int32 v = Points.Num() * (NumSides + 1); v < SlotVertexCount; v++)
+	{
+		TestEqual(TEXT("Collapsed vertex"), Slot3Vertices[v].Position, Points.Last());
+	}
+
+	// Unchanged points rebuild nothing, changed ones rebuild their slot only
+	TestFalse(TEXT("Same points are ignored"), Buffer.SetPoints(Slot3, Points, 2.f, 1.f));
+	TestFalse(TEXT("Freed slots take no points"), Buffer.SetPoints(Slot1, Points, 2.f, 1.f));
+	TestTrue(TEXT("Other points are taken"), Buffer.SetPoints(Slot0, Points, 2.f, 1.f));
+	Buffer.BuildDirtySlots(Update);
+	TestTrue(TEXT("Only the changed slot"), Update.Slots == TArray<int32>({0}));
+	TestEqual(TEXT("Vertices of a single slot"), Update.Vertices.Num(), SlotVertexCount);
+
+	// Freeing the last slots in use shortens the drawn range
+	Buffer.RemoveSlot(Slot3);
+	Buffer.BuildDirtySlots(Update);
+	TestEqual(TEXT("Drawn slots after freeing the last one"), Update.DrawnSlotCount, 1);
+
+	// The indices of each slot stay within its vertex range
+	TArray<uint32> Indices;
+	Buffer.BuildIndices(Buffer.GetSlotCount(), Indices);
+	TestEqual(TEXT("Index count"), Indices.Num(), Buffer.GetSlotCount() * Buffer.GetSlotIndexCount());
+	bool bIndicesInSlot = true;
+	for(int32 i = 0; i < Indices.Num(); i++)
+	{
+		const uint32 SlotIndex = i / Buffer.GetSlotIndexCount();
+		bIndicesInSlot &= Indices[i] >= SlotIndex * SlotVertexCount && Indices[i] < (SlotIndex + 1) * SlotVertexCount;
+	}
+	TestTrue(TEXT("Indices stay in their slot"), bIndicesInSlot);
+
+	// Bounds cover the slots in use, widened by the rope width
+	const FBox Bounds = Buffer.GetBounds();
+	TestTrue(TEXT("Bounds cover the rope in use"), Bounds.IsValid && Bounds.IsInside(FBox(Points.GetData(), Points.Num())));
+
+	return true;
+}
+
+#endif
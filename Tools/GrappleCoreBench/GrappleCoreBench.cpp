@@ -0,0 +1,360 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GrappleCore/GrappleCore.h"
+#include "GrappleCore/GrappleEventRing.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using GrappleCore::FVec3;
+
+namespace
+{
+	/** Resolution the character bakes its curve at by default */
+	constexpr int32_t TableResolution = 64;
+
+	/** Sub-steps a leap may be split into in a frame, as in the simulation subsystem */
+	constexpr int32_t MaxLeapSteps = 8;
+
+	/** Discrete validation samples, as ClearanceTestCount of the character */
+	constexpr int32_t ValidationSampleCount = 10;
+
+	constexpr int32_t MaxValidationSegments = 32;
+
+	constexpr float ValidationTolerance = 10.f;
+
+	/** Keeps the compiler from discarding the benchmarked work, or from only computing what is read of it */
+	template <typename T>
+	void KeepAlive(const T& Value)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "r"(&Value) : "memory");
+#else
+		static const void* volatile Sink;
+		Sink = &Value;
+#endif
+	}
+
+	int32_t FailureCount = 0;
+
+	void Check(bool bCondition, const char* Description)
+	{
+		if(!bCondition)
+		{
+			std::printf("FAILED: %s\n", Description);
+			FailureCount++;
+		}
+	}
+
+	/** Arc shaped like the default leap curve, baked the way FGrapplingCurveLUT does it */
+	std::vector<float> MakeCurveTable(int32_t Resolution)
+	{
+		std::vector<float> Values(Resolution + 2);
+		for(int32_t i = 0; i <= Resolution; i++)
+		{
+			Values[i] = std::sin(3.14159265f * float(i) / Resolution);
+		}
+		Values[Resolution + 1] = Values[Resolution];
+		return Values;
+	}
+
+	/** Same size as the telemetry events of the module */
+	struct FTelemetryEvent
+	{
+		float Time;
+		uint32_t CharacterId;
+		float Distance;
+		float Duration;
+		uint8_t Type;
+	};
+
+	/** Capacity of the telemetry ring of the module */
+	using FTelemetryRing = GrappleCore::TEventRing<FTelemetryEvent, 4096>;
+
+	struct FCurveTable
+	{
+		const std::vector<float>* Values;
+
+		float operator()(float Alpha) const
+		{
+			return GrappleCore::EvaluateCurveTable(Values->data(), int32_t(Values->size()) - 2, Alpha);
+		}
+	};
+
+	void RunRingTests()
+	{
+		// Events come out in order, and pushes past the capacity are dropped
+		GrappleCore::TEventRing<uint32_t, 8> SmallRing;
+		uint32_t Values[8];
+		Check(SmallRing.Pop(Values, 8) == 0, "TEventRing starts empty");
+		bool bPushed = true;
+		for(uint32_t i = 0; i < 8; i++)
+		{
+			bPushed &= SmallRing.Push(i);
+		}
+		Check(bPushed && !SmallRing.Push(8), "TEventRing drops events when full");
+		Check(SmallRing.Pop(Values, 3) == 3 && Values[0] == 0 && Values[2] == 2, "TEventRing pops the oldest events first");
+		Check(SmallRing.Push(8) && SmallRing.Num() == 6, "TEventRing takes events again once drained");
+		Check(SmallRing.Pop(Values, 8) == 6 && Values[0] == 3 && Values[5] == 8, "TEventRing wraps around");
+
+		// A producer and a consumer thread together lose nothing but the events the ring had no room for
+		constexpr uint32_t EventCount = 1000000;
+		std::unique_ptr<GrappleCore::TEventRing<uint32_t, 1024>> Ring(new GrappleCore::TEventRing<uint32_t, 1024>());
+		uint32_t Received = 0;
+		uint32_t LastValue = 0;
+		bool bOrdered = true;
+		std::thread Consumer([&]()
+		{
+			uint32_t Batch[256];
+			while(LastValue < EventCount - 1)
+			{
+				const uint32_t Count = Ring->Pop(Batch, 256);
+				for(uint32_t i = 0; i < Count; i++)
+				{
+					bOrdered &= Received == 0 || Batch[i] > LastValue;
+					LastValue = Batch[i];
+				}
+				Received += Count;
+			}
+		});
+		uint32_t Dropped = 0;
+		for(uint32_t i = 0; i < EventCount - 1; i++)
+		{
+			if(!Ring->Push(i)) Dropped++;
+		}
+		// The last event must get through for the consumer to stop
+		while(!Ring->Push(EventCount - 1)) {}
+		Consumer.join();
+		Check(bOrdered, "TEventRing keeps the order across threads");
+		Check(Received + Dropped == EventCount, "TEventRing loses no pushed event across threads");
+	}
+
+	void RunTests()
+	{
+		const std::vector<float> Values = MakeCurveTable(TableResolution);
+		const FCurveTable Curve{&Values};
+
+		// The table returns its samples exactly and clamps outside [0, 1]
+		bool bExact = true;
+		for(int32_t i = 0; i <= TableResolution; i++)
+		{
+			bExact &= Curve(float(i) / TableResolution) == Values[i];
+		}
+		Check(bExact, "EvaluateCurveTable returns the table samples");
+		Check(Curve(-1.f) == Values[0] && Curve(2.f) == Values[TableResolution], "EvaluateCurveTable clamps the fraction");
+
+		float Alphas[64];
+		float Batch[64];
+		for(int32_t i = 0; i < 64; i++)
+		{
+			Alphas[i] = float(i) / 63.f;
+		}
+		GrappleCore::EvaluateCurveTableBatch(Values.data(), TableResolution, Alphas, Batch, 64);
+		bool bBatchMatches = true;
+		for(int32_t i = 0; i < 64; i++)
+		{
+			bBatchMatches &= Batch[i] == Curve(Alphas[i]);
+		}
+		Check(bBatchMatches, "EvaluateCurveTableBatch matches EvaluateCurveTable");
+
+		// Leap ends are the start and end lifted by the curve
+		const FVec3 Start(0.f, 0.f, 0.f);
+		const FVec3 End(1000.f, 500.f, 200.f);
+		const FVec3 Up(0.f, 0.f, 1.f);
+		const FVec3 Middle = GrappleCore::LeapLocation(Start, End, Up, 0.5f, 1.f);
+		Check(Middle.X == 500.f && Middle.Y == 250.f && Middle.Z == 100.f + GrappleCore::VerticalScale, "LeapLocation lifts the middle of the leap");
+		const FVec3 Last = GrappleCore::LeapLocation(Start, End, Up, 1.f, 0.f);
+		Check(Last.X == End.X && Last.Y == End.Y && Last.Z == End.Z, "LeapLocation ends at the end");
+
+		Check(GrappleCore::LeapDuration(1500.f, 1500.f) == 1.f, "LeapDuration divides by the speed");
+		Check(GrappleCore::LeapDuration(1500.f, 0.f) == 0.f, "LeapDuration is 0 without speed");
+
+		Check(GrappleCore::SubStepCount(0.f, 1.f / 120.f, MaxLeapSteps) == 1, "SubStepCount takes at least one step");
+		Check(GrappleCore::SubStepCount(1.f / 60.f, 1.f / 120.f, MaxLeapSteps) == 2, "SubStepCount splits long frames");
+		Check(GrappleCore::SubStepCount(10.f, 1.f / 120.f, MaxLeapSteps) == MaxLeapSteps, "SubStepCount is capped");
+		Check(GrappleCore::SubStepCount(1.f, 0.f, MaxLeapSteps) == MaxLeapSteps, "SubStepCount survives a zero step time");
+
+		float StepAlphas[MaxLeapSteps];
+		GrappleCore::SubStepAlphas(0.25f, 0.75f, 4, StepAlphas);
+		Check(StepAlphas[0] == 0.375f && StepAlphas[3] == 0.75f, "SubStepAlphas ends each step evenly");
+
+		float Uniform[ValidationSampleCount + 1];
+		GrappleCore::UniformAlphas(ValidationSampleCount, Uniform);
+		Check(Uniform[0] == 0.f && Uniform[ValidationSampleCount] == 1.f, "UniformAlphas spans the whole leap");
+
+		// Subdivision keeps the bounds sorted and stops at the tolerance or the segment budget
+		float Bounds[MaxValidationSegments + 1];
+		float Deviations[MaxValidationSegments];
+		const int32_t BoundCount = GrappleCore::SubdivideLeap(Curve, ValidationTolerance, MaxValidationSegments, Bounds, Deviations);
+		bool bSorted = Bounds[0] == 0.f && Bounds[BoundCount - 1] == 1.f;
+		bool bWithinTolerance = true;
+		for(int32_t i = 1; i < BoundCount; i++)
+		{
+			bSorted &= Bounds[i] > Bounds[i - 1];
+			bWithinTolerance &= GrappleCore::ChordDeviation(Curve, Bounds[i - 1], Bounds[i]) <= ValidationTolerance;
+		}
+		Check(BoundCount > 2 && bSorted, "SubdivideLeap splits a curved leap into sorted segments");
+		Check(bWithinTolerance || BoundCount == MaxValidationSegments + 1, "SubdivideLeap meets the tolerance within its budget");
+
+		const int32_t CappedCount = GrappleCore::SubdivideLeap(Curve, 0.f, 4, Bounds, Deviations);
+		Check(CappedCount == 5, "SubdivideLeap stops at MaxSegments");
+
+		const auto Flat = [](float) { return 0.f; };
+		Check(GrappleCore::SubdivideLeap(Flat, ValidationTolerance, MaxValidationSegments, Bounds, Deviations) == 2,
+		      "SubdivideLeap sweeps a flat leap in one segment");
+		Check(GrappleCore::SubdivideLeap(Curve, ValidationTolerance, 0, Bounds, Deviations) == 2, "SubdivideLeap takes at least one segment");
+
+		RunRingTests();
+	}
+
+	/** Runs Body Iterations times, a few rounds, and prints the fastest round in ns per op */
+	template <typename BodyType>
+	void Measure(const char* Name, int64_t Iterations, int32_t OpsPerIteration, BodyType&& Body)
+	{
+		double BestNanoseconds = 1e30;
+		for(int32_t Round = 0; Round < 5; Round++)
+		{
+			const auto Begin = std::chrono::steady_clock::now();
+			for(int64_t i = 0; i < Iterations; i++)
+			{
+				Body(i);
+			}
+			const auto Elapsed = std::chrono::steady_clock::now() - Begin;
+			const double Nanoseconds = std::chrono::duration<double, std::nano>(Elapsed).count();
+			BestNanoseconds = GrappleCore::Min(BestNanoseconds, Nanoseconds);
+		}
+
+		const double PerIteration = BestNanoseconds / Iterations;
+		std::printf("%-34s %10.2f ns/op %10.2f ns/sample\n", Name, PerIteration, PerIteration / OpsPerIteration);
+	}
+
+	void RunBenchmarks(int64_t Iterations)
+	{
+		const std::vector<float> Values = MakeCurveTable(TableResolution);
+		const FCurveTable Curve{&Values};
+		const FVec3 Start(0.f, 0.f, 100.f);
+		const FVec3 End(3000.f, 1200.f, 800.f);
+		const FVec3 Up(0.f, 0.f, 1.f);
+
+		// One location of a leap, with its curve lookup
+		Measure("LeapLocation", Iterations, 1, [&](int64_t i)
+		{
+			const float Alpha = float(i & 1023) / 1023.f;
+			const FVec3 Location = GrappleCore::LeapLocation(Start, End, Up, Alpha, Curve(Alpha));
+			KeepAlive(Location);
+		});
+
+		// A simulation frame of one leap: sub-step fractions, batched lookup and locations
+		Measure("LeapSubSteps x8", Iterations, MaxLeapSteps, [&](int64_t i)
+		{
+			float StepAlphas[MaxLeapSteps];
+			float CurveValues[MaxLeapSteps];
+			FVec3 Locations[MaxLeapSteps];
+			const float PreviousAlpha = float(i & 511) / 1024.f;
+			GrappleCore::SubStepAlphas(PreviousAlpha, PreviousAlpha + 0.25f, MaxLeapSteps, StepAlphas);
+			GrappleCore::EvaluateCurveTableBatch(Values.data(), TableResolution, StepAlphas, CurveValues, MaxLeapSteps);
+			GrappleCore::LeapLocations(Start, End, Up, StepAlphas, CurveValues, Locations, MaxLeapSteps);
+			KeepAlive(Locations);
+		});
+
+		// Batch sampling of a whole leap, as the rope and debug drawing do
+		Measure("LeapSamples x64", Iterations / 8, 64, [&](int64_t i)
+		{
+			float Alphas[64];
+			float CurveValues[64];
+			FVec3 Locations[64];
+			for(int32_t Sample = 0; Sample < 64; Sample++)
+			{
+				Alphas[Sample] = float(Sample) / 63.f;
+			}
+			GrappleCore::EvaluateCurveTableBatch(Values.data(), TableResolution, Alphas, CurveValues, 64);
+			const FVec3 LeapStart = Start + FVec3(0.f, 0.f, float(i & 7));
+			GrappleCore::LeapLocations(LeapStart, End, Up, Alphas, CurveValues, Locations, 64);
+			KeepAlive(Locations);
+		});
+
+		// Validation samples of one leap in discrete mode
+		Measure("ValidationSamples discrete", Iterations / 4, ValidationSampleCount + 1, [&](int64_t i)
+		{
+			float Alphas[ValidationSampleCount + 1];
+			float CurveValues[ValidationSampleCount + 1];
+			FVec3 Locations[ValidationSampleCount + 1];
+			GrappleCore::UniformAlphas(ValidationSampleCount, Alphas);
+			GrappleCore::EvaluateCurveTableBatch(Values.data(), TableResolution, Alphas, CurveValues, ValidationSampleCount + 1);
+			const FVec3 LeapStart = Start + FVec3(0.f, 0.f, float(i & 7));
+			GrappleCore::LeapLocations(LeapStart, End, Up, Alphas, CurveValues, Locations, ValidationSampleCount + 1);
+			KeepAlive(Locations);
+		});
+
+		// Validation segments of one leap in swept mode, from the subdivision to the segment ends
+		int32_t SegmentBoundCount = 0;
+		Measure("ValidationSegments swept", Iterations / 16, 1, [&](int64_t i)
+		{
+			float Bounds[MaxValidationSegments + 1];
+			float Deviations[MaxValidationSegments];
+			float CurveValues[MaxValidationSegments + 1];
+			FVec3 Locations[MaxValidationSegments + 1];
+			const float Tolerance = ValidationTolerance + float(i & 3);
+			SegmentBoundCount = GrappleCore::SubdivideLeap(Curve, Tolerance, MaxValidationSegments, Bounds, Deviations);
+			GrappleCore::EvaluateCurveTableBatch(Values.data(), TableResolution, Bounds, CurveValues, SegmentBoundCount);
+			GrappleCore::LeapLocations(Start, End, Up, Bounds, CurveValues, Locations, SegmentBoundCount);
+			KeepAlive(Locations);
+		});
+		std::printf("%-34s %10d segments per leap\n", "", SegmentBoundCount - 1);
+
+		// Recording a telemetry event, the ring drained every 1024 events as the drain task would
+		std::unique_ptr<FTelemetryRing> Ring(new FTelemetryRing());
+		Measure("TelemetryRing Push", Iterations, 1, [&](int64_t i)
+		{
+			const FTelemetryEvent Event{float(i), uint32_t(i & 15), 1200.f, 0.8f, uint8_t(i & 3)};
+			Ring->Push(Event);
+			if((i & 1023) == 1023)
+			{
+				FTelemetryEvent Drained[1024];
+				Ring->Pop(Drained, 1024);
+				KeepAlive(Drained);
+			}
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bTestOnly = false;
+	int64_t Iterations = 2000000;
+	for(int32_t i = 1; i < argc; i++)
+	{
+		if(std::strcmp(argv[i], "--test") == 0)
+		{
+			bTestOnly = true;
+		}
+		else if(std::strncmp(argv[i], "--iterations=", 13) == 0)
+		{
+			Iterations = GrappleCore::Max<int64_t>(std::atoll(argv[i] + 13), 16);
+		}
+		else
+		{
+			std::printf("Usage: GrappleCoreBench [--test] [--iterations=N]\n");
+			return 2;
+		}
+	}
+
+	RunTests();
+	if(FailureCount > 0)
+	{
+		std::printf("%d test(s) failed\n", FailureCount);
+		return 1;
+	}
+	std::printf("All tests passed\n");
+
+	if(!bTestOnly)
+	{
+		RunBenchmarks(Iterations);
+	}
+	return 0;
+}